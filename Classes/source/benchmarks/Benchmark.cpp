@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+#include <ctime>
+
+BenchmarkRunner::BenchmarkRunner(int nrOfSamples, float minSampleTime, const std::string& filter)
+	: m_NrOfSamples(nrOfSamples > 0 ? nrOfSamples : 1)
+	, m_MinSampleTime(minSampleTime * 1e9)
+	, m_Filter(filter)
+{
+}
+
+bool BenchmarkRunner::IsSelected(const std::string& name) const
+{
+	return m_Filter.empty() || name.find(m_Filter) != std::string::npos;
+}
+
+void BenchmarkRunner::AddResult(const std::string& name, int problemSize, int nrOfIterations)
+{
+	//Median and median absolute deviation do not move much when a sample gets interrupted, mean and deviation do
+	std::vector<double> samples = m_Samples;
+	std::sort(samples.begin(), samples.end());
+	const size_t count = samples.size();
+	auto median = [](const std::vector<double>& sorted)
+	{
+		const size_t half = sorted.size() / 2;
+		return sorted.size() % 2 == 1 ? sorted[half] : 0.5 * (sorted[half - 1] + sorted[half]);
+	};
+
+	BenchmarkResult result{};
+	result.name = name;
+	result.problemSize = problemSize;
+	result.nrOfIterations = nrOfIterations;
+	result.nrOfSamples = static_cast<int>(count);
+	result.min = samples.front();
+	result.median = median(samples);
+
+	double sum = 0.0;
+	for (double sample : samples)
+		sum += sample;
+	result.mean = sum / count;
+
+	double sumOfSquares = 0.0;
+	std::vector<double> deviations(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		sumOfSquares += (samples[i] - result.mean) * (samples[i] - result.mean);
+		deviations[i] = fabs(samples[i] - result.median);
+	}
+	result.standardDeviation = count > 1 ? sqrt(sumOfSquares / (count - 1)) : 0.0;
+	std::sort(deviations.begin(), deviations.end());
+	result.medianAbsoluteDeviation = median(deviations);
+
+	printf("%-40s %8d %14.1f ns %8.2f %%\n", name.c_str(), problemSize, result.median,
+		result.median > 0.0 ? 100.0 * result.medianAbsoluteDeviation / result.median : 0.0);
+	m_Results.push_back(result);
+}
+
+bool BenchmarkRunner::WriteJson(const std::string& filePath) const
+{
+	std::ofstream file{ filePath };
+	if (!file.is_open())
+		return false;
+
+	const std::time_t now = std::time(nullptr);
+	std::tm utc{};
+#if defined(_MSC_VER)
+	gmtime_s(&utc, &now);
+#else
+	gmtime_r(&now, &utc);
+#endif
+	char date[32]{};
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+#if defined(_MSC_VER)
+	const std::string compiler = "MSVC " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+	const std::string compiler = "Clang " + std::to_string(__clang_major__);
+#elif defined(__GNUC__)
+	const std::string compiler = "GCC " + std::to_string(__GNUC__);
+#else
+	const std::string compiler = "Unknown";
+#endif
+#ifdef _DEBUG
+	const std::string configuration = "Debug";
+#else
+	const std::string configuration = "Release";
+#endif
+
+	//Names are written as they are, they never hold quotes or backslashes
+	file << "{\n";
+	file << "\t\"date\": \"" << date << "\",\n";
+	file << "\t\"compiler\": \"" << compiler << "\",\n";
+	file << "\t\"configuration\": \"" << configuration << "\",\n";
+	file << "\t\"unit\": \"ns\",\n";
+	file << "\t\"benchmarks\": [";
+	file.precision(1);
+	file << std::fixed;
+	for (size_t i = 0; i < m_Results.size(); ++i)
+	{
+		const BenchmarkResult& result = m_Results[i];
+		file << (i == 0 ? "\n" : ",\n");
+		file << "\t\t{ \"name\": \"" << result.name << "\", \"size\": " << result.problemSize
+			<< ", \"iterations\": " << result.nrOfIterations << ", \"samples\": " << result.nrOfSamples
+			<< ", \"min\": " << result.min << ", \"median\": " << result.median << ", \"mean\": " << result.mean
+			<< ", \"stddev\": " << result.standardDeviation << ", \"mad\": " << result.medianAbsoluteDeviation << " }";
+	}
+	file << "\n\t]\n}\n";
+	return true;
+}
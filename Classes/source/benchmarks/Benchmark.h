@@ -0,0 +1,153 @@
+/*=============================================================================*/
+// Benchmark.h: times a function over several samples and keeps robust statistics, written out as a table and as JSON.
+// The correctness checks that run before the benchmarks report the first value that differs through BenchmarkCheck.
+/*=============================================================================*/
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Times in nanoseconds per iteration
+struct BenchmarkResult
+{
+	std::string name;
+	int problemSize;
+	int nrOfIterations; // per sample
+	int nrOfSamples;
+	double min;
+	double median;
+	double mean;
+	double standardDeviation;
+	double medianAbsoluteDeviation;
+};
+
+class BenchmarkRunner final
+{
+public:
+	// A benchmark only runs when its name contains the filter, an empty filter runs all of them
+	BenchmarkRunner(int nrOfSamples, float minSampleTime, const std::string& filter);
+
+	// function() is called nrOfIterations times per sample, nrOfIterations grows until a sample takes minSampleTime
+	// What it returns is summed, so the optimizer can not drop the work
+	template<typename Function>
+	void Run(const std::string& name, int problemSize, Function function);
+
+	bool IsSelected(const std::string& name) const;
+	const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+	bool WriteJson(const std::string& filePath) const;
+
+private:
+	int m_NrOfSamples;
+	double m_MinSampleTime; // nanoseconds
+	std::string m_Filter;
+
+	std::vector<BenchmarkResult> m_Results;
+	std::vector<double> m_Samples;
+	double m_Sink = 0.0;
+
+	template<typename Function>
+	double TimeIterations(Function& function, int nrOfIterations);
+	void AddResult(const std::string& name, int problemSize, int nrOfIterations);
+};
+
+// Compares what an optimized path computes with what the code it replaces computes, exactly: both have to give the same floats
+// Only the first mismatch is kept, with both values and where it happened
+class BenchmarkCheck final
+{
+public:
+	// The description is reported when the check fails
+	explicit BenchmarkCheck(const std::string& description) : m_Description(description) {}
+
+	// what and idx tell where the values come from, like "step 12, cell" and the cell index
+	template<typename T>
+	bool Expect(const T& actual, const T& expected, const std::string& what, int idx);
+	// For sums that are added up in another order: actual within tolerance of expected, relative above magnitude 1
+	bool ExpectNear(float actual, float expected, float tolerance, const std::string& what, int idx);
+	// getActual(i) against getExpected(i) for i in [0, count), stops at the first mismatch
+	template<typename GetActual, typename GetExpected>
+	bool ExpectAll(int count, GetActual getActual, GetExpected getExpected, const std::string& what);
+
+	bool IsPassed() const { return m_FirstMismatch.empty(); }
+	// The description followed by the first mismatch
+	std::string GetReport() const { return m_Description + ": " + m_FirstMismatch; }
+
+private:
+	std::string m_Description;
+	std::string m_FirstMismatch;
+};
+
+template<typename Function>
+void BenchmarkRunner::Run(const std::string& name, int problemSize, Function function)
+{
+	if (!IsSelected(name))
+		return;
+
+	//1. Warm up: the first sample that takes long enough sets the number of iterations
+	int nrOfIterations = 1;
+	double time = TimeIterations(function, nrOfIterations);
+	while (time < m_MinSampleTime && nrOfIterations < (1 << 24))
+	{
+		const double factor = time > 0.0 ? 1.2 * m_MinSampleTime / time : 10.0;
+		nrOfIterations = static_cast<int>(nrOfIterations * (factor < 2.0 ? 2.0 : factor > 10.0 ? 10.0 : factor));
+		time = TimeIterations(function, nrOfIterations);
+	}
+
+	//2. Samples
+	m_Samples.resize(m_NrOfSamples);
+	for (double& sample : m_Samples)
+		sample = TimeIterations(function, nrOfIterations) / nrOfIterations;
+
+	AddResult(name, problemSize, nrOfIterations);
+}
+
+template<typename Function>
+double BenchmarkRunner::TimeIterations(Function& function, int nrOfIterations)
+{
+	double sink = 0.0;
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < nrOfIterations; ++i)
+		sink += static_cast<double>(function());
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	m_Sink += sink;
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+template<typename T>
+bool BenchmarkCheck::Expect(const T& actual, const T& expected, const std::string& what, int idx)
+{
+	if (actual == expected)
+		return true;
+
+	if (IsPassed())
+	{
+		//Enough digits to tell floats apart that only differ in the last bit
+		std::ostringstream mismatch{};
+		mismatch.precision(9);
+		mismatch << what << " " << idx << " is " << actual << ", expected " << expected;
+		m_FirstMismatch = mismatch.str();
+	}
+	return false;
+}
+
+inline bool BenchmarkCheck::ExpectNear(float actual, float expected, float tolerance, const std::string& what, int idx)
+{
+	const float magnitude = fabsf(expected) > 1.f ? fabsf(expected) : 1.f;
+	if (fabsf(actual - expected) <= tolerance * magnitude)
+		return true;
+	return Expect(actual, expected, what, idx);
+}
+
+template<typename GetActual, typename GetExpected>
+bool BenchmarkCheck::ExpectAll(int count, GetActual getActual, GetExpected getExpected, const std::string& what)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (!Expect(getActual(i), getExpected(i), what, i))
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,1016 @@
+//Benchmarks of the AI hot paths of the framework, without a window or a physics engine
+//GPP_Benchmarks.exe [--out <file.json>] [--filter <text>] [--samples <count>] [--min-time <seconds>] [--seed <seed>]
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EInfluenceMap.h"
+#include "framework/EliteAI/EliteGraphs/ELayeredInfluenceMap.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EBFS.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/EPathSmoothing.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/ENavGraphPathfinding.h"
+#include "projects/Movement/SteeringBehaviors/Flocking/FlockSimulation.h"
+#include "projects/Movement/SteeringBehaviors/Flocking/FlockingKernels.h"
+#include "projects/Movement/SteeringBehaviors/SpacePartitioning/SpacePartitioning.h"
+
+using namespace Elite;
+
+namespace
+{
+	using TerrainGrid = GridGraph<GridTerrainNode, GraphConnection>;
+	using InfluenceGrid = GridGraph<InfluenceNode, GraphConnection>;
+
+	// Walls across the grid every quarter, with the gap alternating between the top and the bottom,
+	// so a search from one corner to the other has to zigzag through most of the grid
+	void AddWalls(TerrainGrid& grid, int size)
+	{
+		for (int wall = 1; wall < 4; ++wall)
+		{
+			const int col = wall * size / 4;
+			const bool isGapAtTop = wall % 2 == 1;
+			for (int row = 0; row < size; ++row)
+			{
+				const bool isGap = isGapAtTop ? row >= size - 2 : row < 2;
+				if (!isGap)
+					grid.RemoveConnectionsToAdjacentNodes(grid.GetIndex(col, row));
+			}
+		}
+	}
+
+	std::vector<Vector2> CreateBox(const Vector2& center, float width, float height)
+	{
+		const float halfWidth = width / 2.f;
+		const float halfHeight = height / 2.f;
+		return { { center.x - halfWidth, center.y - halfHeight }, { center.x + halfWidth, center.y - halfHeight },
+			{ center.x + halfWidth, center.y + halfHeight }, { center.x - halfWidth, center.y + halfHeight } };
+	}
+
+	// Field of side x side boxes, one jittered box in the middle of every cell of a grid over the world,
+	// the lines between the cells stay free
+	struct ObstacleField
+	{
+		std::vector<Vector2> contour;
+		std::vector<std::vector<Vector2>> obstacles;
+		float cellSize;
+	};
+
+	ObstacleField CreateObstacleField(int side, std::mt19937& generator)
+	{
+		ObstacleField field{};
+		field.cellSize = 12.f;
+		const float worldSize = side * field.cellSize;
+		field.contour = CreateBox({ worldSize / 2.f, worldSize / 2.f }, worldSize, worldSize);
+
+		std::uniform_real_distribution<float> jitter{ -0.15f * field.cellSize, 0.15f * field.cellSize };
+		std::uniform_real_distribution<float> extent{ 0.2f * field.cellSize, 0.4f * field.cellSize };
+		for (int row = 0; row < side; ++row)
+		{
+			for (int col = 0; col < side; ++col)
+			{
+				const Vector2 center{ (col + 0.5f) * field.cellSize + jitter(generator), (row + 0.5f) * field.cellSize + jitter(generator) };
+				field.obstacles.push_back(CreateBox(center, extent(generator), extent(generator)));
+			}
+		}
+		return field;
+	}
+
+	void RunGraphSearchBenchmarks(BenchmarkRunner& runner)
+	{
+		for (int size : { 32, 64, 128, 256 })
+		{
+			TerrainGrid grid{ size, size, 15, false, true, 1.f, 1.5f };
+			AddWalls(grid, size);
+			GridTerrainNode* pStartNode = grid.GetNode(0, 0);
+			GridTerrainNode* pGoalNode = grid.GetNode(size - 1, size - 1);
+			SearchContext<GridTerrainNode, GraphConnection> context{ &grid };
+
+			AStar<GridTerrainNode, GraphConnection> aStar{ &grid, HeuristicFunctions::Chebyshev };
+			runner.Run("AStar/GridGraph", size, [&]() { return aStar.FindPath(pStartNode, pGoalNode, context).size(); });
+
+			// Linear searches over the open and closed lists, quadratic in the size of the search
+			if (size <= 64)
+			{
+				AStar<GridTerrainNode, GraphConnection> openListAStar{ &grid, HeuristicFunctions::Chebyshev, AStarMode::OpenList };
+				runner.Run("AStar/GridGraph/OpenList", size, [&]() { return openListAStar.FindPath(pStartNode, pGoalNode).size(); });
+			}
+
+			BFS<GridTerrainNode, GraphConnection> bfs{ &grid };
+			runner.Run("BFS/GridGraph", size, [&]() { return bfs.FindPath(pStartNode, pGoalNode, context).size(); });
+		}
+	}
+
+	void RunNavMeshBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		for (int side : { 4, 8, 16 })
+		{
+			if (!runner.IsSelected("NavMeshPathfinding/FindPath"))
+				break;
+
+			std::mt19937 generator{ seed };
+			const ObstacleField field = CreateObstacleField(side, generator);
+			std::vector<Polygon> obstacles{};
+			for (const std::vector<Vector2>& obstacle : field.obstacles)
+				obstacles.push_back(Polygon{ obstacle });
+			NavGraph navGraph{ Polygon{ field.contour }, obstacles, 1.f };
+
+			// Queries between crossings of the free lines, from the left half to the right half of the field
+			std::uniform_int_distribution<int> crossing{ 1, side - 1 };
+			std::uniform_int_distribution<int> leftCrossing{ 1, side / 2 - 1 };
+			std::uniform_int_distribution<int> rightCrossing{ side / 2 + 1, side - 1 };
+			std::vector<std::pair<Vector2, Vector2>> queries(64);
+			for (auto& query : queries)
+			{
+				query.first = Vector2{ leftCrossing(generator) * field.cellSize, crossing(generator) * field.cellSize };
+				query.second = Vector2{ rightCrossing(generator) * field.cellSize, crossing(generator) * field.cellSize };
+			}
+
+			SearchContext<NavGraphNode, GraphConnection2D> context{ nullptr };
+			std::vector<Vector2> debugNodePositions{};
+			std::vector<Portal> debugPortals{};
+			size_t queryIdx = 0;
+			runner.Run("NavMeshPathfinding/FindPath", side * side, [&]()
+			{
+				const auto& query = queries[queryIdx++ % queries.size()];
+				return NavMeshPathfinding::FindPath(query.first, query.second, &navGraph, context, debugNodePositions, debugPortals).size();
+			});
+		}
+	}
+
+	// Boxes dropped over the obstacle field, overlapping its obstacles and each other. Added to a tiled navigation mesh
+	// one by one, they have to cut out the same free area as when the mesh is built with them
+	BenchmarkCheck CheckTiledNavMeshObstacles(unsigned int seed)
+	{
+		BenchmarkCheck check{ "Overlapping obstacles added to a tiled navigation mesh do not cut out the free area" };
+		std::mt19937 generator{ seed };
+		const int side = 8;
+		const ObstacleField field = CreateObstacleField(side, generator);
+		std::vector<Polygon> obstacles{};
+		for (const std::vector<Vector2>& obstacle : field.obstacles)
+			obstacles.push_back(Polygon{ obstacle });
+
+		const float worldSize = side * field.cellSize;
+		std::uniform_real_distribution<float> coordinate{ 0.f, worldSize };
+		std::uniform_real_distribution<float> extent{ 0.3f * field.cellSize, 1.2f * field.cellSize };
+		std::vector<Polygon> addedObstacles{};
+		for (int i = 0; i < 24; ++i)
+			addedObstacles.push_back(Polygon{ CreateBox({ coordinate(generator), coordinate(generator) }, extent(generator), extent(generator)) });
+
+		const float tileSize = 2.f * field.cellSize;
+		NavGraph navGraph{ Polygon{ field.contour }, obstacles, 1.f, tileSize };
+		for (int i = 0; i < int(addedObstacles.size()); ++i)
+			check.Expect(navGraph.AddObstacle(addedObstacles[i]), int(field.obstacles.size()) + i, "id of added obstacle", i);
+
+		obstacles.insert(obstacles.end(), addedObstacles.begin(), addedObstacles.end());
+		NavGraph expectedNavGraph{ Polygon{ field.contour }, obstacles, 1.f, tileSize };
+		check.Expect(navGraph.GetAllActiveNodes().size(), expectedNavGraph.GetAllActiveNodes().size(), "number of nodes", 0);
+
+		// A sample is free when no expanded obstacle covers it, the boxes stay boxes when expanded
+		std::vector<std::pair<Vector2, Vector2>> expandedBounds{};
+		for (Polygon obstacle : obstacles)
+		{
+			obstacle.ExpandShape(1.f);
+			expandedBounds.push_back({ { obstacle.GetPosVertMinXPos(), obstacle.GetPosVertMinYPos() }, { obstacle.GetPosVertMaxXPos(), obstacle.GetPosVertMaxYPos() } });
+		}
+
+		const int nrOfSamples = 128;
+		std::array<int, 3> lineNodeIndices{};
+		for (int i = 0; i < nrOfSamples * nrOfSamples; ++i)
+		{
+			const Vector2 position{ (i % nrOfSamples + 0.5f) * worldSize / nrOfSamples, (i / nrOfSamples + 0.5f) * worldSize / nrOfSamples };
+			const bool isFree = std::none_of(expandedBounds.begin(), expandedBounds.end(), [&position](const std::pair<Vector2, Vector2>& bounds)
+			{
+				return position.x > bounds.first.x && position.x < bounds.second.x && position.y > bounds.first.y && position.y < bounds.second.y;
+			});
+			if (!check.Expect(navGraph.GetTriangleFromPosition(position, lineNodeIndices) != nullptr, isFree, "triangle at sample", i))
+				break;
+		}
+		return check;
+	}
+
+	void RunTriangulationBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		for (int side : { 1, 2, 4, 8 })
+		{
+			std::mt19937 generator{ seed };
+			const ObstacleField field = CreateObstacleField(side, generator);
+			Polygon shape{ field.contour };
+			for (const std::vector<Vector2>& obstacle : field.obstacles)
+				shape.AddChild(Polygon{ obstacle });
+
+			// A polygon triangulates once, every iteration triangulates a copy
+			runner.Run("Polygon/Triangulate", side * side, [&]()
+			{
+				Polygon polygon{ shape };
+				return polygon.Triangulate().size();
+			});
+		}
+	}
+
+	void RunNeighborQueryBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		// Same density for every size, about 8 points within the query radius
+		const float queryRadius = 5.f;
+		for (int nrOfPoints : { 1000, 4000, 16000 })
+		{
+			const float worldSize = sqrtf(nrOfPoints * static_cast<float>(E_PI) * queryRadius * queryRadius / 8.f);
+			std::mt19937 generator{ seed };
+			std::uniform_real_distribution<float> coordinate{ 0.f, worldSize };
+			std::vector<Vector2> positions(nrOfPoints);
+			for (Vector2& position : positions)
+				position = Vector2{ coordinate(generator), coordinate(generator) };
+
+			SpatialHashGrid grid{ worldSize, worldSize, queryRadius };
+			runner.Run("SpatialHashGrid/Rebuild", nrOfPoints, [&]()
+			{
+				grid.Rebuild(positions);
+				return grid.GetNrOfCells();
+			});
+
+			grid.Rebuild(positions);
+			std::vector<int> neighbors{};
+			size_t pointIdx = 0;
+			runner.Run("SpatialHashGrid/FindNeighbors", nrOfPoints, [&]()
+			{
+				grid.FindNeighbors(positions[pointIdx++ % positions.size()], queryRadius, neighbors);
+				return neighbors.size();
+			});
+
+			std::vector<NearNeighbor> nearestNeighbors{};
+			runner.Run("SpatialHashGrid/FindNearestNeighbors", nrOfPoints, [&]()
+			{
+				grid.FindNearestNeighbors(positions[pointIdx++ % positions.size()], queryRadius, 4, nearestNeighbors);
+				return nearestNeighbors.size();
+			});
+		}
+	}
+
+	// Opposing sources at random cells, stamped before every propagation like the agents of the app do,
+	// so the field does not decay into denormals that only a benchmark would see
+	struct InfluenceSource
+	{
+		Vector2 position;
+		float influence;
+	};
+
+	std::vector<InfluenceSource> CreateInfluenceSources(int size, unsigned int seed)
+	{
+		std::mt19937 generator{ seed };
+		std::uniform_real_distribution<float> coordinate{ 0.f, size * 10.f };
+		std::vector<InfluenceSource> sources(size);
+		for (int i = 0; i < size; ++i)
+			sources[i] = InfluenceSource{ Vector2{ coordinate(generator), coordinate(generator) }, i % 2 == 0 ? 100.f : -100.f };
+		return sources;
+	}
+
+	// Allocated on the heap because the influence map does not copy
+	InfluenceMap<InfluenceGrid>* CreateInfluenceMap(int size, bool isConnectedDiagonally)
+	{
+		auto pInfluenceMap = new InfluenceMap<InfluenceGrid>{ false };
+		pInfluenceMap->InitializeGrid(size, size, 10, false, isConnectedDiagonally);
+		pInfluenceMap->InitializeBuffer();
+		return pInfluenceMap;
+	}
+
+	float StampAndPropagate(InfluenceMap<InfluenceGrid>& influenceMap, const std::vector<InfluenceSource>& sources)
+	{
+		for (const InfluenceSource& source : sources)
+			influenceMap.SetInfluenceAtPosition(source.position, source.influence);
+		influenceMap.PropagateInfluence(1.f / 60.f);
+		return influenceMap.GetNode(0)->GetInfluence();
+	}
+
+	bool ExpectSameInfluences(BenchmarkCheck& check, const InfluenceMap<InfluenceGrid>& influenceMap, const InfluenceMap<InfluenceGrid>& expectedMap, const std::string& what)
+	{
+		return check.ExpectAll(influenceMap.GetNrOfNodes(),
+			[&](int idx) { return influenceMap.GetNode(idx)->GetInfluence(); },
+			[&](int idx) { return expectedMap.GetNode(idx)->GetInfluence(); }, what);
+	}
+
+	// The stencil has to give the same floats as the propagation over the nodes, walls included
+	BenchmarkCheck CheckInfluenceStencil(unsigned int seed)
+	{
+		BenchmarkCheck check{ "The influence map stencil does not match the propagation over the nodes" };
+		for (bool isConnectedDiagonally : { false, true })
+		{
+			const int size = 37; // not a multiple of the vector width
+			const std::vector<InfluenceSource> sources = CreateInfluenceSources(size / 4, seed);
+			InfluenceMap<InfluenceGrid>* pMaps[2]{ CreateInfluenceMap(size, isConnectedDiagonally), CreateInfluenceMap(size, isConnectedDiagonally) };
+			pMaps[0]->SetUseStencil(false);
+			pMaps[1]->SetNrOfStencilThreads(2);
+			for (InfluenceMap<InfluenceGrid>* pMap : pMaps)
+			{
+				for (int row = 0; row < size - 4; ++row)
+					pMap->RemoveConnectionsToAdjacentNodes(pMap->GetIndex(size / 2, row));
+			}
+
+			//The sources stop after a while so the influence also fades, influence written on a node has to reach the stencil too
+			for (int step = 0; step < 100; ++step)
+			{
+				for (InfluenceMap<InfluenceGrid>* pMap : pMaps)
+				{
+					if (step == 60)
+						pMap->GetNode(size + 3)->SetInfluence(75.f);
+
+					if (step < 50)
+						StampAndPropagate(*pMap, sources);
+					else
+						pMap->PropagateInfluence(1.f / 60.f);
+				}
+			}
+
+			ExpectSameInfluences(check, *pMaps[1], *pMaps[0], isConnectedDiagonally ? "diagonal grid, cell" : "straight grid, cell");
+
+			SAFE_DELETE(pMaps[0]);
+			SAFE_DELETE(pMaps[1]);
+		}
+		return check;
+	}
+
+	// Sparse propagation with an epsilon of 0 has to give the same floats as sweeping every cell,
+	// with sources that move, stop, a momentum that changes halfway and a node set in a settled region
+	BenchmarkCheck CheckSparseInfluencePropagation(unsigned int seed)
+	{
+		BenchmarkCheck check{ "Sparse influence propagation does not match sweeping every cell" };
+		const int size = 75; // not a multiple of the tile size
+		std::vector<InfluenceSource> sources = CreateInfluenceSources(4, seed);
+		InfluenceMap<InfluenceGrid>* pMaps[2]{ CreateInfluenceMap(size, true), CreateInfluenceMap(size, true) };
+		pMaps[1]->SetSparsePropagation(true);
+		pMaps[1]->SetNrOfStencilThreads(2);
+		for (InfluenceMap<InfluenceGrid>* pMap : pMaps)
+		{
+			for (int row = 10; row < size; ++row)
+				pMap->RemoveConnectionsToAdjacentNodes(pMap->GetIndex(size / 3, row));
+		}
+
+		for (int step = 0; step < 400; ++step)
+		{
+			for (InfluenceSource& source : sources)
+				source.position += Vector2{ 1.5f, 0.5f };
+			for (InfluenceMap<InfluenceGrid>* pMap : pMaps)
+			{
+				pMap->SetMomentum(step < 200 ? 0.3f : 0.6f);
+				if (step == 250)
+					pMap->GetNode(pMap->GetIndex(size - 5, 5))->SetInfluence(-80.f);
+				if (step < 100)
+					StampAndPropagate(*pMap, sources);
+				else
+					pMap->PropagateInfluence(1.f / 60.f);
+			}
+
+			ExpectSameInfluences(check, *pMaps[1], *pMaps[0], "step " + std::to_string(step) + ", cell");
+		}
+
+		SAFE_DELETE(pMaps[0]);
+		SAFE_DELETE(pMaps[1]);
+		return check;
+	}
+
+	// Stamps of a few radii and every falloff, some of them partly off the grid
+	std::vector<InfluenceStamp> CreateInfluenceStamps(int count, int size, unsigned int seed)
+	{
+		const InfluenceFalloff falloffs[]{ InfluenceFalloff::Constant, InfluenceFalloff::Linear, InfluenceFalloff::Quadratic };
+		std::mt19937 generator{ seed };
+		std::uniform_real_distribution<float> coordinate{ -20.f, size * 10.f + 20.f };
+		std::uniform_real_distribution<float> radius{ 0.f, 60.f };
+		std::vector<InfluenceStamp> stamps(count);
+		for (int i = 0; i < count; ++i)
+		{
+			//Half of the stamps share a radius, like the agents of one kind do
+			const float stampRadius = i % 2 == 0 ? 35.f : radius(generator);
+			stamps[i] = InfluenceStamp{ Vector2{ coordinate(generator), coordinate(generator) }, i % 3 == 0 ? -100.f : 50.f + i, stampRadius, falloffs[i % 3] };
+		}
+		return stamps;
+	}
+
+	// Stamping has to cover the same cells with the same floats as testing every cell against every stamp,
+	// on one thread and in bands of rows, on the nodes and on a layer
+	BenchmarkCheck CheckInfluenceStamps(unsigned int seed)
+	{
+		BenchmarkCheck check{ "Stamped influences do not match the cells within the radius of the stamps" };
+		const int size = 45;
+		const float cellSize = 10.f;
+		for (int nrOfStamps : { 5, 200 })
+		{
+			const std::vector<InfluenceStamp> stamps = CreateInfluenceStamps(nrOfStamps, size, seed);
+			std::vector<float> expected(size * size);
+			for (int i = 0; i < size * size; ++i)
+				expected[i] = i * 0.5f;
+
+			for (int row = 0; row < size; ++row)
+			{
+				for (int col = 0; col < size; ++col)
+				{
+					bool isCovered = false;
+					for (const InfluenceStamp& stamp : stamps)
+					{
+						const float roundedRadius = roundf(stamp.radius / cellSize * 16.f) / 16.f;
+						const float radiusInCells = roundedRadius > 0.f ? roundedRadius : 0.f;
+						const int dx = col - int(floorf(stamp.position.x / cellSize));
+						const int dy = row - int(floorf(stamp.position.y / cellSize));
+						const int distanceSquared = dx * dx + dy * dy;
+						if (abs(dx) > int(radiusInCells) || abs(dy) > int(radiusInCells) || float(distanceSquared) > radiusInCells * radiusInCells)
+							continue;
+
+						const float relativeDistance = radiusInCells > 0.f ? sqrtf(float(distanceSquared)) / radiusInCells : 0.f;
+						const float influence = stamp.influence * GetInfluenceFalloff(stamp.falloff, relativeDistance);
+						float& cellInfluence = expected[row * size + col];
+						if (!isCovered || IsStrongerInfluence(influence, cellInfluence))
+							cellInfluence = influence;
+						isCovered = true;
+					}
+				}
+			}
+
+			InfluenceMap<InfluenceGrid>* pInfluenceMap = CreateInfluenceMap(size, true);
+			pInfluenceMap->SetNrOfStencilThreads(3);
+			pInfluenceMap->PropagateInfluence(1.f / 60.f);
+			for (int i = 0; i < size * size; ++i)
+				pInfluenceMap->SetInfluenceAtPosition(pInfluenceMap->GetNodeWorldPos(i), i * 0.5f);
+			pInfluenceMap->StampInfluences(stamps);
+
+			LayeredInfluenceMap<InfluenceGrid>* pLayeredMap = new LayeredInfluenceMap<InfluenceGrid>{ false };
+			pLayeredMap->InitializeGrid(size, size, int(cellSize), false, true);
+			pLayeredMap->AddLayer();
+			for (int i = 0; i < size * size; ++i)
+				pLayeredMap->SetInfluence(0, i, i * 0.5f);
+			pLayeredMap->StampInfluences(0, stamps);
+
+			const std::string what = std::to_string(nrOfStamps) + " stamps, ";
+			auto getExpected = [&expected](int idx) { return expected[idx]; };
+			check.ExpectAll(size * size, [&](int idx) { return pInfluenceMap->GetNode(idx)->GetInfluence(); }, getExpected, what + "cell");
+			check.ExpectAll(size * size, [&](int idx) { return pLayeredMap->GetInfluence(0, idx); }, getExpected, what + "layer cell");
+
+			//The stencil has to hold the stamped influences as well
+			InfluenceMap<InfluenceGrid>* pReferenceMap = CreateInfluenceMap(size, true);
+			for (int i = 0; i < size * size; ++i)
+				pReferenceMap->SetInfluenceAtPosition(pReferenceMap->GetNodeWorldPos(i), expected[i]);
+			pInfluenceMap->PropagateInfluence(1.f / 60.f);
+			pReferenceMap->PropagateInfluence(1.f / 60.f);
+			ExpectSameInfluences(check, *pInfluenceMap, *pReferenceMap, what + "propagated cell");
+
+			SAFE_DELETE(pReferenceMap);
+			SAFE_DELETE(pLayeredMap);
+			SAFE_DELETE(pInfluenceMap);
+		}
+		return check;
+	}
+
+	void RunInfluenceMapBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		for (int size : { 32, 64, 128, 256 })
+		{
+			const std::vector<InfluenceSource> sources = CreateInfluenceSources(size, seed);
+			InfluenceMap<InfluenceGrid>* pInfluenceMap = CreateInfluenceMap(size, true);
+			runner.Run("InfluenceMap/PropagateInfluence", size * size, [&]()
+			{
+				return StampAndPropagate(*pInfluenceMap, sources);
+			});
+
+			pInfluenceMap->SetNrOfStencilThreads(1);
+			runner.Run("InfluenceMap/PropagateInfluence/OneThread", size * size, [&]()
+			{
+				return StampAndPropagate(*pInfluenceMap, sources);
+			});
+
+			pInfluenceMap->SetUseStencil(false);
+			runner.Run("InfluenceMap/PropagateInfluence/Nodes", size * size, [&]()
+			{
+				return StampAndPropagate(*pInfluenceMap, sources);
+			});
+			SAFE_DELETE(pInfluenceMap);
+		}
+
+		//A few sources that walk across a large map, most of it stays at rest
+		for (int size : { 128, 256 })
+		{
+			for (bool isSparse : { false, true })
+			{
+				std::vector<InfluenceSource> sources = CreateInfluenceSources(8, seed);
+				InfluenceMap<InfluenceGrid>* pInfluenceMap = CreateInfluenceMap(size, true);
+				pInfluenceMap->SetSparsePropagation(isSparse, 0.01f);
+
+				int step = 0;
+				auto walkAndPropagate = [&]()
+				{
+					for (size_t i = 0; i < sources.size(); ++i)
+					{
+						const float angle = (step + i * 50) * 0.01f;
+						sources[i].position = Vector2{ size * 5.f, size * 5.f } + Vector2{ cosf(angle), sinf(angle * 0.7f) } * (size * 4.f);
+					}
+					++step;
+					return StampAndPropagate(*pInfluenceMap, sources);
+				};
+				for (int i = 0; i < 200; ++i)
+					walkAndPropagate();
+
+				runner.Run(isSparse ? "InfluenceMap/WalkingSources/Sparse" : "InfluenceMap/WalkingSources",
+					size * size, walkAndPropagate);
+				SAFE_DELETE(pInfluenceMap);
+			}
+		}
+
+		//Every stamp of a tick at once against one radius stamp at a time, on a large map
+		for (int nrOfStamps : { 16, 256, 4096 })
+		{
+			const int size = 256;
+			const std::vector<InfluenceStamp> stamps = CreateInfluenceStamps(nrOfStamps, size, seed);
+			InfluenceMap<InfluenceGrid>* pInfluenceMap = CreateInfluenceMap(size, true);
+			pInfluenceMap->PropagateInfluence(1.f / 60.f);
+
+			runner.Run("InfluenceMap/StampInfluences", nrOfStamps, [&]()
+			{
+				pInfluenceMap->StampInfluences(stamps);
+				return pInfluenceMap->GetNode(0)->GetInfluence();
+			});
+
+			runner.Run("InfluenceMap/SetInfluenceAtPosition/Radius", nrOfStamps, [&]()
+			{
+				for (const InfluenceStamp& stamp : stamps)
+					pInfluenceMap->SetInfluenceAtPosition(stamp.position, stamp.influence, stamp.radius, 10);
+				return pInfluenceMap->GetNode(0)->GetInfluence();
+			});
+			SAFE_DELETE(pInfluenceMap);
+		}
+	}
+
+	// Threat and food are stamped every tick, allies and visibility are set once and settle
+	LayeredInfluenceMap<InfluenceGrid>* CreateLayeredInfluenceMap(int size, const std::vector<InfluenceSource>& sources)
+	{
+		auto pInfluenceMap = new LayeredInfluenceMap<InfluenceGrid>{ false };
+		pInfluenceMap->InitializeGrid(size, size, 10, false, true);
+		pInfluenceMap->AddLayer(0.3f, 0.5f, 0.f);
+		pInfluenceMap->AddLayer(0.1f, 0.2f, 0.f);
+		for (int layerIdx : { pInfluenceMap->AddLayer(0.3f, 0.8f, 0.f), pInfluenceMap->AddLayer(0.5f, 1.f, 0.f) })
+		{
+			for (const InfluenceSource& source : sources)
+				pInfluenceMap->SetInfluenceAtPosition(layerIdx, source.position, source.influence);
+		}
+		return pInfluenceMap;
+	}
+
+	void StampLayers(LayeredInfluenceMap<InfluenceGrid>& influenceMap, const std::vector<InfluenceSource>& sources)
+	{
+		for (const InfluenceSource& source : sources)
+		{
+			influenceMap.SetInfluenceAtPosition(0, source.position, fabs(source.influence));
+			influenceMap.SetInfluenceAtPosition(1, source.position + Vector2{ 15.f, 5.f }, fabs(source.influence) * 0.5f);
+		}
+	}
+
+	// A layer propagates like an influence map with the same settings, the queries agree with a loop over every node
+	// and layers that settled are skipped
+	BenchmarkCheck CheckLayeredInfluenceMap(unsigned int seed)
+	{
+		BenchmarkCheck check{ "The layered influence map does not match the influence map or its queries" };
+		const int size = 37;
+		const std::vector<InfluenceSource> sources = CreateInfluenceSources(size / 4, seed);
+		LayeredInfluenceMap<InfluenceGrid>* pLayeredMap = CreateLayeredInfluenceMap(size, sources);
+		InfluenceMap<InfluenceGrid>* pInfluenceMap = CreateInfluenceMap(size, true);
+		pInfluenceMap->SetMomentum(0.3f);
+		pInfluenceMap->SetDecay(0.8f);
+		for (const InfluenceSource& source : sources)
+			pInfluenceMap->SetInfluenceAtPosition(source.position, source.influence);
+
+		for (int step = 0; step < 50; ++step)
+		{
+			StampLayers(*pLayeredMap, sources);
+			check.Expect(pLayeredMap->Update(1.f / 60.f), 4, "propagated layers at step", step);
+			pInfluenceMap->PropagateInfluence(1.f / 60.f);
+		}
+		check.ExpectAll(size * size, [&](int idx) { return pLayeredMap->GetInfluence(2, idx); },
+			[&](int idx) { return pInfluenceMap->GetNode(idx)->GetInfluence(); }, "layer cell");
+
+		const std::vector<InfluenceLayerTerm> terms{ { 0, -2.f }, { 1, 1.f }, { 3, 0.5f } };
+		std::vector<float> combined{};
+		pLayeredMap->Combine(terms, combined);
+		check.ExpectAll(size * size, [&](int idx) { return pLayeredMap->GetCombinedInfluence(terms, idx); },
+			[&](int idx) { return combined[idx]; }, "combined cell");
+
+		std::mt19937 generator{ seed };
+		std::uniform_real_distribution<float> coordinate{ -20.f, size * 10.f + 20.f };
+		for (int query = 0; query < 100; ++query)
+		{
+			const Vector2 pos{ coordinate(generator), coordinate(generator) };
+			const float radius = 5.f + query;
+			int maxIdx = invalid_node_index;
+			for (int i = 0; i < size * size; ++i)
+			{
+				if (DistanceSquared(pLayeredMap->GetNodeWorldPos(i), pos) <= radius * radius && (maxIdx == invalid_node_index || combined[i] > combined[maxIdx]))
+					maxIdx = i;
+			}
+			check.Expect(pLayeredMap->FindMaxNodeInRadius(terms, pos, radius), maxIdx, "max node of query", query);
+		}
+
+		//Without stamps the layers settle and stop propagating
+		int nrOfPropagatedLayers = 1;
+		int nrOfSteps = 0;
+		for (; nrOfPropagatedLayers > 0 && nrOfSteps < 100000; ++nrOfSteps)
+			nrOfPropagatedLayers = pLayeredMap->Update(1.f / 60.f);
+		check.Expect(nrOfPropagatedLayers, 0, "propagated layers after settling steps", nrOfSteps);
+
+		SAFE_DELETE(pLayeredMap);
+		SAFE_DELETE(pInfluenceMap);
+		return check;
+	}
+
+	void RunLayeredInfluenceMapBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		const std::vector<InfluenceLayerTerm> terms{ { 0, 2.f }, { 1, -1.f }, { 2, 1.f } };
+		for (int size : { 64, 256 })
+		{
+			const std::vector<InfluenceSource> sources = CreateInfluenceSources(size, seed);
+			LayeredInfluenceMap<InfluenceGrid>* pInfluenceMap = CreateLayeredInfluenceMap(size, sources);
+			for (int step = 0; step < 1000 && pInfluenceMap->Update(1.f / 60.f) > 0; ++step)
+				StampLayers(*pInfluenceMap, sources);
+
+			runner.Run("LayeredInfluenceMap/Update", size * size, [&]()
+			{
+				StampLayers(*pInfluenceMap, sources);
+				return pInfluenceMap->Update(1.f / 60.f);
+			});
+
+			std::vector<float> combined{};
+			runner.Run("LayeredInfluenceMap/Combine", size * size, [&]()
+			{
+				pInfluenceMap->Combine(terms, combined);
+				return combined[0];
+			});
+
+			std::mt19937 generator{ seed };
+			std::uniform_real_distribution<float> coordinate{ 0.f, size * 10.f };
+			std::vector<Vector2> positions(1024);
+			for (Vector2& position : positions)
+				position = Vector2{ coordinate(generator), coordinate(generator) };
+
+			size_t positionIdx = 0;
+			runner.Run("LayeredInfluenceMap/FindMaxNodeInRadius", size * size, [&]()
+			{
+				return pInfluenceMap->FindMaxNodeInRadius(terms, positions[positionIdx++ % positions.size()], 100.f);
+			});
+			runner.Run("LayeredInfluenceMap/GetGradientAtPosition", size * size, [&]()
+			{
+				return pInfluenceMap->GetGradientAtPosition(terms, positions[positionIdx++ % positions.size()]).x;
+			});
+			SAFE_DELETE(pInfluenceMap);
+		}
+	}
+
+	// Plain functions like the behaviors of the apps, one condition per branch
+	template<int T_Branch>
+	bool IsTargetBranch(Blackboard* pBlackboard)
+	{
+		int target{};
+		pBlackboard->GetData("Target", target);
+		return target == T_Branch;
+	}
+
+	template<int... T_Branches>
+	std::vector<bool(*)(Blackboard*)> GetTargetBranchConditions(std::integer_sequence<int, T_Branches...>)
+	{
+		return { &IsTargetBranch<T_Branches>... };
+	}
+
+	BehaviorState CountTick(Blackboard* pBlackboard)
+	{
+		int nrOfTicks{};
+		pBlackboard->GetData("NrOfTicks", nrOfTicks);
+		pBlackboard->ChangeData("NrOfTicks", nrOfTicks + 1);
+		return Success;
+	}
+
+	// Selector over branches of a condition and an action, only the last branch succeeds,
+	// so every tick checks every condition and reads the blackboard once per branch
+	IBehavior* CreateBranches(int nrOfBranches)
+	{
+		const std::vector<bool(*)(Blackboard*)> conditions = GetTargetBranchConditions(std::make_integer_sequence<int, 64>{});
+		std::vector<IBehavior*> branches{};
+		for (int branch = 0; branch < nrOfBranches; ++branch)
+		{
+			branches.push_back(new BehaviorSequence(
+			{
+				new BehaviorConditional(conditions[branch]),
+				new BehaviorAction(CountTick)
+			}));
+		}
+		return new BehaviorSelector(branches);
+	}
+
+	// Leaves that log themselves and return a state that depends on the length of the log,
+	// so two trees that tick the same way log the same
+	int GetLoggedState(Blackboard* pBlackboard, int leafId, int nrOfStates)
+	{
+		std::vector<int>* pLog = nullptr;
+		pBlackboard->GetData("Log", pLog);
+		pLog->push_back(leafId);
+		return static_cast<int>(((pLog->size() * 2654435761u) >> 7) % nrOfStates);
+	}
+
+	bool LogConditional(Blackboard* pBlackboard)
+	{
+		return GetLoggedState(pBlackboard, -1, 2) == 1;
+	}
+
+	BehaviorState LogAction(Blackboard* pBlackboard)
+	{
+		return BehaviorState(GetLoggedState(pBlackboard, -2, 3));
+	}
+
+	IBehavior* CreateRandomBehavior(std::mt19937& generator, int depth)
+	{
+		const int kind = depth < 4 ? generator() % 6 : 3 + generator() % 3;
+		if (kind < 3)
+		{
+			std::vector<IBehavior*> children(generator() % 4);
+			for (IBehavior*& pChild : children)
+				pChild = CreateRandomBehavior(generator, depth + 1);
+
+			if (kind == 0)
+				return new BehaviorSelector(children);
+			if (kind == 1)
+				return new BehaviorSequence(children);
+			return new BehaviorPartialSequence(children);
+		}
+
+		if (kind == 3)
+			return new BehaviorConditional(LogConditional);
+		if (kind == 4)
+			return new BehaviorAction(LogAction);
+
+		//A lambda with captures stays an IBehavior in the compiled tree
+		const int leafId = int(generator() % 100);
+		return new BehaviorAction([leafId](Blackboard* pBlackboard) { return BehaviorState(GetLoggedState(pBlackboard, leafId, 3)); });
+	}
+
+	// The compiled tree has to return the same states and tick the same leaves in the same order as the tree,
+	// partial sequences included, which carry their progress over to the next tick
+	BenchmarkCheck CheckCompiledBehaviorTree(unsigned int seed)
+	{
+		BenchmarkCheck check{ "The compiled behavior tree does not tick like the behavior tree" };
+		for (unsigned int tree = 0; tree < 50; ++tree)
+		{
+			std::vector<int> logs[2]{};
+			Blackboard* pBlackboards[2]{ new Blackboard(), new Blackboard() };
+			for (int i = 0; i < 2; ++i)
+				pBlackboards[i]->AddData("Log", &logs[i]);
+
+			std::mt19937 generators[2]{ std::mt19937{ seed + tree }, std::mt19937{ seed + tree } };
+			BehaviorTree behaviorTree{ pBlackboards[0], CreateRandomBehavior(generators[0], 0) };
+			CompiledBehaviorTree compiledTree{ pBlackboards[1], CreateRandomBehavior(generators[1], 0) };
+			for (int tick = 0; tick < 100; ++tick)
+			{
+				behaviorTree.Update(1.f / 60.f);
+				compiledTree.Update(1.f / 60.f);
+				check.Expect(compiledTree.GetCurrentState(), behaviorTree.GetCurrentState(), "tree " + std::to_string(tree) + ", state at tick", tick);
+			}
+
+			if (check.Expect(int(logs[1].size()), int(logs[0].size()), "log length of tree", int(tree)))
+				check.ExpectAll(int(logs[0].size()), [&](int idx) { return logs[1][idx]; }, [&](int idx) { return logs[0][idx]; }, "tree " + std::to_string(tree) + ", logged leaf");
+		}
+		return check;
+	}
+
+	// Random neighborhoods of every size around the SIMD widths, with neighbors within distance 1 to mask out of the separation
+	std::vector<FlockNeighborhood> CreateFlockNeighborhoods(int nrOfNeighborhoods, int maxSize, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<float> offset{ -8.f, 8.f };
+		std::uniform_real_distribution<float> velocity{ -20.f, 20.f };
+		std::vector<FlockNeighborhood> neighborhoods(nrOfNeighborhoods);
+		for (size_t n = 0; n < neighborhoods.size(); ++n)
+		{
+			const int size = int(n) % (maxSize + 1);
+			for (int i = 0; i < size; ++i)
+			{
+				const float scale = i % 5 == 0 ? 0.1f : 1.f;
+				neighborhoods[n].Add({ offset(generator) * scale, offset(generator) * scale }, { velocity(generator), velocity(generator) });
+			}
+		}
+		return neighborhoods;
+	}
+
+	// The SIMD sums add the neighbors up in another order than the scalar ones, so they only have to be close
+	BenchmarkCheck CheckFlockingKernels(unsigned int seed)
+	{
+		BenchmarkCheck check{ std::string{ "The " } + FlockingKernels::GetInstructionSet() + " flocking kernels do not sum the neighbors like the scalar ones" };
+		std::mt19937 generator{ seed };
+		const std::vector<FlockNeighborhood> neighborhoods = CreateFlockNeighborhoods(200, 40, generator);
+		const float tolerance = 1e-4f;
+		for (int n = 0; n < int(neighborhoods.size()); ++n)
+		{
+			const FlockNeighborhood& neighborhood = neighborhoods[n];
+			const FlockNeighborSums sums = FlockingKernels::SumNeighbors(neighborhood);
+			const FlockNeighborSums expectedSums = FlockingKernels::SumNeighborsScalar(neighborhood.offsetsX.data(), neighborhood.offsetsY.data(),
+				neighborhood.velocitiesX.data(), neighborhood.velocitiesY.data(), neighborhood.GetSize());
+
+			check.Expect(sums.count, expectedSums.count, "count of neighborhood", n);
+			check.ExpectNear(sums.offsetSum.x, expectedSums.offsetSum.x, tolerance, "offset sum x of neighborhood", n);
+			check.ExpectNear(sums.offsetSum.y, expectedSums.offsetSum.y, tolerance, "offset sum y of neighborhood", n);
+			check.ExpectNear(sums.velocitySum.x, expectedSums.velocitySum.x, tolerance, "velocity sum x of neighborhood", n);
+			check.ExpectNear(sums.velocitySum.y, expectedSums.velocitySum.y, tolerance, "velocity sum y of neighborhood", n);
+			check.ExpectNear(sums.separation.x, expectedSums.separation.x, tolerance, "separation x of neighborhood", n);
+			check.ExpectNear(sums.separation.y, expectedSums.separation.y, tolerance, "separation y of neighborhood", n);
+		}
+		return check;
+	}
+
+	void RunFlockingKernelBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		for (int nrOfNeighbors : { 8, 32, 128 })
+		{
+			std::mt19937 generator{ seed };
+			FlockNeighborhood neighborhood = CreateFlockNeighborhoods(nrOfNeighbors + 1, nrOfNeighbors, generator).back();
+
+			runner.Run("FlockingKernels/SumNeighborsScalar", nrOfNeighbors, [&]()
+			{
+				return FlockingKernels::SumNeighborsScalar(neighborhood.offsetsX.data(), neighborhood.offsetsY.data(),
+					neighborhood.velocitiesX.data(), neighborhood.velocitiesY.data(), neighborhood.GetSize()).separation.x;
+			});
+
+			runner.Run(std::string{ "FlockingKernels/SumNeighbors" } + FlockingKernels::GetInstructionSet(), nrOfNeighbors, [&]()
+			{
+				return FlockingKernels::SumNeighbors(neighborhood).separation.x;
+			});
+		}
+	}
+
+	// Flocks at the density of the flocking app, 4000 agents in a world of 150 x 150, fleeing from and seeking the center
+	void SetUpFlockSimulation(FlockSimulation& simulation, float worldSize, int nrOfThreads)
+	{
+		simulation.SetNrOfThreads(nrOfThreads);
+		simulation.SetSeekTarget({ worldSize / 2.f, worldSize / 2.f });
+		simulation.SetAgentToEvade({ worldSize / 2.f, worldSize / 2.f }, { 55.f, 0.f });
+	}
+
+	float GetFlockWorldSize(int flockSize)
+	{
+		const float density = 4000.f / (150.f * 150.f);
+		return sqrtf(flockSize / density);
+	}
+
+	// An agent only writes its own entries, so the flock has to end up the same on any number of threads,
+	// 4 threads even on a machine with fewer cores so the update is always split
+	BenchmarkCheck CheckFlockSimulation(unsigned int seed)
+	{
+		BenchmarkCheck check{ "The flock simulation does not move the same on 1 thread as on 4 threads" };
+		const int flockSize = 2000;
+		const float worldSize = GetFlockWorldSize(flockSize);
+		FlockSimulation serialSimulation{ flockSize, worldSize, seed + 1 };
+		FlockSimulation parallelSimulation{ flockSize, worldSize, seed + 1 };
+		SetUpFlockSimulation(serialSimulation, worldSize, 1);
+		SetUpFlockSimulation(parallelSimulation, worldSize, 4);
+		for (int frame = 0; frame < 50; ++frame)
+		{
+			serialSimulation.Update(1.f / 60.f);
+			parallelSimulation.Update(1.f / 60.f);
+		}
+
+		check.ExpectAll(flockSize, [&](int idx) { return parallelSimulation.GetPosition(idx).x; }, [&](int idx) { return serialSimulation.GetPosition(idx).x; }, "position x of agent");
+		check.ExpectAll(flockSize, [&](int idx) { return parallelSimulation.GetPosition(idx).y; }, [&](int idx) { return serialSimulation.GetPosition(idx).y; }, "position y of agent");
+		return check;
+	}
+
+	void RunFlockSimulationBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		//On one thread, and on all threads when there are more
+		std::vector<int> threadCounts{ 1 };
+		if (WorkerPool::GetDefaultNrOfThreads() > 1)
+			threadCounts.push_back(WorkerPool::GetDefaultNrOfThreads());
+
+		for (int flockSize : { 1000, 10000, 50000 })
+		{
+			const float worldSize = GetFlockWorldSize(flockSize);
+			for (int nrOfThreads : threadCounts)
+			{
+				FlockSimulation simulation{ flockSize, worldSize, seed + 1 };
+				SetUpFlockSimulation(simulation, worldSize, nrOfThreads);
+				for (int frame = 0; frame < 10; ++frame)
+					simulation.Update(1.f / 60.f);
+
+				runner.Run(nrOfThreads == 1 ? "FlockSimulation/Update" : "FlockSimulation/UpdateParallel", flockSize, [&]()
+				{
+					simulation.Update(1.f / 60.f);
+					return simulation.GetPosition(0).x;
+				});
+			}
+		}
+	}
+
+	void RunBehaviorTreeBenchmarks(BenchmarkRunner& runner)
+	{
+		for (int nrOfBranches : { 4, 16, 64 })
+		{
+			Blackboard* pBlackboard = new Blackboard();
+			pBlackboard->AddData("Target", nrOfBranches - 1);
+			pBlackboard->AddData("NrOfTicks", 0);
+			BehaviorTree behaviorTree{ pBlackboard, CreateBranches(nrOfBranches) };
+
+			runner.Run("BehaviorTree/Update", nrOfBranches, [&]()
+			{
+				behaviorTree.Update(1.f / 60.f);
+				return nrOfBranches;
+			});
+
+			Blackboard* pCompiledBlackboard = new Blackboard();
+			pCompiledBlackboard->AddData("Target", nrOfBranches - 1);
+			pCompiledBlackboard->AddData("NrOfTicks", 0);
+			CompiledBehaviorTree compiledTree{ pCompiledBlackboard, CreateBranches(nrOfBranches) };
+
+			runner.Run("CompiledBehaviorTree/Update", nrOfBranches, [&]()
+			{
+				compiledTree.Update(1.f / 60.f);
+				return nrOfBranches;
+			});
+		}
+	}
+
+	void RunMatrixBenchmarks(BenchmarkRunner& runner, unsigned int seed)
+	{
+		for (int size : { 16, 64, 128 })
+		{
+			srand(seed);
+			FMatrix a{ size, size };
+			FMatrix b{ size, size };
+			FMatrix result{ size, size };
+			a.Randomize(-1.f, 1.f);
+			b.Randomize(-1.f, 1.f);
+
+			runner.Run("FMatrix/MatrixMultiply", size, [&]()
+			{
+				a.MatrixMultiply(b, result);
+				return result.Get(0, 0);
+			});
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string outputPath = "benchmark_results.json";
+	std::string filter{};
+	int nrOfSamples = 15;
+	float minSampleTime = 0.02f;
+	unsigned int seed = 0;
+	try
+	{
+		for (int i = 1; i < argc; i += 2)
+		{
+			const std::string option = argv[i];
+			if (i + 1 == argc)
+				throw std::invalid_argument(option + " without a value");
+			if (option == "--out")
+				outputPath = argv[i + 1];
+			else if (option == "--filter")
+				filter = argv[i + 1];
+			else if (option == "--samples")
+				nrOfSamples = stoi(string(argv[i + 1]));
+			else if (option == "--min-time")
+				minSampleTime = stof(string(argv[i + 1]));
+			else if (option == "--seed")
+				seed = static_cast<unsigned int>(stoul(string(argv[i + 1])));
+			else
+				throw std::invalid_argument(option);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Invalid argument " << e.what() << std::endl;
+		std::cout << "Usage: GPP_Benchmarks [--out <file.json>] [--filter <text>] [--samples <count>] [--min-time <seconds>] [--seed <seed>]" << std::endl;
+		return 1;
+	}
+
+	//The optimized paths have to give the same results as the code they replace before their timings mean anything
+	bool isPassed = true;
+	for (const BenchmarkCheck& check : { CheckTiledNavMeshObstacles(seed), CheckInfluenceStencil(seed), CheckSparseInfluencePropagation(seed),
+		CheckInfluenceStamps(seed), CheckLayeredInfluenceMap(seed), CheckCompiledBehaviorTree(seed), CheckFlockingKernels(seed), CheckFlockSimulation(seed) })
+	{
+		if (!check.IsPassed())
+		{
+			std::cout << check.GetReport() << std::endl;
+			isPassed = false;
+		}
+	}
+	if (!isPassed)
+		return 1;
+
+	BenchmarkRunner runner{ nrOfSamples, minSampleTime, filter };
+	printf("%-40s %8s %17s %10s\n", "Benchmark", "Size", "Median", "MAD");
+
+	RunGraphSearchBenchmarks(runner);
+	RunNavMeshBenchmarks(runner, seed);
+	RunTriangulationBenchmarks(runner, seed);
+	RunNeighborQueryBenchmarks(runner, seed);
+	RunInfluenceMapBenchmarks(runner, seed);
+	RunLayeredInfluenceMapBenchmarks(runner, seed);
+	RunFlockingKernelBenchmarks(runner, seed);
+	RunFlockSimulationBenchmarks(runner, seed);
+	RunBehaviorTreeBenchmarks(runner);
+	RunMatrixBenchmarks(runner, seed);
+
+	if (!runner.WriteJson(outputPath))
+	{
+		std::cout << "Could not write " << outputPath << std::endl;
+		return 1;
+	}
+	std::cout << runner.GetResults().size() << " results written to " << outputPath << std::endl;
+	return 0;
+}
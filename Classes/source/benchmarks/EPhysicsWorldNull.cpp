@@ -0,0 +1,35 @@
+//=== General Includes ===
+#include "stdafx.h"
+
+//Physics world of the benchmarks: no engine and no static shapes, navigation meshes get their obstacles passed in
+
+//=== Constructors & Destructors ===
+template<>
+PhysicsWorld::~EPhysicsWorld()
+{
+}
+
+//=== Functions ===
+template<>
+void PhysicsWorld::Initialize()
+{
+	m_pPhysicsWorld = nullptr;
+}
+
+template<>
+void PhysicsWorld::Simulate(float elapsedTime)
+{
+	UNREFERENCED_PARAMETER(elapsedTime);
+}
+
+template<>
+void PhysicsWorld::RenderDebug() const
+{
+}
+
+template<>
+std::vector<Elite::Polygon> PhysicsWorld::GetAllStaticShapesInWorld(PhysicsFlags userFlags) const
+{
+	UNREFERENCED_PARAMETER(userFlags);
+	return {};
+}
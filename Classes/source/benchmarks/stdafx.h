@@ -0,0 +1,73 @@
+/*=============================================================================
+stdafx.h: Header for the benchmarks, found before the engine's stdafx.h so the
+		  framework sources build without SDL, OpenGL, ImGui and Box2D.
+=============================================================================*/
+
+/*===========================================================================
+					--- STANDARD LIBRARY INCLUDES ---
+===========================================================================*/
+#pragma once
+#pragma region StandardLibraryIncludes
+#include <iostream>
+#include <cstdarg>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <math.h>
+#include <fstream>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include <list>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <map>
+using namespace std;
+#pragma endregion //StandardLibraryIncludes
+
+/*===========================================================================
+							--- UTILITIES ---
+===========================================================================*/
+#pragma region Utilities
+//=== Suppressors ===
+#define UNREFERENCED_PARAMETER(x) (x)
+
+//=== Management ===
+#define SAFE_DELETE(p) if (p) { delete (p); (p) = nullptr; }
+
+//=== Exception ===
+struct Elite_Exception
+{
+	explicit Elite_Exception(const std::string& msg) :_msg(msg) {}
+	const std::string _msg;
+};
+
+//=== Assert ===
+#define ELITE_ASSERT(condition, message) assert(condition);
+
+//=== Profiling ===
+//The benchmarks time themselves, the scopes in the framework cost nothing here
+#define ELITE_PROFILE_SCOPE(name)
+#pragma endregion //Utilities
+
+/*===========================================================================
+						--- FRAMEWORK INCLUDES ---
+===========================================================================*/
+#pragma region FrameworkIncludes
+#include "framework/EliteHelpers/ESingleton.h"
+#include "framework/EliteMath/EMath.h"
+#include "framework/ElitePhysics/EPhysics.h"
+#include "framework/EliteRendering/ERenderingTypes.h"
+#include "framework/EliteGeometry/EGeometry.h"
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteData/EBlackboard.h"
+#include "framework/EliteAI/EliteDecisionMaking/EDecisionMaking.h"
+#pragma endregion //FrameworkIncludes
+
+/* --- FRAMEWORK MACROS ---- */
+//No physics engine: a world without shapes, see EPhysicsWorldNull.cpp
+typedef Elite::EPhysicsWorld<void*> PhysicsWorld;
+#define PHYSICSWORLD PhysicsWorld::GetInstance()
@@ -30,6 +30,7 @@ namespace Elite
 //FSM & BT
 #include "framework/EliteAI/EliteDecisionMaking/EliteFiniteStateMachine/EFiniteStateMachine.h"
 #include "framework/EliteAI/EliteDecisionMaking/EliteBehaviorTree/EBehaviorTree.h"
+#include "framework/EliteAI/EliteDecisionMaking/EliteBehaviorTree/ECompiledBehaviorTree.h"
 
 
 #endif
@@ -54,6 +54,7 @@ namespace Elite
 		}
 
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override = 0;
+		const std::vector<IBehavior*>& GetChildren() const { return m_ChildrenBehaviors; }
 
 	protected:
 		std::vector<IBehavior*> m_ChildrenBehaviors = {};
@@ -104,6 +105,7 @@ namespace Elite
 	public:
 		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		const std::function<bool(Blackboard*)>& GetConditional() const { return m_fpConditional; }
 
 	private:
 		std::function<bool(Blackboard*)> m_fpConditional = nullptr;
@@ -117,6 +119,7 @@ namespace Elite
 	public:
 		explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp) : m_fpAction(fp) {}
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		const std::function<BehaviorState(Blackboard*)>& GetAction() const { return m_fpAction; }
 
 	private:
 		std::function<BehaviorState(Blackboard*)> m_fpAction = nullptr;
@@ -148,6 +151,8 @@ namespace Elite
 		}
 		Blackboard* GetBlackboard() const
 		{ return m_pBlackBoard;	}
+		BehaviorState GetCurrentState() const
+		{ return m_CurrentState; }
 
 	private:
 		BehaviorState m_CurrentState = Failure;
@@ -0,0 +1,175 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "ECompiledBehaviorTree.h"
+#include <typeinfo>
+using namespace Elite;
+
+//=== Constructors & Destructors ===
+CompiledBehaviorTree::CompiledBehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
+	: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior)
+{
+	if (m_pRootBehavior)
+	{
+		Flatten(m_pRootBehavior, -1);
+		Link();
+	}
+}
+
+CompiledBehaviorTree::~CompiledBehaviorTree()
+{
+	SAFE_DELETE(m_pRootBehavior);
+	SAFE_DELETE(m_pBlackBoard); //Takes ownership of passed blackboard!
+}
+
+//=== Functions ===
+void CompiledBehaviorTree::Update(float deltaTime)
+{
+	if (m_pRootBehavior == nullptr)
+	{
+		m_CurrentState = Failure;
+		return;
+	}
+
+	m_CurrentState = Execute();
+}
+
+void CompiledBehaviorTree::Flatten(IBehavior* pBehavior, int parentIdx)
+{
+	const int nodeIdx = int(m_Nodes.size());
+	m_Nodes.push_back(CompiledBehavior{ CompiledBehaviorType::Behavior, parentIdx, 0, nodeIdx, {}, nodeIdx + 1, nullptr, nullptr, pBehavior });
+
+	//Only the exact types, a class derived from a composite can tick its children differently
+	const std::type_info& type = typeid(*pBehavior);
+	BehaviorComposite* pComposite = nullptr;
+	if (type == typeid(BehaviorSelector))
+	{
+		m_Nodes[nodeIdx].type = CompiledBehaviorType::Selector;
+		pComposite = static_cast<BehaviorComposite*>(pBehavior);
+	}
+	else if (type == typeid(BehaviorSequence))
+	{
+		m_Nodes[nodeIdx].type = CompiledBehaviorType::Sequence;
+		pComposite = static_cast<BehaviorComposite*>(pBehavior);
+	}
+	else if (type == typeid(BehaviorPartialSequence))
+	{
+		m_Nodes[nodeIdx].type = CompiledBehaviorType::PartialSequence;
+		pComposite = static_cast<BehaviorComposite*>(pBehavior);
+	}
+	else if (type == typeid(BehaviorConditional))
+	{
+		auto pfpConditional = static_cast<BehaviorConditional*>(pBehavior)->GetConditional().target<bool(*)(Blackboard*)>();
+		if (pfpConditional && *pfpConditional)
+		{
+			m_Nodes[nodeIdx].type = CompiledBehaviorType::Conditional;
+			m_Nodes[nodeIdx].fpConditional = *pfpConditional;
+		}
+	}
+	else if (type == typeid(BehaviorAction))
+	{
+		auto pfpAction = static_cast<BehaviorAction*>(pBehavior)->GetAction().target<BehaviorState(*)(Blackboard*)>();
+		if (pfpAction && *pfpAction)
+		{
+			m_Nodes[nodeIdx].type = CompiledBehaviorType::Action;
+			m_Nodes[nodeIdx].fpAction = *pfpAction;
+		}
+	}
+
+	if (pComposite)
+	{
+		for (IBehavior* pChild : pComposite->GetChildren())
+			Flatten(pChild, nodeIdx);
+	}
+	m_Nodes[nodeIdx].end = int(m_Nodes.size());
+}
+
+void CompiledBehaviorTree::Link()
+{
+	//A selector or sequence with children is entered at the entry of its first child, which comes after it
+	for (int nodeIdx = int(m_Nodes.size()) - 1; nodeIdx >= 0; --nodeIdx)
+	{
+		CompiledBehavior& node = m_Nodes[nodeIdx];
+		const bool isSelectorOrSequence = node.type == CompiledBehaviorType::Selector || node.type == CompiledBehaviorType::Sequence;
+		node.entry = isSelectorOrSequence && node.end > nodeIdx + 1 ? m_Nodes[nodeIdx + 1].entry : nodeIdx;
+	}
+
+	//A selector tries its next child after a failure, a sequence after a success, otherwise they finish with the same state.
+	//The links of a parent come before the ones of its children.
+	for (int nodeIdx = 0; nodeIdx < int(m_Nodes.size()); ++nodeIdx)
+	{
+		CompiledBehavior& node = m_Nodes[nodeIdx];
+		for (int state = Failure; state <= Running; ++state)
+		{
+			if (node.parent < 0)
+			{
+				node.next[state] = CompiledBehavior::ReturnState;
+				continue;
+			}
+
+			const CompiledBehavior& parent = m_Nodes[node.parent];
+			const bool hasNextChild = node.end < parent.end;
+			if (parent.type == CompiledBehaviorType::PartialSequence)
+				node.next[state] = CompiledBehavior::ToPartialSequence - nodeIdx;
+			else if (hasNextChild && state == (parent.type == CompiledBehaviorType::Selector ? Failure : Success))
+				node.next[state] = m_Nodes[node.end].entry;
+			else
+				node.next[state] = parent.next[state];
+		}
+	}
+}
+
+BehaviorState CompiledBehaviorTree::Execute()
+{
+	CompiledBehavior* pNodes = m_Nodes.data();
+	int nodeIdx = pNodes[0].entry;
+	for (;;)
+	{
+		CompiledBehavior* pNode = pNodes + nodeIdx;
+		BehaviorState state;
+		switch (pNode->type)
+		{
+		case CompiledBehaviorType::Conditional:
+			state = pNode->fpConditional(m_pBlackBoard) ? Success : Failure;
+			break;
+		case CompiledBehaviorType::Action:
+			state = pNode->fpAction(m_pBlackBoard);
+			break;
+		case CompiledBehaviorType::Behavior:
+			state = pNode->pBehavior->Execute(m_pBlackBoard);
+			break;
+		case CompiledBehaviorType::PartialSequence:
+			if (pNode->currentChild < pNode->end)
+			{
+				nodeIdx = pNodes[pNode->currentChild].entry;
+				continue;
+			}
+			pNode->currentChild = nodeIdx + 1;
+			state = Success;
+			break;
+		default:
+			//Only a selector or sequence without children is entered itself
+			state = pNode->type == CompiledBehaviorType::Selector ? Failure : Success;
+			break;
+		}
+
+		//A partial sequence runs one child per tick and then finishes itself
+		int nextIdx = pNode->next[state];
+		while (nextIdx < CompiledBehavior::ReturnState)
+		{
+			const CompiledBehavior& child = pNodes[CompiledBehavior::ToPartialSequence - nextIdx];
+			CompiledBehavior& partialSequence = pNodes[child.parent];
+			if (state == Failure)
+				partialSequence.currentChild = child.parent + 1;
+			else if (state == Success)
+			{
+				partialSequence.currentChild = child.end;
+				state = Running;
+			}
+			nextIdx = partialSequence.next[state];
+		}
+
+		if (nextIdx == CompiledBehavior::ReturnState)
+			return state;
+		nodeIdx = nextIdx;
+	}
+}
@@ -0,0 +1,80 @@
+/*=============================================================================*/
+// ECompiledBehaviorTree.h: a behavior tree flattened into one array of linked nodes, ticked without
+// virtual calls through the composites.
+/*=============================================================================*/
+#ifndef ELITE_COMPILED_BEHAVIOR_TREE
+#define ELITE_COMPILED_BEHAVIOR_TREE
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+namespace Elite
+{
+	//-----------------------------------------------------------------
+	// COMPILED BEHAVIOR TREE NODE
+	//-----------------------------------------------------------------
+	enum class CompiledBehaviorType
+	{
+		Selector,
+		Sequence,
+		PartialSequence,
+		Conditional,
+		Action,
+		Behavior // anything else, executed through its IBehavior
+	};
+
+	// The nodes are in depth first order: the children of a node follow it,
+	// the next child starts where the subtree of the previous one ends
+	struct CompiledBehavior
+	{
+		// Links below ReturnState hand the state to a partial sequence, ToPartialSequence - the index of the child that finished
+		enum { ReturnState = -1, ToPartialSequence = -2 };
+
+		CompiledBehaviorType type;
+		int parent; // -1 for the root
+		int end; // index after the subtree of this node
+		int entry; // node that runs when this node is entered, the first leaf of a selector or sequence
+		int next[3]; // per state this node finishes with, the node to enter next, ReturnState or ToPartialSequence
+		int currentChild; // partial sequences, the child to run on the next tick
+		bool(*fpConditional)(Blackboard*);
+		BehaviorState(*fpAction)(Blackboard*);
+		IBehavior* pBehavior; // also leaves whose function is not a plain function, like a lambda with captures
+	};
+
+	//-----------------------------------------------------------------
+	// COMPILED BEHAVIOR TREE
+	// Ticks the same as a BehaviorTree with the same root, from an array of nodes instead of virtual calls.
+	// Selectors and sequences do not keep state, so where a tick continues after a node finished with a state
+	// is known when the tree is compiled. A tick follows those links from leaf to leaf, only partial sequences
+	// decide at run time. Leaves that wrap a plain function call it through a function pointer.
+	// The tree is compiled once, behaviors added to a composite afterwards are not picked up.
+	//-----------------------------------------------------------------
+	class CompiledBehaviorTree final : public Elite::IDecisionMaking
+	{
+	public:
+		// Takes ownership of the root behavior and of the blackboard, like BehaviorTree
+		explicit CompiledBehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior);
+		~CompiledBehaviorTree();
+
+		virtual void Update(float deltaTime) override;
+		Blackboard* GetBlackboard() const
+		{ return m_pBlackBoard;	}
+		BehaviorState GetCurrentState() const
+		{ return m_CurrentState; }
+
+	private:
+		BehaviorState m_CurrentState = Failure;
+		Blackboard* m_pBlackBoard = nullptr;
+		IBehavior* m_pRootBehavior = nullptr;
+
+		std::vector<CompiledBehavior> m_Nodes;
+
+		void Flatten(IBehavior* pBehavior, int parentIdx);
+		void Link();
+		BehaviorState Execute();
+
+		CompiledBehaviorTree(const CompiledBehaviorTree& other) = delete;
+		CompiledBehaviorTree& operator=(const CompiledBehaviorTree& other) = delete;
+	};
+}
+#endif
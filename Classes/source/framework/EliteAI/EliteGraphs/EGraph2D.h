@@ -82,6 +82,8 @@ namespace Elite
 				connection->SetCost(abs(Distance(posFrom, posTo)));
 			}
 		}
+
+		MarkGraphModified(false, false);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
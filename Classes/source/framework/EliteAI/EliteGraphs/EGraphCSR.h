@@ -0,0 +1,64 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphCSR.h: Frozen compressed-sparse-row view of the adjacency lists of a graph
+/*=============================================================================*/
+
+#pragma once
+
+namespace Elite
+{
+	// All connections stored in 2 contiguous arrays (neighbor indices + costs), grouped per node
+	// The connections of node idx are the entries in the range [GetBegin(idx), GetEnd(idx))
+	// Built and owned by IGraph, see IGraph::GetCSR()
+	class GraphCSR final
+	{
+	public:
+		GraphCSR() = default;
+		~GraphCSR() = default;
+
+		// Building: call AddConnection for every connection of a node, followed by EndNode, for every node in order
+		void Clear();
+		void Reserve(int nrOfNodes, int nrOfConnections);
+		void AddConnection(int to, float cost) { m_Neighbors.push_back(to); m_Costs.push_back(cost); }
+		void EndNode() { m_Offsets.push_back((int)m_Neighbors.size()); }
+
+		// Traversal
+		int GetBegin(int idx) const { return m_Offsets[idx]; }
+		int GetEnd(int idx) const { return m_Offsets[idx + 1]; }
+		int GetNeighbor(int connectionIdx) const { return m_Neighbors[connectionIdx]; }
+		float GetCost(int connectionIdx) const { return m_Costs[connectionIdx]; }
+
+		int GetNrOfNodes() const { return (int)m_Offsets.size() - 1; }
+		int GetNrOfConnections() const { return (int)m_Neighbors.size(); }
+		size_t GetMemoryUsage() const;
+
+	private:
+		vector<int> m_Offsets{ 0 }; // nrOfNodes + 1 entries, m_Offsets[idx] is the first connection of node idx
+		vector<int> m_Neighbors;
+		vector<float> m_Costs;
+	};
+
+	inline void GraphCSR::Clear()
+	{
+		m_Offsets.clear();
+		m_Offsets.push_back(0);
+		m_Neighbors.clear();
+		m_Costs.clear();
+	}
+
+	inline void GraphCSR::Reserve(int nrOfNodes, int nrOfConnections)
+	{
+		m_Offsets.reserve(nrOfNodes + 1);
+		m_Neighbors.reserve(nrOfConnections);
+		m_Costs.reserve(nrOfConnections);
+	}
+
+	inline size_t GraphCSR::GetMemoryUsage() const
+	{
+		return sizeof(GraphCSR)
+			+ m_Offsets.capacity() * sizeof(int)
+			+ m_Neighbors.capacity() * sizeof(int)
+			+ m_Costs.capacity() * sizeof(float);
+	}
+}
@@ -9,6 +9,7 @@
 
 #include "EGraphEnums.h"
 #include "EliteGraphUtilities/EGraphVisuals.h"
+#include <vector>
 
 namespace Elite
 {
@@ -102,11 +103,31 @@ namespace Elite
 	public:
 		InfluenceNode(int index, Elite::Vector2 pos = { 0,0 }, float influence = 0.f)
 			: GraphNode2D(index, pos), m_Influence(influence) {}
+		// A copy is not written into the list of the original's influence map
+		InfluenceNode(const InfluenceNode& other)
+			: GraphNode2D(other), m_Influence(other.m_Influence) {}
+		InfluenceNode& operator=(const InfluenceNode& other) { GraphNode2D::operator=(other); m_Influence = other.m_Influence; return *this; }
 
 		float GetInfluence() const { return m_Influence; }
-		void SetInfluence(float influence) { m_Influence = influence; }
+		void SetInfluence(float influence)
+		{
+			m_Influence = influence;
+			if (m_pWrittenNodes && !m_IsWritten)
+			{
+				m_IsWritten = true;
+				m_pWrittenNodes->push_back(m_Index);
+			}
+		}
+
+		// An influence map that keeps its own copy of the influences gets the index of every node written since it last looked,
+		// once per node until ClearWritten. The map itself writes with SyncInfluence, which is not listed.
+		void SetWrittenNodes(std::vector<int>* pWrittenNodes) { m_pWrittenNodes = pWrittenNodes; m_IsWritten = false; }
+		void ClearWritten() { m_IsWritten = false; }
+		void SyncInfluence(float influence) { m_Influence = influence; }
 
 	private:
 		float m_Influence;
+		bool m_IsWritten = false;
+		std::vector<int>* m_pWrittenNodes = nullptr;
 	};
 }
\ No newline at end of file
@@ -27,6 +27,10 @@ namespace Elite
 
 		int GetRows() const { return m_NrOfRows; }
 		int GetColumns() const { return m_NrOfColumns; }
+		int GetCellSize() const { return m_CellSize; }
+		bool IsConnectedDiagonally() const { return m_IsConnectedDiagonally; }
+		float GetDefaultCostStraight() const { return m_DefaultCostStraight; }
+		float GetDefaultCostDiagonal() const { return m_DefaultCostDiagonal; }
 
 		bool IsWithinBounds(int col, int row) const;
 		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
@@ -155,7 +159,7 @@ namespace Elite
 			AddConnectionsInDirections(idx, col, row, m_DiagonalDirections);
 		}
 
-		OnGraphModified(false, true);
+		MarkGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
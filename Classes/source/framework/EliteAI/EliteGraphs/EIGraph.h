@@ -9,6 +9,7 @@
 
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
+#include "EGraphCSR.h"
 #include <memory>
 
 namespace Elite
@@ -62,6 +63,11 @@ namespace Elite
 		void Clear();
 		void RemoveConnections();
 
+		// Compact snapshot of all connections, rebuilt on first use after the graph was modified
+		const GraphCSR& GetCSR() const;
+		// Incremented on every modification, lets users of the graph know when their cached data is outdated
+		unsigned int GetRevision() const { return m_Revision; }
+
 		// Visualization
 		// -------------
 		float GetNodeRadius(T_NodeType* pNode) const;
@@ -94,9 +100,18 @@ namespace Elite
 		// Called whenever the graph is modified, to be overriden by derived classes
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
 
+		// Invalidates the cached data of the graph and lets the derived classes know through OnGraphModified
+		void MarkGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged);
+
 	private:
 		int m_NextNodeIndex;
 
+		mutable GraphCSR m_CSR;
+		mutable bool m_IsCSRDirty = true;
+		unsigned int m_Revision = 0;
+
+		void InvalidateCachedData() { m_IsCSRDirty = true; ++m_Revision; }
+
 		// private functions
 		void CullInvalidEdges();
 	};
@@ -133,6 +148,7 @@ namespace Elite
 
 		m_IsDirectionalGraph = other.m_IsDirectionalGraph;
 		m_NextNodeIndex = other.m_NextNodeIndex;
+		InvalidateCachedData();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -206,9 +222,10 @@ namespace Elite
 			assert(m_Nodes[pNode->GetIndex()]->GetIndex() == invalid_node_index &&
 				"<Graph::AddNode>: Attempting to add a node with a duplicate ID");
 
+			//the removed node is not deleted, pointers to it may still be around: whoever removed it owns it now
 			m_Nodes[pNode->GetIndex()] = pNode;
 
-			OnGraphModified(true, false);
+			MarkGraphModified(true, false);
 			return m_NextNodeIndex;
 		}
 		else
@@ -219,7 +236,7 @@ namespace Elite
 			m_Nodes.push_back(pNode);
 			m_Connections.push_back(ConnectionList());
 
-			OnGraphModified(true, false);
+			MarkGraphModified(true, false);
 			return m_NextNodeIndex++;
 		}
 
@@ -273,7 +290,7 @@ namespace Elite
 		}
 		m_Connections[idx].clear();
 
-		OnGraphModified(true, hadConnections);
+		MarkGraphModified(true, hadConnections);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -310,7 +327,7 @@ namespace Elite
 			}
 		}
 		
-		OnGraphModified(false, true);
+		MarkGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -350,7 +367,7 @@ namespace Elite
 		SAFE_DELETE(conFromTo);
 		SAFE_DELETE(conToFrom);
 
-		OnGraphModified(false, true);
+		MarkGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -379,7 +396,7 @@ namespace Elite
 			}
 		}
 
-		OnGraphModified(false, true);
+		MarkGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -394,12 +411,14 @@ namespace Elite
 			curEdge != m_Connections[from].end();
 			++curEdge)
 		{
-			if (curEdge->GetTo() == to)
+			if ((*curEdge)->GetTo() == to)
 			{
-				curEdge->SetCost(cost);
+				(*curEdge)->SetCost(cost);
 				break;
 			}
 		}
+
+		InvalidateCachedData();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -444,6 +463,7 @@ namespace Elite
 		m_Connections.clear();
 
 		m_NextNodeIndex = 0;
+		InvalidateCachedData();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -451,6 +471,36 @@ namespace Elite
 	{
 		for (auto& connectionList : m_Connections)
 			connectionList.clear();
+
+		InvalidateCachedData();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline const GraphCSR& IGraph<T_NodeType, T_ConnectionType>::GetCSR() const
+	{
+		if (m_IsCSRDirty)
+		{
+			m_CSR.Clear();
+			m_CSR.Reserve((int)m_Nodes.size(), GetNrOfConnections());
+
+			for (const auto& connectionList : m_Connections)
+			{
+				for (auto pConnection : connectionList)
+					m_CSR.AddConnection(pConnection->GetTo(), pConnection->GetCost());
+				m_CSR.EndNode();
+			}
+
+			m_IsCSRDirty = false;
+		}
+
+		return m_CSR;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::MarkGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+	{
+		InvalidateCachedData();
+		OnGraphModified(nrOfNodesChanged, nrOfConnectionsChanged);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -1,2 +1,468 @@
 #include "stdafx.h"
 #include "EInfluenceMap.h"
+#include "framework\EliteHelpers\EWorkerPool.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(INFLUENCE_STENCIL_SSE)
+	#include <emmintrin.h>
+#endif
+
+using namespace Elite;
+
+namespace
+{
+	// Neighbor directions of the stencil: (delta column, delta row)
+	const int DIRECTIONS[8][2]{ { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+	// Sweeping fewer cells than this per chunk costs more in handing out the work than it gains
+	const int MIN_CELLS_PER_CHUNK = 16384;
+
+	// Smaller batches of stamps are rasterized on the calling thread
+	const int MIN_STAMPS_FOR_THREADS = 64;
+	const int MIN_STAMP_ROWS_PER_CHUNK = 16;
+	// Radii are rounded to a fraction of a cell so stamps of about the same radius share their kernel
+	const float KERNEL_RADIUS_STEPS_PER_CELL = 16.f;
+	// Radii that vary a lot would otherwise grow the cache of kernels without end
+	const size_t MAX_CACHED_KERNELS = 1024;
+}
+
+//=== Constructors & Destructors ===
+InfluenceGridPropagator::InfluenceGridPropagator()
+	: m_NrOfThreads(WorkerPool::GetDefaultNrOfThreads())
+{
+}
+
+InfluenceGridPropagator::~InfluenceGridPropagator()
+{
+	if (m_IsWorkerPoolOwned)
+		SAFE_DELETE(m_pWorkerPool);
+}
+
+//=== Functions ===
+void InfluenceGridPropagator::Initialize(int columns, int rows)
+{
+	m_NrOfColumns = columns;
+	m_NrOfRows = rows;
+	m_FieldWidth = columns + 2;
+
+	const size_t fieldSize = static_cast<size_t>(m_FieldWidth) * (rows + 2);
+	m_Influences.assign(fieldSize, 0.f);
+	m_NextInfluences.assign(fieldSize, 0.f);
+	for (int d = 0; d < NrOfDirections; ++d)
+		m_Offsets[d] = DIRECTIONS[d][1] * m_FieldWidth + DIRECTIONS[d][0];
+
+	m_NrOfTileColumns = (columns + TileSize - 1) / TileSize;
+	m_NrOfTileRows = (rows + TileSize - 1) / TileSize;
+	m_IsTileToSweep.assign(m_NrOfTileColumns * m_NrOfTileRows, false);
+	ClearWeights();
+}
+
+void InfluenceGridPropagator::ClearWeights()
+{
+	for (int d = 0; d < NrOfDirections; ++d)
+	{
+		m_Weights[d].assign(m_Influences.size(), 0.f);
+		m_IsDirectionUsed[d] = false;
+	}
+	MarkAllTilesChanged();
+}
+
+void InfluenceGridPropagator::SetWeight(int cellIdx, int deltaColumn, int deltaRow, float weight)
+{
+	for (int d = 0; d < NrOfDirections; ++d)
+	{
+		if (DIRECTIONS[d][0] != deltaColumn || DIRECTIONS[d][1] != deltaRow)
+			continue;
+
+		m_Weights[d][ToFieldIdx(cellIdx)] = weight;
+		m_IsDirectionUsed[d] = true;
+		m_IsTileChanged[(cellIdx / m_NrOfColumns / TileSize) * m_NrOfTileColumns + cellIdx % m_NrOfColumns / TileSize] = true;
+		return;
+	}
+}
+
+void InfluenceGridPropagator::SetNrOfThreads(int nrOfThreads)
+{
+	if (m_IsWorkerPoolOwned)
+		SAFE_DELETE(m_pWorkerPool);
+	m_pWorkerPool = nullptr;
+	m_NrOfThreads = nrOfThreads > 1 ? nrOfThreads : 1;
+}
+
+void InfluenceGridPropagator::SetWorkerPool(WorkerPool* pWorkerPool)
+{
+	SetNrOfThreads(pWorkerPool ? pWorkerPool->GetNrOfThreads() : 1);
+	m_pWorkerPool = pWorkerPool;
+	m_IsWorkerPoolOwned = false;
+}
+
+WorkerPool* InfluenceGridPropagator::GetWorkerPool()
+{
+	if (!m_pWorkerPool)
+	{
+		m_pWorkerPool = new WorkerPool(m_NrOfThreads);
+		m_IsWorkerPoolOwned = true;
+	}
+	return m_pWorkerPool;
+}
+
+void InfluenceGridPropagator::SetSparse(bool isSparse, float epsilon)
+{
+	m_IsSparse = isSparse;
+	m_SparseEpsilon = epsilon > 0.f ? epsilon : 0.f;
+	MarkAllTilesChanged();
+}
+
+void InfluenceGridPropagator::GetTileBounds(int tileIdx, int& beginColumn, int& beginRow, int& endColumn, int& endRow) const
+{
+	beginColumn = (tileIdx % m_NrOfTileColumns) * TileSize;
+	beginRow = (tileIdx / m_NrOfTileColumns) * TileSize;
+	endColumn = beginColumn + TileSize < m_NrOfColumns ? beginColumn + TileSize : m_NrOfColumns;
+	endRow = beginRow + TileSize < m_NrOfRows ? beginRow + TileSize : m_NrOfRows;
+}
+
+void InfluenceGridPropagator::MarkAllTilesChanged()
+{
+	//Swept as well, so the first sparse propagation also brings the other buffer up to date
+	m_IsTileChanged.assign(m_NrOfTileColumns * m_NrOfTileRows, true);
+	m_IsTileSwept.assign(m_NrOfTileColumns * m_NrOfTileRows, true);
+}
+
+bool InfluenceGridPropagator::Propagate(float momentum)
+{
+	if (m_NrOfRows <= 0 || m_NrOfColumns <= 0)
+		return false;
+
+	//A grid without diagonal connections skips half of the stencil
+	int directions[NrOfDirections]{};
+	int nrOfDirections = 0;
+	for (int d = 0; d < NrOfDirections; ++d)
+	{
+		if (m_IsDirectionUsed[d])
+			directions[nrOfDirections++] = d;
+	}
+
+	//Unchanged tiles give the same influences again, unless the momentum is different
+	if (momentum != m_LastMomentum)
+	{
+		MarkAllTilesChanged();
+		m_LastMomentum = momentum;
+	}
+
+	//Every row only reads the previous field, so the rows can be swept in any order
+	bool isChanged = false;
+	const int minRowsPerChunk = MIN_CELLS_PER_CHUNK / m_NrOfColumns > 0 ? MIN_CELLS_PER_CHUNK / m_NrOfColumns : 1;
+	if (m_IsSparse)
+	{
+		isChanged = PropagateSparse(momentum, directions, nrOfDirections);
+	}
+	else if (m_NrOfThreads > 1 && m_NrOfRows > minRowsPerChunk)
+	{
+		WorkerPool* pWorkerPool = GetWorkerPool();
+		pWorkerPool->SetMinChunkSize(minRowsPerChunk);
+
+		std::atomic<bool> isAnyChunkChanged{ false };
+		pWorkerPool->ParallelFor(m_NrOfRows, [&](int begin, int end)
+		{
+			if (SweepRows(begin, end, 0, m_NrOfColumns, momentum, directions, nrOfDirections, 0.f))
+				isAnyChunkChanged = true;
+		});
+		isChanged = isAnyChunkChanged;
+	}
+	else
+	{
+		isChanged = SweepRows(0, m_NrOfRows, 0, m_NrOfColumns, momentum, directions, nrOfDirections, 0.f);
+	}
+
+	m_Influences.swap(m_NextInfluences);
+	return isChanged;
+}
+
+bool InfluenceGridPropagator::PropagateSparse(float momentum, const int* pDirections, int nrOfDirections)
+{
+	//1. The changed tiles and the tiles around them, which read from the changed cells on their border
+	std::fill(m_IsTileToSweep.begin(), m_IsTileToSweep.end(), char(false));
+	for (int tileRow = 0; tileRow < m_NrOfTileRows; ++tileRow)
+	{
+		for (int tileColumn = 0; tileColumn < m_NrOfTileColumns; ++tileColumn)
+		{
+			if (!m_IsTileChanged[tileRow * m_NrOfTileColumns + tileColumn])
+				continue;
+
+			const int beginRow = tileRow > 0 ? tileRow - 1 : 0;
+			const int endRow = tileRow + 1 < m_NrOfTileRows ? tileRow + 2 : m_NrOfTileRows;
+			const int beginColumn = tileColumn > 0 ? tileColumn - 1 : 0;
+			const int endColumn = tileColumn + 1 < m_NrOfTileColumns ? tileColumn + 2 : m_NrOfTileColumns;
+			for (int row = beginRow; row < endRow; ++row)
+			{
+				for (int column = beginColumn; column < endColumn; ++column)
+					m_IsTileToSweep[row * m_NrOfTileColumns + column] = true;
+			}
+		}
+	}
+
+	//2. A tile that is not swept keeps its influences, the buffer it gets swapped with has to hold them too
+	m_SweptTiles.clear();
+	for (int tileIdx = 0; tileIdx < int(m_IsTileToSweep.size()); ++tileIdx)
+	{
+		if (m_IsTileToSweep[tileIdx])
+		{
+			m_SweptTiles.push_back(tileIdx);
+		}
+		else if (m_IsTileSwept[tileIdx])
+		{
+			int beginColumn, beginRow, endColumn, endRow;
+			GetTileBounds(tileIdx, beginColumn, beginRow, endColumn, endRow);
+			for (int row = beginRow; row < endRow; ++row)
+			{
+				const int fieldIdx = (row + 1) * m_FieldWidth + beginColumn + 1;
+				std::copy(m_Influences.begin() + fieldIdx, m_Influences.begin() + fieldIdx + endColumn - beginColumn, m_NextInfluences.begin() + fieldIdx);
+			}
+		}
+		m_IsTileSwept[tileIdx] = m_IsTileToSweep[tileIdx];
+		m_IsTileChanged[tileIdx] = false;
+	}
+
+	//3. Every tile only writes its own cells and its own flag
+	std::atomic<bool> isAnyTileChanged{ false };
+	auto sweepTiles = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			const int tileIdx = m_SweptTiles[i];
+			int beginColumn, beginRow, endColumn, endRow;
+			GetTileBounds(tileIdx, beginColumn, beginRow, endColumn, endRow);
+			if (SweepRows(beginRow, endRow, beginColumn, endColumn, momentum, pDirections, nrOfDirections, m_SparseEpsilon))
+			{
+				m_IsTileChanged[tileIdx] = true;
+				isAnyTileChanged = true;
+			}
+		}
+	};
+
+	const int nrOfTiles = int(m_SweptTiles.size());
+	const int minTilesPerChunk = MIN_CELLS_PER_CHUNK / (TileSize * TileSize);
+	if (m_NrOfThreads > 1 && nrOfTiles > minTilesPerChunk)
+	{
+		WorkerPool* pWorkerPool = GetWorkerPool();
+		pWorkerPool->SetMinChunkSize(minTilesPerChunk);
+		pWorkerPool->ParallelFor(nrOfTiles, sweepTiles);
+	}
+	else
+	{
+		sweepTiles(0, nrOfTiles);
+	}
+	return isAnyTileChanged;
+}
+
+bool InfluenceGridPropagator::SweepRows(int beginRow, int endRow, int beginColumn, int endColumn, float momentum, const int* pDirections, int nrOfDirections, float epsilon)
+{
+	bool isChanged = false;
+	const float* pInfluences = m_Influences.data();
+	float* pNextInfluences = m_NextInfluences.data();
+
+	const float* pNeighborInfluences[NrOfDirections]{};
+	const float* pWeights[NrOfDirections]{};
+	for (int n = 0; n < nrOfDirections; ++n)
+	{
+		pNeighborInfluences[n] = pInfluences + m_Offsets[pDirections[n]];
+		pWeights[n] = m_Weights[pDirections[n]].data();
+	}
+
+#if defined(INFLUENCE_STENCIL_SSE)
+	//The strongest influence is either the largest or the smallest one, the largest on a tie, which is what IsStrongerInfluence picks.
+	//Both start at +0 like the loop below, maxps and minps keep the second operand on equal zeros so a -0 never wins either.
+	const __m128 signMask = _mm_set1_ps(-0.f);
+	const __m128 momentum4 = _mm_set1_ps(momentum);
+	const __m128 oneMinusMomentum4 = _mm_set1_ps(1.f - momentum);
+	const __m128 minInfluence4 = _mm_set1_ps(FLT_MIN);
+	const __m128 epsilon4 = _mm_set1_ps(epsilon);
+#endif
+
+	for (int row = beginRow; row < endRow; ++row)
+	{
+		int i = (row + 1) * m_FieldWidth + beginColumn + 1;
+		const int end = i + endColumn - beginColumn;
+
+#if defined(INFLUENCE_STENCIL_SSE)
+		int isChangedMask = 0;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 largest = _mm_setzero_ps();
+			__m128 smallest = _mm_setzero_ps();
+			for (int n = 0; n < nrOfDirections; ++n)
+			{
+				const __m128 influence = _mm_mul_ps(_mm_loadu_ps(pNeighborInfluences[n] + i), _mm_loadu_ps(pWeights[n] + i));
+				largest = _mm_max_ps(influence, largest);
+				smallest = _mm_min_ps(influence, smallest);
+			}
+			const __m128 isSmallestStronger = _mm_cmpgt_ps(_mm_andnot_ps(signMask, smallest), _mm_andnot_ps(signMask, largest));
+			const __m128 strongest = _mm_or_ps(_mm_and_ps(isSmallestStronger, smallest), _mm_andnot_ps(isSmallestStronger, largest));
+
+			//FlushInfluence(Lerp(strongest, current, momentum))
+			const __m128 current = _mm_loadu_ps(pInfluences + i);
+			__m128 next = _mm_add_ps(_mm_mul_ps(oneMinusMomentum4, strongest), _mm_mul_ps(momentum4, current));
+			next = _mm_andnot_ps(_mm_cmplt_ps(_mm_andnot_ps(signMask, next), minInfluence4), next);
+			_mm_storeu_ps(pNextInfluences + i, next);
+			isChangedMask |= _mm_movemask_ps(_mm_cmpnle_ps(_mm_andnot_ps(signMask, _mm_sub_ps(next, current)), epsilon4));
+		}
+		isChanged = isChanged || isChangedMask != 0;
+#endif
+
+		for (; i < end; ++i)
+		{
+			float strongest = 0.f;
+			for (int n = 0; n < nrOfDirections; ++n)
+			{
+				const float influence = pNeighborInfluences[n][i] * pWeights[n][i];
+				if (IsStrongerInfluence(influence, strongest))
+					strongest = influence;
+			}
+			pNextInfluences[i] = FlushInfluence(Lerp(strongest, pInfluences[i], momentum));
+			isChanged = isChanged || !(fabsf(pNextInfluences[i] - pInfluences[i]) <= epsilon);
+		}
+	}
+	return isChanged;
+}
+
+//=== InfluenceStamper ===
+InfluenceStamper::~InfluenceStamper()
+{
+	ClearKernels();
+}
+
+void InfluenceStamper::ClearKernels()
+{
+	for (auto& kernel : m_pKernels)
+		SAFE_DELETE(kernel.second);
+	m_pKernels.clear();
+	m_pLastKernel = nullptr;
+}
+
+const InfluenceStamper::Kernel* InfluenceStamper::GetKernel(float radiusInCells, InfluenceFalloff falloff)
+{
+	uint32_t radiusBits;
+	memcpy(&radiusBits, &radiusInCells, sizeof(radiusBits));
+	const uint64_t key = (static_cast<uint64_t>(radiusBits) << 8) | static_cast<uint64_t>(falloff);
+
+	//Stamps of one kind of agent tend to follow each other
+	if (m_pLastKernel && key == m_LastKernelKey)
+		return m_pLastKernel;
+	m_LastKernelKey = key;
+
+	auto it = m_pKernels.find(key);
+	if (it != m_pKernels.end())
+	{
+		m_pLastKernel = it->second;
+		return m_pLastKernel;
+	}
+
+	Kernel* pKernel = new Kernel();
+	const int halfWidth = static_cast<int>(radiusInCells);
+	const int width = 2 * halfWidth + 1;
+	const float radiusSquared = radiusInCells * radiusInCells;
+	pKernel->halfWidth = halfWidth;
+	pKernel->rowHalfWidths.assign(width, 0);
+	pKernel->factors.assign(static_cast<size_t>(width) * width, 0.f);
+
+	for (int dy = -halfWidth; dy <= halfWidth; ++dy)
+	{
+		for (int dx = -halfWidth; dx <= halfWidth; ++dx)
+		{
+			const int distanceSquared = dx * dx + dy * dy;
+			if (static_cast<float>(distanceSquared) > radiusSquared)
+				continue;
+
+			const float relativeDistance = radiusInCells > 0.f ? sqrtf(static_cast<float>(distanceSquared)) / radiusInCells : 0.f;
+			pKernel->factors[(dy + halfWidth) * width + dx + halfWidth] = GetInfluenceFalloff(falloff, relativeDistance);
+			if (dx > pKernel->rowHalfWidths[dy + halfWidth])
+				pKernel->rowHalfWidths[dy + halfWidth] = dx;
+		}
+	}
+
+	m_pKernels[key] = pKernel;
+	m_pLastKernel = pKernel;
+	return pKernel;
+}
+
+void InfluenceStamper::Rasterize(const std::vector<InfluenceStamp>& stamps, int columns, int rows, float cellSize, WorkerPool* pWorkerPool)
+{
+	if (columns != m_NrOfColumns || rows != m_NrOfRows)
+	{
+		m_NrOfColumns = columns > 0 ? columns : 0;
+		m_NrOfRows = rows > 0 ? rows : 0;
+		m_Influences.assign(static_cast<size_t>(m_NrOfColumns) * m_NrOfRows, NAN);
+		m_BeginCoveredColumns.assign(m_NrOfRows, m_NrOfColumns);
+		m_EndCoveredColumns.assign(m_NrOfRows, 0);
+	}
+	if (m_NrOfColumns == 0 || m_NrOfRows == 0 || cellSize <= 0.f)
+		return;
+
+	//The kernels are looked up before the rows are split up, so the threads only read the cache
+	if (m_pKernels.size() > MAX_CACHED_KERNELS)
+		ClearKernels();
+	m_pStampKernels.resize(stamps.size());
+	for (size_t i = 0; i < stamps.size(); ++i)
+	{
+		const float radiusInCells = roundf(stamps[i].radius / cellSize * KERNEL_RADIUS_STEPS_PER_CELL) / KERNEL_RADIUS_STEPS_PER_CELL;
+		m_pStampKernels[i] = GetKernel(radiusInCells > 0.f ? radiusInCells : 0.f, stamps[i].falloff);
+	}
+
+	if (!pWorkerPool || pWorkerPool->GetNrOfThreads() <= 1 || static_cast<int>(stamps.size()) < MIN_STAMPS_FOR_THREADS)
+	{
+		RasterizeRows(stamps, cellSize, 0, m_NrOfRows);
+		return;
+	}
+
+	//Every band of rows only writes its own rows
+	pWorkerPool->SetMinChunkSize(MIN_STAMP_ROWS_PER_CHUNK);
+	pWorkerPool->ParallelFor(m_NrOfRows, [&](int begin, int end)
+	{
+		RasterizeRows(stamps, cellSize, begin, end);
+	});
+}
+
+void InfluenceStamper::RasterizeRows(const std::vector<InfluenceStamp>& stamps, float cellSize, int beginRow, int endRow)
+{
+	for (size_t i = 0; i < stamps.size(); ++i)
+	{
+		const InfluenceStamp& stamp = stamps[i];
+		const Kernel* pKernel = m_pStampKernels[i];
+		const int halfWidth = pKernel->halfWidth;
+		const int width = 2 * halfWidth + 1;
+		const int centerColumn = static_cast<int>(floorf(stamp.position.x / cellSize));
+		const int centerRow = static_cast<int>(floorf(stamp.position.y / cellSize));
+
+		const int firstRow = centerRow - halfWidth > beginRow ? centerRow - halfWidth : beginRow;
+		const int lastRow = centerRow + halfWidth + 1 < endRow ? centerRow + halfWidth + 1 : endRow;
+		for (int row = firstRow; row < lastRow; ++row)
+		{
+			const int kernelRow = row - centerRow + halfWidth;
+			const int rowHalfWidth = pKernel->rowHalfWidths[kernelRow];
+			const int beginColumn = centerColumn - rowHalfWidth > 0 ? centerColumn - rowHalfWidth : 0;
+			const int endColumn = centerColumn + rowHalfWidth + 1 < m_NrOfColumns ? centerColumn + rowHalfWidth + 1 : m_NrOfColumns;
+			if (beginColumn >= endColumn)
+				continue;
+
+			//Indexed by the column relative to the center
+			const float* pFactors = pKernel->factors.data() + kernelRow * width + halfWidth;
+			float* pInfluences = m_Influences.data() + static_cast<size_t>(row) * m_NrOfColumns;
+			//Cells that are not covered yet are NaN, which every influence is stronger than
+			const float stampInfluence = stamp.influence;
+			for (int col = beginColumn; col < endColumn; ++col)
+			{
+				const float influence = stampInfluence * pFactors[col - centerColumn];
+				const float current = pInfluences[col];
+				const float absInfluence = fabsf(influence);
+				const float absCurrent = fabsf(current);
+				pInfluences[col] = !(absCurrent >= absInfluence) | (absInfluence == absCurrent && influence > current) ? influence : current;
+			}
+
+			if (beginColumn < m_BeginCoveredColumns[row])
+				m_BeginCoveredColumns[row] = beginColumn;
+			if (endColumn > m_EndCoveredColumns[row])
+				m_EndCoveredColumns[row] = endColumn;
+		}
+	}
+}
@@ -2,9 +2,236 @@
 #include "EIGraph.h"
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
+#include "EGridGraph.h"
+#include <type_traits>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#if !defined(INFLUENCE_STENCIL_SCALAR) && (defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+	#define INFLUENCE_STENCIL_SSE
+#endif
 
 namespace Elite
 {
+	class WorkerPool;
+
+	// A node takes the neighbor influence with the largest magnitude, the positive one on a tie so the order of the connections does not matter
+	inline bool IsStrongerInfluence(float influence, float strongestInfluence)
+	{
+		const float absInfluence = fabsf(influence);
+		const float absStrongestInfluence = fabsf(strongestInfluence);
+		return absInfluence > absStrongestInfluence || (absInfluence == absStrongestInfluence && influence > strongestInfluence);
+	}
+
+	// Decaying influence ends at 0 instead of lingering as denormals, which are many times slower to compute with
+	inline float FlushInfluence(float influence)
+	{
+		return fabsf(influence) < FLT_MIN ? 0.f : influence;
+	}
+
+	//-----------------------------------------------------------------
+	// InfluenceGridPropagator: the influence of a grid graph as dense float arrays, propagated with a stencil sweep.
+	// The field has a border of empty cells so every cell can read its 8 neighbors without bounds checks.
+	// Every cell keeps a weight per direction, exp(-cost * decay) of its connection that way, 0 without one,
+	// so walls and connection costs propagate exactly like they do over the nodes.
+	// SSE is used when the compiler targets it (always on x64), define INFLUENCE_STENCIL_SCALAR to force the plain loop.
+	// Sparse propagation only sweeps the tiles of TileSize x TileSize cells that were set or still moved in the last
+	// propagation, and the tiles around them, so a mostly settled field costs what its active regions cost.
+	//-----------------------------------------------------------------
+	class InfluenceGridPropagator final
+	{
+	public:
+		InfluenceGridPropagator();
+		~InfluenceGridPropagator();
+
+		// Clears the influences and the weights
+		void Initialize(int columns, int rows);
+		// Keeps the influences, for when only the connections or the decay changed
+		void ClearWeights();
+		void SetWeight(int cellIdx, int deltaColumn, int deltaRow, float weight);
+
+		int GetNrOfColumns() const { return m_NrOfColumns; }
+		int GetNrOfRows() const { return m_NrOfRows; }
+
+		float GetInfluence(int cellIdx) const { return m_Influences[ToFieldIdx(cellIdx)]; }
+		void SetInfluence(int cellIdx, float influence);
+
+		// The field itself, row by row with the border: cell (col, row) is at ToFieldIdx(row * columns + col)
+		const float* GetField() const { return m_Influences.data(); }
+		int GetFieldWidth() const { return m_FieldWidth; }
+		int ToFieldIdx(int cellIdx) const { return (cellIdx / m_NrOfColumns + 1) * m_FieldWidth + cellIdx % m_NrOfColumns + 1; }
+
+		// Every cell takes the strongest decayed influence of its neighbors, blended with its own influence by the momentum
+		// Returns false when no cell changed, propagating again would then give the same field
+		bool Propagate(float momentum);
+
+		// A tile counts as changed when a cell in it moved more than epsilon, cells that move less keep their influence
+		// until a neighboring tile changes. With an epsilon of 0 the field is the same as when every cell is swept.
+		bool IsSparse() const { return m_IsSparse; }
+		void SetSparse(bool isSparse, float epsilon = 0.f);
+		// Tiles swept by the last sparse propagation, the other cells kept their influence
+		const std::vector<int>& GetSweptTiles() const { return m_SweptTiles; }
+		void GetTileBounds(int tileIdx, int& beginColumn, int& beginRow, int& endColumn, int& endRow) const;
+
+		// 1 sweeps on the calling thread, the worker threads are only started for large grids
+		int GetNrOfThreads() const { return m_NrOfThreads; }
+		void SetNrOfThreads(int nrOfThreads);
+		// Sweeps with the threads of a pool that is shared with other propagators, the pool is not owned
+		void SetWorkerPool(WorkerPool* pWorkerPool);
+		// The shared pool, or the own one which is created the first time it is needed
+		WorkerPool* GetWorkerPool();
+
+		enum { NrOfDirections = 8, TileSize = 8 };
+
+	private:
+
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		int m_FieldWidth = 0; // columns + border
+
+		std::vector<float> m_Influences;
+		std::vector<float> m_NextInfluences;
+		std::vector<float> m_Weights[NrOfDirections];
+		int m_Offsets[NrOfDirections]{};
+		bool m_IsDirectionUsed[NrOfDirections]{};
+
+		int m_NrOfThreads = 1;
+		WorkerPool* m_pWorkerPool = nullptr;
+		bool m_IsWorkerPoolOwned = false;
+
+		bool m_IsSparse = false;
+		float m_SparseEpsilon = 0.f;
+		float m_LastMomentum = 0.f;
+		int m_NrOfTileColumns = 0;
+		int m_NrOfTileRows = 0;
+		std::vector<char> m_IsTileChanged; // set, or moved more than epsilon in the last propagation
+		std::vector<char> m_IsTileSwept; // in the last propagation, the other buffer holds older influences for those
+		std::vector<char> m_IsTileToSweep;
+		std::vector<int> m_SweptTiles;
+
+		void MarkAllTilesChanged();
+		bool PropagateSparse(float momentum, const int* pDirections, int nrOfDirections);
+		// Returns whether a cell moved more than epsilon
+		bool SweepRows(int beginRow, int endRow, int beginColumn, int endColumn, float momentum, const int* pDirections, int nrOfDirections, float epsilon);
+
+		InfluenceGridPropagator(const InfluenceGridPropagator& other) = delete;
+		InfluenceGridPropagator& operator=(const InfluenceGridPropagator& other) = delete;
+	};
+
+	inline void InfluenceGridPropagator::SetInfluence(int cellIdx, float influence)
+	{
+		float& fieldInfluence = m_Influences[ToFieldIdx(cellIdx)];
+		if (fieldInfluence == influence)
+			return;
+
+		fieldInfluence = influence;
+		m_IsTileChanged[(cellIdx / m_NrOfColumns / TileSize) * m_NrOfTileColumns + cellIdx % m_NrOfColumns / TileSize] = true;
+	}
+
+	enum class InfluenceFalloff
+	{
+		Constant,	// the full influence up to the radius
+		Linear,		// 1 - distance / radius
+		Quadratic	// (1 - distance / radius)^2
+	};
+
+	// Factor of the influence at distance / radius, which is between 0 and 1
+	inline float GetInfluenceFalloff(InfluenceFalloff falloff, float relativeDistance)
+	{
+		const float factor = 1.f - relativeDistance;
+		switch (falloff)
+		{
+		case InfluenceFalloff::Linear:
+			return factor;
+		case InfluenceFalloff::Quadratic:
+			return factor * factor;
+		default:
+			return 1.f;
+		}
+	}
+
+	struct InfluenceStamp
+	{
+		Elite::Vector2 position;
+		float influence;
+		float radius;
+		InfluenceFalloff falloff;
+	};
+
+	//-----------------------------------------------------------------
+	// InfluenceStamper: rasterizes a batch of circular stamps straight into the cell indices of a grid.
+	// A stamp is centered on the cell under its position and covers the cells whose centers lie within its radius of that cell,
+	// with the falloff factors of a kernel that is cached per radius, rounded to 1/16th of a cell, and falloff.
+	// Where stamps overlap the strongest one wins, like in propagation, so the order of the stamps does not matter
+	// and large batches can be split in bands of rows over a worker pool.
+	//-----------------------------------------------------------------
+	class InfluenceStamper final
+	{
+	public:
+		InfluenceStamper() = default;
+		~InfluenceStamper();
+
+		// Calls setInfluence(cellIdx, influence) on the calling thread, once for every cell covered by a stamp.
+		// The grid starts at the origin. Without a worker pool, or for small batches, everything runs on the calling thread.
+		template<typename T_SetFunction>
+		void Stamp(const std::vector<InfluenceStamp>& stamps, int columns, int rows, float cellSize, T_SetFunction setInfluence, WorkerPool* pWorkerPool = nullptr);
+
+	private:
+		struct Kernel
+		{
+			int halfWidth;
+			std::vector<int> rowHalfWidths; // per row of the kernel, the cells on each side of the center inside the circle
+			std::vector<float> factors; // (2 * halfWidth + 1) x (2 * halfWidth + 1), row by row
+		};
+		std::unordered_map<uint64_t, Kernel*> m_pKernels;
+		uint64_t m_LastKernelKey = 0;
+		const Kernel* m_pLastKernel = nullptr;
+		std::vector<const Kernel*> m_pStampKernels; // of the batch being stamped
+
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		std::vector<float> m_Influences; // NaN where no stamp covers the cell
+		std::vector<int> m_BeginCoveredColumns; // per row
+		std::vector<int> m_EndCoveredColumns;
+
+		void Rasterize(const std::vector<InfluenceStamp>& stamps, int columns, int rows, float cellSize, WorkerPool* pWorkerPool);
+		void RasterizeRows(const std::vector<InfluenceStamp>& stamps, float cellSize, int beginRow, int endRow);
+		// radiusInCells has to be rounded already
+		const Kernel* GetKernel(float radiusInCells, InfluenceFalloff falloff);
+		void ClearKernels();
+
+		InfluenceStamper(const InfluenceStamper& other) = delete;
+		InfluenceStamper& operator=(const InfluenceStamper& other) = delete;
+	};
+
+	template<typename T_SetFunction>
+	void InfluenceStamper::Stamp(const std::vector<InfluenceStamp>& stamps, int columns, int rows, float cellSize, T_SetFunction setInfluence, WorkerPool* pWorkerPool)
+	{
+		Rasterize(stamps, columns, rows, cellSize, pWorkerPool);
+
+		for (int row = 0; row < m_NrOfRows; ++row)
+		{
+			for (int col = m_BeginCoveredColumns[row]; col < m_EndCoveredColumns[row]; ++col)
+			{
+				const int idx = row * m_NrOfColumns + col;
+				if (std::isnan(m_Influences[idx]))
+					continue;
+
+				setInfluence(idx, m_Influences[idx]);
+				m_Influences[idx] = NAN;
+			}
+			m_BeginCoveredColumns[row] = m_NrOfColumns;
+			m_EndCoveredColumns[row] = 0;
+		}
+	}
+
+	template<class T_GraphType>
+	struct IsGridGraph : std::false_type {};
+	template<class T_NodeType, class T_ConnectionType>
+	struct IsGridGraph<GridGraph<T_NodeType, T_ConnectionType>> : std::true_type {};
+
 	template<class T_GraphType>
 	class InfluenceMap final : public T_GraphType
 	{
@@ -15,6 +242,9 @@ namespace Elite
 
 		void SetInfluenceAtPosition(Elite::Vector2 pos, float influence);
 		void SetInfluenceAtPosition(Elite::Vector2 pos, float influence, float radius, int cellSize);
+		// Sets the influence of every node within the radius of a stamp, the strongest stamp where they overlap.
+		// Grid graphs rasterize the stamps with cached kernels, in parallel for large batches, see InfluenceStamper.
+		void StampInfluences(const std::vector<InfluenceStamp>& stamps);
 
 		void Render() const {}
 		void SetNodeColorsBasedOnInfluence();
@@ -23,13 +253,21 @@ namespace Elite
 		void SetMomentum(float momentum) { m_Momentum = momentum; }
 
 		float GetDecay() const { return m_Decay; }
-		void SetDecay(float decay) { m_Decay = decay; }
+		void SetDecay(float decay) { m_IsStencilValid = m_IsStencilValid && decay == m_Decay; m_Decay = decay; }
 
 		float GetPropagationInterval() const { return m_PropagationInterval; }
 		void SetPropagationInterval(float propagationInterval) { m_PropagationInterval = propagationInterval; }
 
 		float GetMaxAbsInfluence() const { return m_MaxAbsInfluence; }
 
+		// Grid graphs propagate over a dense field by default, which is written back to the nodes after every propagation.
+		// Influence set on the nodes directly is copied into the field before the next propagation, the nodes list those writes.
+		bool GetUseStencil() const { return m_UseStencil; }
+		void SetUseStencil(bool useStencil) { m_IsStencilValid = m_IsStencilValid && useStencil == m_UseStencil; m_UseStencil = useStencil; }
+		void SetNrOfStencilThreads(int nrOfThreads) { m_Stencil.SetNrOfThreads(nrOfThreads); }
+		// Only propagates the regions of a grid graph that were set or still move more than epsilon, see InfluenceGridPropagator
+		void SetSparsePropagation(bool isSparse, float epsilon = 0.f) { m_Stencil.SetSparse(isSparse, epsilon); }
+
 	protected:
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) override;
 
@@ -47,27 +285,128 @@ namespace Elite
 		float m_TimeSinceLastPropagation = 0.0f;
 
 		vector<float> m_InfluenceDoubleBuffer;
+
+		bool m_UseStencil = true;
+		bool m_IsStencilValid = false;
+		InfluenceGridPropagator m_Stencil;
+		std::vector<int> m_WrittenNodes; // nodes set directly since the last propagation, see InfluenceNode::SetWrittenNodes
+		InfluenceStamper m_Stamper;
+
+		void PropagateInfluence(std::false_type isGridGraph);
+		void PropagateInfluence(std::true_type isGridGraph);
+		void PropagateInfluenceOverNodes();
+		void StampInfluences(const std::vector<InfluenceStamp>& stamps, std::false_type isGridGraph);
+		void StampInfluences(const std::vector<InfluenceStamp>& stamps, std::true_type isGridGraph);
+		void BuildStencil();
+		void SetInfluence(int nodeIdx, float influence);
 	};
 
 	template <class T_GraphType>
 	void InfluenceMap<T_GraphType>::PropagateInfluence(float deltaTime)
 	{
+		ELITE_PROFILE_SCOPE("InfluenceMap::PropagateInfluence");
+		PropagateInfluence(IsGridGraph<T_GraphType>{});
+	}
+
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::PropagateInfluence(std::false_type)
+	{
+		PropagateInfluenceOverNodes();
+	}
+
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::PropagateInfluence(std::true_type)
+	{
+		if (!m_UseStencil)
+		{
+			PropagateInfluenceOverNodes();
+			return;
+		}
+
+		if (!m_IsStencilValid)
+			BuildStencil();
+		else
+		{
+			//Influence set through GetNode(idx)->SetInfluence instead of the influence map, the field does not know about it yet
+			for (int idx : m_WrittenNodes)
+			{
+				auto pNode = GetNode(idx);
+				m_Stencil.SetInfluence(idx, pNode->GetInfluence());
+				pNode->ClearWritten();
+			}
+			m_WrittenNodes.clear();
+		}
+		m_Stencil.Propagate(m_Momentum);
+
+		if (!m_Stencil.IsSparse())
+		{
+			for (auto pNode : m_Nodes)
+				pNode->SyncInfluence(m_Stencil.GetInfluence(pNode->GetIndex()));
+			return;
+		}
+
+		for (int tileIdx : m_Stencil.GetSweptTiles())
+		{
+			int beginColumn, beginRow, endColumn, endRow;
+			m_Stencil.GetTileBounds(tileIdx, beginColumn, beginRow, endColumn, endRow);
+			for (int row = beginRow; row < endRow; ++row)
+			{
+				for (int col = beginColumn; col < endColumn; ++col)
+				{
+					const int idx = GetIndex(col, row);
+					GetNode(idx)->SyncInfluence(m_Stencil.GetInfluence(idx));
+				}
+			}
+		}
+	}
 
-		// For some reason "newinfluence" keeps being 0 here, and I'm not sure why...
-		// TODO: Fix
+	template <class T_GraphType>
+	void InfluenceMap<T_GraphType>::PropagateInfluenceOverNodes()
+	{
 		for (auto pNode : m_Nodes) 
 		{
 			float newInfluence{ 0.0f };
 			for (auto pConnection : GetNodeConnections(pNode)) 
 			{
-				newInfluence = GetNode(pConnection->GetTo())->GetInfluence() * expf(-pConnection->GetCost() * m_Decay);
+				const float influence = GetNode(pConnection->GetTo())->GetInfluence() * expf(-pConnection->GetCost() * m_Decay);
+				if (IsStrongerInfluence(influence, newInfluence))
+					newInfluence = influence;
 			}
-			m_InfluenceDoubleBuffer[pNode->GetIndex()] = Lerp(pNode->GetInfluence(), newInfluence, m_Momentum);
+			m_InfluenceDoubleBuffer[pNode->GetIndex()] = FlushInfluence(Lerp(newInfluence, pNode->GetInfluence(), m_Momentum));
 		}
 
+		for (auto pNode : m_Nodes)
+			pNode->SyncInfluence(m_InfluenceDoubleBuffer[pNode->GetIndex()]);
+	}
 
+	template <class T_GraphType>
+	void InfluenceMap<T_GraphType>::BuildStencil()
+	{
+		const int nrOfColumns = GetColumns();
+		m_Stencil.Initialize(nrOfColumns, GetRows());
+
+		m_WrittenNodes.clear();
 		for (auto pNode : m_Nodes)
-			pNode->SetInfluence(m_InfluenceDoubleBuffer[pNode->GetIndex()]);
+		{
+			const int idx = pNode->GetIndex();
+			m_Stencil.SetInfluence(idx, pNode->GetInfluence());
+			pNode->SetWrittenNodes(&m_WrittenNodes);
+
+			for (auto pConnection : GetNodeConnections(pNode))
+			{
+				const int to = pConnection->GetTo();
+				m_Stencil.SetWeight(idx, to % nrOfColumns - idx % nrOfColumns, to / nrOfColumns - idx / nrOfColumns, expf(-pConnection->GetCost() * m_Decay));
+			}
+		}
+		m_IsStencilValid = true;
+	}
+
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::SetInfluence(int nodeIdx, float influence)
+	{
+		GetNode(nodeIdx)->SyncInfluence(influence);
+		if (m_IsStencilValid)
+			m_Stencil.SetInfluence(nodeIdx, influence);
 	}
 
 	template <class T_GraphType>
@@ -75,7 +414,7 @@ namespace Elite
 	{
 		auto idx = GetNodeIdxAtWorldPos(pos);
 		if (IsNodeValid(idx))
-			GetNode(idx)->SetInfluence(influence);
+			SetInfluence(idx, influence);
 	}
 
 	template<class T_GraphType>
@@ -92,14 +431,53 @@ namespace Elite
 			{
 				if (Elite::DistanceSquared(Vector2{ x, y }, pos) > radiusSquared) continue; //Cell out of radius
 
-				auto idx = GetNodeIdxAtWorldPos(pos);
+				auto idx = GetNodeIdxAtWorldPos(Vector2{ x, y });
 				if (!IsNodeValid(idx)) continue; //Inavlid index
 
-				GetNode(idx)->SetInfluence(influence);
+				SetInfluence(idx, influence);
 			}
 		}
 	}
 
+	template<class T_GraphType>
+	void InfluenceMap<T_GraphType>::StampInfluences(const std::vector<InfluenceStamp>& stamps)
+	{
+		ELITE_PROFILE_SCOPE("InfluenceMap::StampInfluences");
+		StampInfluences(stamps, IsGridGraph<T_GraphType>{});
+	}
+
+	template<class T_GraphType>
+	void InfluenceMap<T_GraphType>::StampInfluences(const std::vector<InfluenceStamp>& stamps, std::false_type)
+	{
+		for (auto pNode : m_Nodes)
+		{
+			const Vector2 nodePos = GetNodeWorldPos(pNode->GetIndex());
+			float strongestInfluence = 0.f;
+			bool isCovered = false;
+			for (const InfluenceStamp& stamp : stamps)
+			{
+				const float distance = Elite::Distance(nodePos, stamp.position);
+				if (distance > stamp.radius)
+					continue;
+
+				const float influence = stamp.influence * GetInfluenceFalloff(stamp.falloff, stamp.radius > 0.f ? distance / stamp.radius : 0.f);
+				if (!isCovered || IsStrongerInfluence(influence, strongestInfluence))
+					strongestInfluence = influence;
+				isCovered = true;
+			}
+
+			if (isCovered)
+				SetInfluence(pNode->GetIndex(), strongestInfluence);
+		}
+	}
+
+	template<class T_GraphType>
+	void InfluenceMap<T_GraphType>::StampInfluences(const std::vector<InfluenceStamp>& stamps, std::true_type)
+	{
+		WorkerPool* pWorkerPool = m_Stencil.GetNrOfThreads() > 1 ? m_Stencil.GetWorkerPool() : nullptr;
+		m_Stamper.Stamp(stamps, GetColumns(), GetRows(), float(GetCellSize()), [this](int idx, float influence) { SetInfluence(idx, influence); }, pWorkerPool);
+	}
+
 	template<class T_GraphType>
 	inline void InfluenceMap<T_GraphType>::SetNodeColorsBasedOnInfluence()
 	{
@@ -136,5 +514,6 @@ namespace Elite
 	inline void InfluenceMap<T_GraphType>::OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
 	{
 		InitializeBuffer();
+		m_IsStencilValid = false;
 	}
 }
\ No newline at end of file
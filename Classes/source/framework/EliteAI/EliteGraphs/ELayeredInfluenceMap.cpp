@@ -0,0 +1,36 @@
+#include "stdafx.h"
+#include "ELayeredInfluenceMap.h"
+
+#if defined(INFLUENCE_STENCIL_SSE)
+	#include <emmintrin.h>
+#endif
+
+using namespace Elite;
+
+void InfluenceLayerKernels::CombineRow(const float* const* ppInfluences, const float* pWeights, int nrOfTerms, int count, float* pResult)
+{
+	if (nrOfTerms == 0)
+	{
+		std::fill(pResult, pResult + count, 0.f);
+		return;
+	}
+
+	int i = 0;
+#if defined(INFLUENCE_STENCIL_SSE)
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(ppInfluences[0] + i), _mm_set1_ps(pWeights[0]));
+		for (int t = 1; t < nrOfTerms; ++t)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(ppInfluences[t] + i), _mm_set1_ps(pWeights[t])));
+		_mm_storeu_ps(pResult + i, sum);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		float sum = ppInfluences[0][i] * pWeights[0];
+		for (int t = 1; t < nrOfTerms; ++t)
+			sum += ppInfluences[t][i] * pWeights[t];
+		pResult[i] = sum;
+	}
+}
@@ -0,0 +1,398 @@
+/*=============================================================================*/
+// ELayeredInfluenceMap.h: several influence layers over one grid (threat, food, allies, ...), every layer propagated
+// at its own rate, and queries over a weighted sum of layers.
+/*=============================================================================*/
+#pragma once
+#include "EInfluenceMap.h"
+#include "framework\EliteHelpers\EWorkerPool.h"
+
+namespace Elite
+{
+	// One layer of a weighted sum: { threat, 2.f } and { food, -1.f } combine into threat * 2 - food
+	struct InfluenceLayerTerm
+	{
+		int layerIdx;
+		float weight;
+	};
+
+	namespace InfluenceLayerKernels
+	{
+		// pResult[i] = ppInfluences[0][i] * pWeights[0] + ppInfluences[1][i] * pWeights[1] + ..., 0 without terms
+		void CombineRow(const float* const* ppInfluences, const float* pWeights, int nrOfTerms, int count, float* pResult);
+	}
+
+	class InfluenceLayer final
+	{
+	public:
+		InfluenceLayer(float momentum, float decay, float propagationInterval)
+			: m_Momentum(momentum), m_Decay(decay), m_PropagationInterval(propagationInterval) {}
+
+		float GetMomentum() const { return m_Momentum; }
+		void SetMomentum(float momentum) { m_IsChanged = m_IsChanged || momentum != m_Momentum; m_Momentum = momentum; }
+
+		float GetDecay() const { return m_Decay; }
+		void SetDecay(float decay);
+
+		float GetPropagationInterval() const { return m_PropagationInterval; }
+		void SetPropagationInterval(float propagationInterval) { m_PropagationInterval = propagationInterval; }
+
+		// Only propagates the regions that were set or still move more than epsilon, see InfluenceGridPropagator
+		void SetSparsePropagation(bool isSparse, float epsilon = 0.f) { m_Stencil.SetSparse(isSparse, epsilon); m_IsChanged = true; }
+
+		// False while nothing was set on the layer and its last propagation left every cell as it was, updates skip it then
+		bool IsChanged() const { return m_IsChanged; }
+
+	private:
+		template<class T_GridGraphType> friend class LayeredInfluenceMap;
+
+		InfluenceGridPropagator m_Stencil;
+
+		float m_Momentum;
+		float m_Decay;
+		float m_PropagationInterval; //in Seconds
+		float m_TimeSinceLastPropagation = 0.f;
+
+		bool m_IsChanged = true;
+		bool m_AreWeightsValid = false;
+	};
+
+	inline void InfluenceLayer::SetDecay(float decay)
+	{
+		if (decay != m_Decay)
+		{
+			m_AreWeightsValid = false;
+			m_IsChanged = true;
+		}
+		m_Decay = decay;
+	}
+
+	template<class T_GridGraphType>
+	class LayeredInfluenceMap final : public T_GridGraphType
+	{
+	public:
+		LayeredInfluenceMap(bool isDirectional) : T_GridGraphType(isDirectional) {}
+		~LayeredInfluenceMap();
+
+		// Returns the index of the new layer
+		int AddLayer(float momentum = 0.3f, float decay = 0.5f, float propagationInterval = .05f);
+		int GetNrOfLayers() const { return int(m_pLayers.size()); }
+		InfluenceLayer* GetLayer(int layerIdx) const { return m_pLayers[layerIdx]; }
+
+		float GetInfluence(int layerIdx, int nodeIdx) const;
+		void SetInfluence(int layerIdx, int nodeIdx, float influence);
+		void SetInfluenceAtPosition(int layerIdx, const Elite::Vector2& pos, float influence);
+		// Sets the influence of the cells within the radius of a stamp, the strongest stamp where they overlap, see InfluenceStamper
+		void StampInfluences(int layerIdx, const std::vector<InfluenceStamp>& stamps);
+
+		// Propagates every layer whose interval has passed, unless it did not change since its last propagation
+		// Returns the number of layers that were propagated
+		int Update(float deltaTime);
+
+		// Weighted sum of the layers for every node, by node index
+		void Combine(const std::vector<InfluenceLayerTerm>& terms, std::vector<float>& influences) const;
+		float GetCombinedInfluence(const std::vector<InfluenceLayerTerm>& terms, int nodeIdx) const;
+
+		// Node with the largest weighted sum of the nodes centered within radius of pos, invalid_node_index when there are none
+		int FindMaxNodeInRadius(const std::vector<InfluenceLayerTerm>& terms, const Elite::Vector2& pos, float radius) const;
+		// Change of the weighted sum per world unit at pos, pointing to where it grows, zero outside of the grid
+		Elite::Vector2 GetGradientAtPosition(const std::vector<InfluenceLayerTerm>& terms, const Elite::Vector2& pos) const;
+
+	protected:
+		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) override;
+
+	private:
+		std::vector<InfluenceLayer*> m_pLayers;
+		WorkerPool* m_pWorkerPool = nullptr; // shared by the layers
+		InfluenceStamper m_Stamper;
+
+		WorkerPool* GetWorkerPool();
+
+		// Resizes the field of the layer to the grid, clearing the influences, when the grid was resized
+		void ResizeLayer(InfluenceLayer* pLayer);
+		// (Re)builds the weights of the layer from the connections, before anything is set or propagated
+		// The queries only read the fields, which always have the size of the grid, so they do not need the weights
+		void PrepareLayer(InfluenceLayer* pLayer);
+		// Start of the first row of every layer in the terms, in the layout of the fields
+		void GetTermFields(const std::vector<InfluenceLayerTerm>& terms, const float** ppFields, float* pWeights) const;
+		float GetCombinedInfluence(const float* const* ppFields, const float* pWeights, int nrOfTerms, int col, int row) const;
+
+		LayeredInfluenceMap(const LayeredInfluenceMap& other) = delete;
+		LayeredInfluenceMap& operator=(const LayeredInfluenceMap& other) = delete;
+	};
+
+	template<class T_GridGraphType>
+	LayeredInfluenceMap<T_GridGraphType>::~LayeredInfluenceMap()
+	{
+		for (InfluenceLayer* pLayer : m_pLayers)
+			SAFE_DELETE(pLayer);
+		SAFE_DELETE(m_pWorkerPool);
+	}
+
+	template<class T_GridGraphType>
+	int LayeredInfluenceMap<T_GridGraphType>::AddLayer(float momentum, float decay, float propagationInterval)
+	{
+		InfluenceLayer* pLayer = new InfluenceLayer(momentum, decay, propagationInterval);
+		pLayer->m_Stencil.SetNrOfThreads(1);
+		if (m_pWorkerPool)
+			pLayer->m_Stencil.SetWorkerPool(m_pWorkerPool);
+		ResizeLayer(pLayer);
+
+		m_pLayers.push_back(pLayer);
+		return int(m_pLayers.size()) - 1;
+	}
+
+	template<class T_GridGraphType>
+	inline float LayeredInfluenceMap<T_GridGraphType>::GetInfluence(int layerIdx, int nodeIdx) const
+	{
+		return m_pLayers[layerIdx]->m_Stencil.GetInfluence(nodeIdx);
+	}
+
+	template<class T_GridGraphType>
+	inline void LayeredInfluenceMap<T_GridGraphType>::SetInfluence(int layerIdx, int nodeIdx, float influence)
+	{
+		InfluenceLayer* pLayer = m_pLayers[layerIdx];
+		PrepareLayer(pLayer);
+		pLayer->m_Stencil.SetInfluence(nodeIdx, influence);
+		pLayer->m_IsChanged = true;
+	}
+
+	template<class T_GridGraphType>
+	inline void LayeredInfluenceMap<T_GridGraphType>::SetInfluenceAtPosition(int layerIdx, const Elite::Vector2& pos, float influence)
+	{
+		auto idx = GetNodeIdxAtWorldPos(pos);
+		if (IsNodeValid(idx))
+			SetInfluence(layerIdx, idx, influence);
+	}
+
+	template<class T_GridGraphType>
+	void LayeredInfluenceMap<T_GridGraphType>::StampInfluences(int layerIdx, const std::vector<InfluenceStamp>& stamps)
+	{
+		ELITE_PROFILE_SCOPE("LayeredInfluenceMap::StampInfluences");
+
+		InfluenceLayer* pLayer = m_pLayers[layerIdx];
+		PrepareLayer(pLayer);
+		InfluenceGridPropagator& stencil = pLayer->m_Stencil;
+		m_Stamper.Stamp(stamps, GetColumns(), GetRows(), float(GetCellSize()), [&stencil](int idx, float influence) { stencil.SetInfluence(idx, influence); }, GetWorkerPool());
+		pLayer->m_IsChanged = true;
+	}
+
+	template<class T_GridGraphType>
+	WorkerPool* LayeredInfluenceMap<T_GridGraphType>::GetWorkerPool()
+	{
+		if (!m_pWorkerPool)
+		{
+			m_pWorkerPool = new WorkerPool();
+			for (InfluenceLayer* pLayer : m_pLayers)
+				pLayer->m_Stencil.SetWorkerPool(m_pWorkerPool);
+		}
+		return m_pWorkerPool;
+	}
+
+	template<class T_GridGraphType>
+	int LayeredInfluenceMap<T_GridGraphType>::Update(float deltaTime)
+	{
+		ELITE_PROFILE_SCOPE("LayeredInfluenceMap::Update");
+
+		GetWorkerPool();
+
+		int nrOfPropagatedLayers = 0;
+		for (InfluenceLayer* pLayer : m_pLayers)
+		{
+			pLayer->m_TimeSinceLastPropagation += deltaTime;
+			if (pLayer->m_TimeSinceLastPropagation < pLayer->m_PropagationInterval)
+				continue;
+			pLayer->m_TimeSinceLastPropagation = 0.f;
+
+			//Propagating a field that did not change in the last propagation gives the same field again
+			if (!pLayer->m_IsChanged)
+				continue;
+
+			PrepareLayer(pLayer);
+			pLayer->m_IsChanged = pLayer->m_Stencil.Propagate(pLayer->m_Momentum);
+			++nrOfPropagatedLayers;
+		}
+		return nrOfPropagatedLayers;
+	}
+
+	template<class T_GridGraphType>
+	void LayeredInfluenceMap<T_GridGraphType>::Combine(const std::vector<InfluenceLayerTerm>& terms, std::vector<float>& influences) const
+	{
+		const int nrOfColumns = GetColumns();
+		const int nrOfTerms = int(terms.size());
+		std::vector<const float*> pFields(nrOfTerms);
+		std::vector<float> weights(nrOfTerms);
+		GetTermFields(terms, pFields.data(), weights.data());
+
+		influences.resize(nrOfColumns * GetRows());
+		const int fieldWidth = nrOfColumns + 2;
+		for (int row = 0; row < GetRows(); ++row)
+		{
+			InfluenceLayerKernels::CombineRow(pFields.data(), weights.data(), nrOfTerms, nrOfColumns, influences.data() + row * nrOfColumns);
+			for (const float*& pField : pFields)
+				pField += fieldWidth;
+		}
+	}
+
+	template<class T_GridGraphType>
+	inline float LayeredInfluenceMap<T_GridGraphType>::GetCombinedInfluence(const std::vector<InfluenceLayerTerm>& terms, int nodeIdx) const
+	{
+		const int nrOfTerms = int(terms.size());
+		std::vector<const float*> pFields(nrOfTerms);
+		std::vector<float> weights(nrOfTerms);
+		GetTermFields(terms, pFields.data(), weights.data());
+		return GetCombinedInfluence(pFields.data(), weights.data(), nrOfTerms, nodeIdx % GetColumns(), nodeIdx / GetColumns());
+	}
+
+	template<class T_GridGraphType>
+	int LayeredInfluenceMap<T_GridGraphType>::FindMaxNodeInRadius(const std::vector<InfluenceLayerTerm>& terms, const Elite::Vector2& pos, float radius) const
+	{
+		const int nrOfTerms = int(terms.size());
+		std::vector<const float*> pFields(nrOfTerms);
+		std::vector<float> weights(nrOfTerms);
+		GetTermFields(terms, pFields.data(), weights.data());
+
+		//Rows and then the columns of every row with their center in the circle
+		const float cellSize = float(GetCellSize());
+		const int fieldWidth = GetColumns() + 2;
+		int firstRow = int(ceilf((pos.y - radius) / cellSize - 0.5f));
+		int lastRow = int(floorf((pos.y + radius) / cellSize - 0.5f));
+		firstRow = firstRow < 0 ? 0 : firstRow;
+		lastRow = lastRow >= GetRows() ? GetRows() - 1 : lastRow;
+
+		int maxIdx = invalid_node_index;
+		float maxInfluence = 0.f;
+		const int chunkSize = 64;
+		float influences[chunkSize];
+		std::vector<const float*> pRows(nrOfTerms);
+		for (int row = firstRow; row <= lastRow; ++row)
+		{
+			const float deltaY = (row + 0.5f) * cellSize - pos.y;
+			const float halfWidthSquared = radius * radius - deltaY * deltaY;
+			if (halfWidthSquared < 0.f)
+				continue;
+			const float halfWidth = sqrtf(halfWidthSquared);
+			int firstColumn = int(ceilf((pos.x - halfWidth) / cellSize - 0.5f));
+			int lastColumn = int(floorf((pos.x + halfWidth) / cellSize - 0.5f));
+			firstColumn = firstColumn < 0 ? 0 : firstColumn;
+			lastColumn = lastColumn >= GetColumns() ? GetColumns() - 1 : lastColumn;
+
+			for (int col = firstColumn; col <= lastColumn; col += chunkSize)
+			{
+				const int count = lastColumn - col + 1 < chunkSize ? lastColumn - col + 1 : chunkSize;
+				for (int t = 0; t < nrOfTerms; ++t)
+					pRows[t] = pFields[t] + row * fieldWidth + col;
+				InfluenceLayerKernels::CombineRow(pRows.data(), weights.data(), nrOfTerms, count, influences);
+
+				for (int i = 0; i < count; ++i)
+				{
+					if (maxIdx == invalid_node_index || influences[i] > maxInfluence)
+					{
+						maxIdx = GetIndex(col + i, row);
+						maxInfluence = influences[i];
+					}
+				}
+			}
+		}
+		return maxIdx;
+	}
+
+	template<class T_GridGraphType>
+	Elite::Vector2 LayeredInfluenceMap<T_GridGraphType>::GetGradientAtPosition(const std::vector<InfluenceLayerTerm>& terms, const Elite::Vector2& pos) const
+	{
+		const int idx = GetNodeIdxAtWorldPos(pos);
+		if (!IsNodeValid(idx))
+			return Elite::Vector2{};
+
+		const int nrOfTerms = int(terms.size());
+		std::vector<const float*> pFields(nrOfTerms);
+		std::vector<float> weights(nrOfTerms);
+		GetTermFields(terms, pFields.data(), weights.data());
+
+		//Central differences, one sided on the edges of the grid
+		const int col = idx % GetColumns();
+		const int row = idx / GetColumns();
+		const int left = col > 0 ? col - 1 : col;
+		const int right = col < GetColumns() - 1 ? col + 1 : col;
+		const int bottom = row > 0 ? row - 1 : row;
+		const int top = row < GetRows() - 1 ? row + 1 : row;
+
+		const float cellSize = float(GetCellSize());
+		Elite::Vector2 gradient{};
+		if (right > left)
+			gradient.x = (GetCombinedInfluence(pFields.data(), weights.data(), nrOfTerms, right, row)
+				- GetCombinedInfluence(pFields.data(), weights.data(), nrOfTerms, left, row)) / ((right - left) * cellSize);
+		if (top > bottom)
+			gradient.y = (GetCombinedInfluence(pFields.data(), weights.data(), nrOfTerms, col, top)
+				- GetCombinedInfluence(pFields.data(), weights.data(), nrOfTerms, col, bottom)) / ((top - bottom) * cellSize);
+		return gradient;
+	}
+
+	template<class T_GridGraphType>
+	inline void LayeredInfluenceMap<T_GridGraphType>::OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+	{
+		//Only the weights are rebuilt lazily, a connection change costs nothing until the next set or propagation
+		for (InfluenceLayer* pLayer : m_pLayers)
+		{
+			if (nrOfNodesChanged)
+				ResizeLayer(pLayer);
+			pLayer->m_AreWeightsValid = false;
+			pLayer->m_IsChanged = true;
+		}
+	}
+
+	template<class T_GridGraphType>
+	void LayeredInfluenceMap<T_GridGraphType>::ResizeLayer(InfluenceLayer* pLayer)
+	{
+		InfluenceGridPropagator& stencil = pLayer->m_Stencil;
+		if (stencil.GetNrOfColumns() != GetColumns() || stencil.GetNrOfRows() != GetRows())
+		{
+			stencil.Initialize(GetColumns(), GetRows());
+			pLayer->m_AreWeightsValid = false;
+		}
+	}
+
+	template<class T_GridGraphType>
+	void LayeredInfluenceMap<T_GridGraphType>::PrepareLayer(InfluenceLayer* pLayer)
+	{
+		if (pLayer->m_AreWeightsValid)
+			return;
+
+		const int nrOfColumns = GetColumns();
+		InfluenceGridPropagator& stencil = pLayer->m_Stencil;
+		ResizeLayer(pLayer);
+		stencil.ClearWeights();
+
+		for (auto pNode : m_Nodes)
+		{
+			const int idx = pNode->GetIndex();
+			for (auto pConnection : GetNodeConnections(pNode))
+			{
+				const int to = pConnection->GetTo();
+				stencil.SetWeight(idx, to % nrOfColumns - idx % nrOfColumns, to / nrOfColumns - idx / nrOfColumns, expf(-pConnection->GetCost() * pLayer->m_Decay));
+			}
+		}
+		pLayer->m_AreWeightsValid = true;
+	}
+
+	template<class T_GridGraphType>
+	void LayeredInfluenceMap<T_GridGraphType>::GetTermFields(const std::vector<InfluenceLayerTerm>& terms, const float** ppFields, float* pWeights) const
+	{
+		for (size_t t = 0; t < terms.size(); ++t)
+		{
+			const InfluenceLayer* pLayer = m_pLayers[terms[t].layerIdx];
+			ppFields[t] = pLayer->m_Stencil.GetField() + pLayer->m_Stencil.ToFieldIdx(0);
+			pWeights[t] = terms[t].weight;
+		}
+	}
+
+	template<class T_GridGraphType>
+	inline float LayeredInfluenceMap<T_GridGraphType>::GetCombinedInfluence(const float* const* ppFields, const float* pWeights, int nrOfTerms, int col, int row) const
+	{
+		//Summed in the same order as CombineRow
+		const int fieldIdx = row * (GetColumns() + 2) + col;
+		float influence = nrOfTerms > 0 ? ppFields[0][fieldIdx] * pWeights[0] : 0.f;
+		for (int t = 1; t < nrOfTerms; ++t)
+			influence += ppFields[t][fieldIdx] * pWeights[t];
+		return influence;
+	}
+}
@@ -2,20 +2,223 @@
 #include "ENavGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
 
+#include <cfloat>
+#include <set>
+
 using namespace Elite;
 
+namespace
+{
+	using PointKey = std::pair<float, float>;
+	PointKey GetPointKey(const Vector2& p) { return { p.x, p.y }; }
+
+	double GetSignedArea(const std::vector<Vector2>& points)
+	{
+		double area{};
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			const Vector2& a = points[i];
+			const Vector2& b = points[(i + 1) % points.size()];
+			area += (double)a.x * b.y - (double)b.x * a.y;
+		}
+		return area / 2.0;
+	}
+
+	bool IsPointInRing(const Vector2& p, const std::vector<Vector2>& ring)
+	{
+		bool isInside{ false };
+		for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+		{
+			if ((ring[i].y > p.y) != (ring[j].y > p.y) &&
+				p.x < (ring[j].x - ring[i].x) * (p.y - ring[i].y) / (ring[j].y - ring[i].y) + ring[i].x)
+				isInside = !isInside;
+		}
+		return isInside;
+	}
+
+	// Sutherland-Hodgman clip against the tile rectangle, points on the border get the exact border coordinate
+	std::vector<Vector2> ClipToRect(const std::vector<Vector2>& points, const Vector2& min, const Vector2& max)
+	{
+		std::vector<Vector2> result{ points };
+		// 0: x >= min.x, 1: x <= max.x, 2: y >= min.y, 3: y <= max.y
+		for (int border = 0; border < 4 && !result.empty(); ++border)
+		{
+			const bool isVertical{ border < 2 };
+			const float value{ border == 0 ? min.x : border == 1 ? max.x : border == 2 ? min.y : max.y };
+			auto getCoordinate = [isVertical](const Vector2& p) { return isVertical ? p.x : p.y; };
+			auto isInside = [&](const Vector2& p) { return (border % 2 == 0) ? getCoordinate(p) >= value : getCoordinate(p) <= value; };
+			auto intersect = [&](Vector2 a, Vector2 b)
+			{
+				if (getCoordinate(a) == value) return a;
+				if (getCoordinate(b) == value) return b;
+				//Same segment gives the same point, no matter which tile clips it
+				if (b.x < a.x || (b.x == a.x && b.y < a.y))
+					std::swap(a, b);
+				const float t{ (value - getCoordinate(a)) / (getCoordinate(b) - getCoordinate(a)) };
+				return isVertical ? Vector2{ value, a.y + t * (b.y - a.y) } : Vector2{ a.x + t * (b.x - a.x), value };
+			};
+
+			std::vector<Vector2> input{};
+			input.swap(result);
+			for (size_t i = 0; i < input.size(); ++i)
+			{
+				const Vector2& previous = input[(i + input.size() - 1) % input.size()];
+				const Vector2& current = input[i];
+				if (isInside(current))
+				{
+					if (!isInside(previous))
+						result.push_back(intersect(previous, current));
+					result.push_back(current);
+				}
+				else if (isInside(previous))
+				{
+					result.push_back(intersect(previous, current));
+				}
+			}
+		}
+
+		//Remove the duplicates of points that were already on the border
+		std::vector<Vector2> cleaned{};
+		for (const Vector2& p : result)
+		{
+			if (cleaned.empty() || !(cleaned.back() == p))
+				cleaned.push_back(p);
+		}
+		while (cleaned.size() > 1 && cleaned.front() == cleaned.back())
+			cleaned.pop_back();
+		return cleaned;
+	}
+
+	// Edges around the union of counterclockwise polygons: counterclockwise around the covered area, clockwise around
+	// the free pockets it encloses. Edges are split where the polygons cross or touch, so pieces share their end points exactly.
+	std::vector<std::pair<Vector2, Vector2>> GetUnionEdges(const std::vector<std::vector<Vector2>>& polygons)
+	{
+		struct Edge
+		{
+			Vector2 a;
+			Vector2 b;
+			int polygonIdx;
+			std::vector<std::pair<float, Vector2>> splits; // position along the edge + point
+		};
+		std::vector<Edge> edges{};
+		for (size_t p = 0; p < polygons.size(); ++p)
+		{
+			for (size_t i = 0; i < polygons[p].size(); ++i)
+				edges.push_back({ polygons[p][i], polygons[p][(i + 1) % polygons[p].size()], (int)p, {} });
+		}
+
+		//1. Split the edges where a corner of another polygon lies on them, or else where they cross an edge of another polygon.
+		//A corner on the edge is the exact point where the polygons meet, a crossing computed there can be off by a bit
+		auto splitAtPoint = [](Edge& edge, const Vector2& point)
+		{
+			const Vector2 direction{ edge.b - edge.a };
+			const float lengthSquared{ direction.MagnitudeSquared() };
+			const float t{ Dot(point - edge.a, direction) / lengthSquared };
+			if (t < -1e-5f || t > 1.f + 1e-5f || fabsf(Cross(direction, point - edge.a)) > 1e-5f * lengthSquared)
+				return false;
+			if (t > 0.f && t < 1.f)
+				edge.splits.push_back({ t, point });
+			return true;
+		};
+		for (size_t i = 0; i < edges.size(); ++i)
+		{
+			for (size_t j = i + 1; j < edges.size(); ++j)
+			{
+				Edge& edge = edges[i];
+				Edge& other = edges[j];
+				if (edge.polygonIdx == other.polygonIdx
+					|| (edge.a.x < other.a.x && edge.a.x < other.b.x && edge.b.x < other.a.x && edge.b.x < other.b.x)
+					|| (edge.a.x > other.a.x && edge.a.x > other.b.x && edge.b.x > other.a.x && edge.b.x > other.b.x)
+					|| (edge.a.y < other.a.y && edge.a.y < other.b.y && edge.b.y < other.a.y && edge.b.y < other.b.y)
+					|| (edge.a.y > other.a.y && edge.a.y > other.b.y && edge.b.y > other.a.y && edge.b.y > other.b.y))
+					continue;
+
+				bool isTouching{ splitAtPoint(edge, other.a) };
+				isTouching = splitAtPoint(edge, other.b) || isTouching;
+				isTouching = splitAtPoint(other, edge.a) || isTouching;
+				isTouching = splitAtPoint(other, edge.b) || isTouching;
+				if (isTouching)
+					continue;
+
+				const Vector2 r{ edge.b - edge.a };
+				const Vector2 s{ other.b - other.a };
+				const float denominator{ Cross(r, s) };
+				if (denominator == 0.f)
+					continue;
+
+				const float t{ Cross(other.a - edge.a, s) / denominator };
+				const float u{ Cross(other.a - edge.a, r) / denominator };
+				if (t > 0.f && t < 1.f && u > 0.f && u < 1.f)
+				{
+					const Vector2 crossing{ edge.a + r * t };
+					edge.splits.push_back({ t, crossing });
+					other.splits.push_back({ u, crossing });
+				}
+			}
+		}
+
+		struct Piece
+		{
+			Vector2 a;
+			Vector2 b;
+			int polygonIdx;
+		};
+		std::vector<Piece> pieces{};
+		std::map<std::pair<PointKey, PointKey>, std::vector<int>> polygonsOfPiece{};
+		for (Edge& edge : edges)
+		{
+			std::sort(edge.splits.begin(), edge.splits.end(), [](const std::pair<float, Vector2>& a, const std::pair<float, Vector2>& b) { return a.first < b.first; });
+			Vector2 start{ edge.a };
+			edge.splits.push_back({ 1.f, edge.b });
+			for (const auto& split : edge.splits)
+			{
+				if (split.second == start)
+					continue;
+				pieces.push_back({ start, split.second, edge.polygonIdx });
+				polygonsOfPiece[{ GetPointKey(start), GetPointKey(split.second) }].push_back(edge.polygonIdx);
+				start = split.second;
+			}
+		}
+
+		//2. Keep the pieces with free area on their right: not inside another polygon, not shared with one
+		std::vector<std::pair<Vector2, Vector2>> unionEdges{};
+		for (const Piece& piece : pieces)
+		{
+			//The same piece the other way around lies between two polygons, the same piece the same way is kept once
+			const auto reversed = polygonsOfPiece.find({ GetPointKey(piece.b), GetPointKey(piece.a) });
+			if (reversed != polygonsOfPiece.end() && (reversed->second.size() > 1 || reversed->second[0] != piece.polygonIdx))
+				continue;
+			const std::vector<int>& sharingPolygons = polygonsOfPiece[{ GetPointKey(piece.a), GetPointKey(piece.b) }];
+			if (sharingPolygons[0] != piece.polygonIdx)
+				continue;
+
+			//A piece on the border of the polygons sharing it is not inside them
+			const Vector2 middle{ (piece.a + piece.b) / 2.f };
+			bool isInside{ false };
+			for (size_t p = 0; p < polygons.size() && !isInside; ++p)
+				isInside = std::find(sharingPolygons.begin(), sharingPolygons.end(), (int)p) == sharingPolygons.end() && IsPointInRing(middle, polygons[p]);
+			if (!isInside)
+				unionEdges.push_back({ piece.a, piece.b });
+		}
+		return unionEdges;
+	}
+}
+
 Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f) :
+	//Get all shapes from all static rigidbodies with NavigationCollider flag
+	NavGraph(contourMesh, PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider), playerRadius)
+{
+}
+
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, const std::vector<Polygon>& obstacles, float playerRadius) :
 	Graph2D(false),
 	m_pNavMeshPolygon(nullptr)
 {
 	//Create the navigation mesh (polygon of navigatable area= Contour - Static Shapes)
 	m_pNavMeshPolygon = new Polygon(contourMesh); // Create copy on heap
 
-	//Get all shapes from all static rigidbodies with NavigationCollider flag
-	auto vShapes = PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider);
-
 	//Store all children
-	for (auto shape : vShapes)
+	for (auto shape : obstacles)
 	{
 		shape.ExpandShape(playerRadius);
 		m_pNavMeshPolygon->AddChild(shape);
@@ -28,21 +231,39 @@ Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f)
 	CreateNavigationGraph();
 }
 
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius, float tileSize) :
+	NavGraph(contourMesh, PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider), playerRadius, tileSize)
+{
+}
+
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, const std::vector<Polygon>& obstacles, float playerRadius, float tileSize) :
+	Graph2D(false),
+	m_pNavMeshPolygon(nullptr),
+	m_TileSize(tileSize),
+	m_PlayerRadius(playerRadius)
+{
+	assert(tileSize > 0.f && "<NavGraph>: tile size has to be positive");
+	InitializeTiles(contourMesh, obstacles);
+}
+
 Elite::NavGraph::~NavGraph()
 {
-	delete m_pNavMeshPolygon; 
+	delete m_pNavMeshPolygon;
 	m_pNavMeshPolygon = nullptr;
+
+	for (NavMeshTile& tile : m_Tiles)
+	{
+		for (Polygon* pRegion : tile.regions)
+			SAFE_DELETE(pRegion);
+	}
 }
 
 int Elite::NavGraph::GetNodeIdxFromLineIdx(int lineIdx) const
 {
-	auto nodeIt = std::find_if(m_Nodes.begin(), m_Nodes.end(), [lineIdx](const NavGraphNode* n) { return n->GetLineIndex() == lineIdx; });
-	if (nodeIt != m_Nodes.end())
-	{
-		return (*nodeIt)->GetIndex();
-	}
+	if (lineIdx < 0 || lineIdx >= (int)m_LineToNodeIdx.size())
+		return invalid_node_index;
 
-	return invalid_node_index;
+	return m_LineToNodeIdx[lineIdx];
 }
 
 Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
@@ -50,10 +271,100 @@ Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
 	return m_pNavMeshPolygon;
 }
 
+std::vector<Polygon*> Elite::NavGraph::GetNavMeshPolygons() const
+{
+	if (!IsTiled())
+		return { m_pNavMeshPolygon };
+
+	std::vector<Polygon*> polygons{};
+	for (const NavMeshTile& tile : m_Tiles)
+		polygons.insert(polygons.end(), tile.regions.begin(), tile.regions.end());
+	return polygons;
+}
+
+const Triangle* Elite::NavGraph::GetTriangleFromPosition(const Vector2& position, std::array<int, 3>& lineNodeIndices) const
+{
+	lineNodeIndices.fill(invalid_node_index);
+
+	if (!IsTiled())
+	{
+		const Triangle* pTriangle = m_pNavMeshPolygon->GetTriangleFromPosition(position);
+		if (pTriangle)
+		{
+			for (size_t i = 0; i < 3; ++i)
+				lineNodeIndices[i] = GetNodeIdxFromLineIdx(pTriangle->metaData.IndexLines[i]);
+		}
+		return pTriangle;
+	}
+
+	const int tileIdx{ GetTileFromPosition(position) };
+	if (tileIdx == -1)
+		return nullptr;
+
+	//Positions on the border of a tile are only found when lines are allowed
+	const NavMeshTile& tile = m_Tiles[tileIdx];
+	for (bool onLineAllowed : { false, true })
+	{
+		for (size_t r = 0; r < tile.regions.size(); ++r)
+		{
+			const Triangle* pTriangle = tile.regions[r]->GetTriangleFromPosition(position, onLineAllowed);
+			if (!pTriangle)
+				continue;
+
+			for (size_t i = 0; i < 3; ++i)
+				lineNodeIndices[i] = tile.lineToNodeIdx[r][pTriangle->metaData.IndexLines[i]];
+			return pTriangle;
+		}
+	}
+	return nullptr;
+}
+
+const std::vector<Line*>& Elite::NavGraph::GetLines() const
+{
+	return IsTiled() ? m_NodeLines : m_pNavMeshPolygon->GetLines();
+}
+
+int Elite::NavGraph::AddObstacle(const Polygon& obstacle)
+{
+	if (!IsTiled())
+		return -1;
+
+	//Overlapping obstacles are merged per tile, so only the tiles under the new obstacle change
+	const int obstacleId{ AddObstacleToTiles(obstacle) };
+	std::vector<int> tiles{};
+	GetOverlappingTiles(m_Obstacles[obstacleId].min, m_Obstacles[obstacleId].max, tiles);
+	RebuildTiles(tiles);
+	return obstacleId;
+}
+
+void Elite::NavGraph::RemoveObstacle(int obstacleId)
+{
+	if (!IsTiled() || obstacleId < 0 || obstacleId >= (int)m_Obstacles.size() || !m_Obstacles[obstacleId].isActive)
+		return;
+
+	NavMeshObstacle& obstacle = m_Obstacles[obstacleId];
+	obstacle.isActive = false;
+
+	std::vector<int> tiles{};
+	GetOverlappingTiles(obstacle.min, obstacle.max, tiles);
+	for (int tileIdx : tiles)
+	{
+		auto& ids = m_Tiles[tileIdx].obstacleIds;
+		ids.erase(std::remove(ids.begin(), ids.end(), obstacleId), ids.end());
+	}
+	RebuildTiles(tiles);
+}
+
+int Elite::NavGraph::GetNrOfObstacles() const
+{
+	return (int)std::count_if(m_Obstacles.begin(), m_Obstacles.end(), [](const NavMeshObstacle& obstacle) { return obstacle.isActive; });
+}
+
 void Elite::NavGraph::CreateNavigationGraph()
 {
 	//1. Go over all the edges of the navigationmesh and create nodes
-	for (Elite::Line* pLine : m_pNavMeshPolygon->GetLines()) 
+	m_LineToNodeIdx.assign(m_pNavMeshPolygon->GetLines().size(), invalid_node_index);
+	for (Elite::Line* pLine : m_pNavMeshPolygon->GetLines())
 	{
 		if (m_pNavMeshPolygon->GetTrianglesFromLineIndex(pLine->index).size() == 1)
 			continue;
@@ -62,37 +373,504 @@ void Elite::NavGraph::CreateNavigationGraph()
 		float yAverage{ (pLine->p1.y + pLine->p2.y) / 2.f };
 		NavGraphNode* pNode = new NavGraphNode{ GetNextFreeNodeIndex() , pLine->index, Vector2{xAverage, yAverage} };
 		AddNode(pNode);
+		m_LineToNodeIdx[pLine->index] = pNode->GetIndex();
 	}
 
-	//2. Create connections now that every node is created
+	//2. Create connections now that every node is created: connect the nodes on the lines of every triangle
+	for (Elite::Triangle* pTriangle : m_pNavMeshPolygon->GetTriangles())
+	{
+		std::array<int, 3> foundNodes{};
+		int nrOfFoundNodes{ 0 };
+		for (int lineIdx : pTriangle->metaData.IndexLines)
+		{
+			const int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+			if (nodeIdx != invalid_node_index)
+				foundNodes[nrOfFoundNodes++] = nodeIdx;
+		}
 
+		auto connect = [this](int from, int to)
+		{
+			if (IsUniqueConnection(from, to))
+				AddConnection(new GraphConnection2D{ from, to });
+		};
+		if (nrOfFoundNodes == 2)
+		{
+			connect(foundNodes[0], foundNodes[1]);
+		}
+		else if (nrOfFoundNodes == 3)
+		{
+			connect(foundNodes[0], foundNodes[1]);
+			connect(foundNodes[1], foundNodes[2]);
+			connect(foundNodes[2], foundNodes[0]);
+		}
+	}
 
-	for (Elite::Triangle* pTriangle : m_pNavMeshPolygon->GetTriangles())
+	//3. Set the connections cost to the actual distance
+	SetConnectionCostsToDistance();
+
+}
+
+#pragma region TiledNavMesh
+void Elite::NavGraph::InitializeTiles(const Polygon& contourMesh, const std::vector<Polygon>& obstacles)
+{
+	//1. Divide the bounding box of the contour in tiles, the last row/column absorbs the remainder
+	const Vector2 min{ contourMesh.GetPosVertMinXPos(), contourMesh.GetPosVertMinYPos() };
+	const Vector2 max{ contourMesh.GetPosVertMaxXPos(), contourMesh.GetPosVertMaxYPos() };
+	m_NrOfTileColumns = static_cast<int>(ceilf((max.x - min.x) / m_TileSize - 0.01f));
+	m_NrOfTileRows = static_cast<int>(ceilf((max.y - min.y) / m_TileSize - 0.01f));
+	m_NrOfTileColumns = m_NrOfTileColumns < 1 ? 1 : m_NrOfTileColumns;
+	m_NrOfTileRows = m_NrOfTileRows < 1 ? 1 : m_NrOfTileRows;
+
+	m_TileBordersX.resize(m_NrOfTileColumns + 1);
+	m_TileBordersY.resize(m_NrOfTileRows + 1);
+	for (int c = 0; c < m_NrOfTileColumns; ++c)
+		m_TileBordersX[c] = min.x + c * m_TileSize;
+	for (int r = 0; r < m_NrOfTileRows; ++r)
+		m_TileBordersY[r] = min.y + r * m_TileSize;
+	m_TileBordersX[m_NrOfTileColumns] = max.x;
+	m_TileBordersY[m_NrOfTileRows] = max.y;
+
+	m_Tiles.resize(m_NrOfTileColumns * m_NrOfTileRows);
+	for (int r = 0; r < m_NrOfTileRows; ++r)
+	{
+		for (int c = 0; c < m_NrOfTileColumns; ++c)
+		{
+			NavMeshTile& tile = m_Tiles[r * m_NrOfTileColumns + c];
+			tile.min = { m_TileBordersX[c], m_TileBordersY[r] };
+			tile.max = { m_TileBordersX[c + 1], m_TileBordersY[r + 1] };
+		}
+	}
+
+	//2. Register the obstacles with the tiles they overlap
+	for (const Polygon& obstacle : obstacles)
+		AddObstacleToTiles(obstacle);
+
+	//3. Build every tile
+	std::vector<int> tiles(m_Tiles.size());
+	for (size_t i = 0; i < tiles.size(); ++i)
+		tiles[i] = (int)i;
+	RebuildTiles(tiles);
+}
+
+int Elite::NavGraph::AddObstacleToTiles(const Polygon& obstacle)
+{
+	Polygon expanded{ obstacle };
+	expanded.ExpandShape(m_PlayerRadius);
+
+	NavMeshObstacle navMeshObstacle{};
+	navMeshObstacle.points.assign(expanded.GetPoints().begin(), expanded.GetPoints().end());
+	if (GetSignedArea(navMeshObstacle.points) < 0.0)
+		std::reverse(navMeshObstacle.points.begin(), navMeshObstacle.points.end());
+	navMeshObstacle.min = { expanded.GetPosVertMinXPos(), expanded.GetPosVertMinYPos() };
+	navMeshObstacle.max = { expanded.GetPosVertMaxXPos(), expanded.GetPosVertMaxYPos() };
+	navMeshObstacle.isActive = true;
+
+	const int obstacleId{ (int)m_Obstacles.size() };
+	m_Obstacles.push_back(navMeshObstacle);
+
+	std::vector<int> tiles{};
+	GetOverlappingTiles(navMeshObstacle.min, navMeshObstacle.max, tiles);
+	for (int tileIdx : tiles)
+		m_Tiles[tileIdx].obstacleIds.push_back(obstacleId);
+	return obstacleId;
+}
+
+void Elite::NavGraph::GetOverlappingTiles(const Vector2& min, const Vector2& max, std::vector<int>& tiles) const
+{
+	tiles.clear();
+	if (max.x < m_TileBordersX.front() || min.x > m_TileBordersX.back() || max.y < m_TileBordersY.front() || min.y > m_TileBordersY.back())
+		return;
+
+	auto getColumn = [this](float x)
+	{
+		const int c{ static_cast<int>(floorf((x - m_TileBordersX.front()) / m_TileSize)) };
+		return c < 0 ? 0 : c >= m_NrOfTileColumns ? m_NrOfTileColumns - 1 : c;
+	};
+	auto getRow = [this](float y)
+	{
+		const int r{ static_cast<int>(floorf((y - m_TileBordersY.front()) / m_TileSize)) };
+		return r < 0 ? 0 : r >= m_NrOfTileRows ? m_NrOfTileRows - 1 : r;
+	};
+
+	for (int r = getRow(min.y); r <= getRow(max.y); ++r)
+	{
+		for (int c = getColumn(min.x); c <= getColumn(max.x); ++c)
+			tiles.push_back(r * m_NrOfTileColumns + c);
+	}
+}
+
+int Elite::NavGraph::GetTileFromPosition(const Vector2& position) const
+{
+	std::vector<int> tiles{};
+	GetOverlappingTiles(position, position, tiles);
+	return tiles.empty() ? -1 : tiles[0];
+}
+
+int Elite::NavGraph::GetNeighborTile(int tileIdx, int side) const
+{
+	const int c{ tileIdx % m_NrOfTileColumns };
+	const int r{ tileIdx / m_NrOfTileColumns };
+	switch (side)
+	{
+	case 0: return r > 0 ? tileIdx - m_NrOfTileColumns : -1;
+	case 1: return c < m_NrOfTileColumns - 1 ? tileIdx + 1 : -1;
+	case 2: return r < m_NrOfTileRows - 1 ? tileIdx + m_NrOfTileColumns : -1;
+	default: return c > 0 ? tileIdx - 1 : -1;
+	}
+}
+
+void Elite::NavGraph::RebuildTiles(std::vector<int> tileIdxs)
+{
+	std::vector<bool> isRebuilt(m_Tiles.size(), false);
+	for (int tileIdx : tileIdxs)
+		isRebuilt[tileIdx] = true;
+
+	//1. Remove the old regions and nodes, this also removes the nodes shared with the neighbors
+	for (int tileIdx : tileIdxs)
+		ClearTile(tileIdx);
+
+	//2. Triangulate the free area of every tile and create the nodes inside it
+	for (int tileIdx : tileIdxs)
+	{
+		CreateTileRegions(tileIdx);
+		CreateTileNodes(tileIdx);
+	}
+
+	//3. Create the nodes on the borders, every pair of tiles once
+	for (int tileIdx : tileIdxs)
+	{
+		for (int side = 0; side < 4; ++side)
+		{
+			const int neighborIdx{ GetNeighborTile(tileIdx, side) };
+			if (neighborIdx == -1 || (isRebuilt[neighborIdx] && (side == 0 || side == 3)))
+				continue;
+			StitchTiles(tileIdx, side);
+		}
+	}
+
+	//4. Connect the nodes of every rebuilt triangle + the triangles of the neighbors that got a new border node
+	for (int tileIdx : tileIdxs)
 	{
-		std::vector<NavGraphNode*> pFoundNodes;
-		for (NavGraphNode* pNode : m_Nodes)
+		const NavMeshTile& tile = m_Tiles[tileIdx];
+		for (size_t r = 0; r < tile.regions.size(); ++r)
 		{
-			if (std::find(pTriangle->metaData.IndexLines.begin(), pTriangle->metaData.IndexLines.end(), pNode->GetLineIndex()) != pTriangle->metaData.IndexLines.end())
+			for (const Triangle* pTriangle : tile.regions[r]->GetTriangles())
+				ConnectNodesOnTriangle(tile, (int)r, pTriangle);
+		}
+
+		for (int side = 0; side < 4; ++side)
+		{
+			const int neighborIdx{ GetNeighborTile(tileIdx, side) };
+			if (neighborIdx == -1 || isRebuilt[neighborIdx])
+				continue;
+
+			const NavMeshTile& neighbor = m_Tiles[neighborIdx];
+			for (const TileBorderLine& borderLine : neighbor.borderLines[(side + 2) % 4])
 			{
-				pFoundNodes.push_back(pNode);
+				if (neighbor.lineToNodeIdx[borderLine.regionIdx][borderLine.lineIdx] == invalid_node_index)
+					continue;
+				for (const Triangle* pTriangle : neighbor.regions[borderLine.regionIdx]->GetTrianglesFromLineIndex(borderLine.lineIdx))
+					ConnectNodesOnTriangle(neighbor, borderLine.regionIdx, pTriangle);
 			}
 		}
+	}
+
+	m_NrOfRebuiltTiles = (int)tileIdxs.size();
+}
 
-		if (pFoundNodes.size() == 2)
+void Elite::NavGraph::ClearTile(int tileIdx)
+{
+	NavMeshTile& tile = m_Tiles[tileIdx];
+	for (int nodeIdx : tile.nodes)
+		RemoveTileNode(nodeIdx);
+	tile.nodes.clear();
+
+	for (int side = 0; side < 4; ++side)
+	{
+		const int neighborIdx{ GetNeighborTile(tileIdx, side) };
+		for (const TileBorderLine& borderLine : tile.borderLines[side])
 		{
-			AddConnection(new GraphConnection2D{ pFoundNodes[0]->GetIndex(), pFoundNodes[1]->GetIndex() });
+			const int nodeIdx{ tile.lineToNodeIdx[borderLine.regionIdx][borderLine.lineIdx] };
+			if (nodeIdx == invalid_node_index)
+				continue;
+
+			RemoveTileNode(nodeIdx);
+			NavMeshTile& neighbor = m_Tiles[neighborIdx];
+			for (const TileBorderLine& neighborLine : neighbor.borderLines[(side + 2) % 4])
+			{
+				int& neighborNodeIdx = neighbor.lineToNodeIdx[neighborLine.regionIdx][neighborLine.lineIdx];
+				if (neighborNodeIdx == nodeIdx)
+					neighborNodeIdx = invalid_node_index;
+			}
 		}
-		else if (pFoundNodes.size() == 3)
+		tile.borderLines[side].clear();
+	}
+
+	for (Polygon* pRegion : tile.regions)
+		SAFE_DELETE(pRegion);
+	tile.regions.clear();
+	tile.lineToNodeIdx.clear();
+}
+
+void Elite::NavGraph::CreateTileRegions(int tileIdx)
+{
+	NavMeshTile& tile = m_Tiles[tileIdx];
+	const Vector2 min{ tile.min };
+	const Vector2 max{ tile.max };
+	auto isBorderEdge = [&](const Vector2& a, const Vector2& b)
+	{
+		return (a.x == b.x && (a.x == min.x || a.x == max.x)) || (a.y == b.y && (a.y == min.y || a.y == max.y));
+	};
+
+	//1. Clip the obstacles to the tile and merge the ones that overlap. The edges around them, reversed, bound the free area
+	//(free area on the left of every edge)
+	std::vector<std::vector<Vector2>> clippedObstacles{};
+	const double minArea{ 1e-6 * (max.x - min.x) * (max.y - min.y) };
+	for (int obstacleId : tile.obstacleIds)
+	{
+		std::vector<Vector2> clipped{ ClipToRect(m_Obstacles[obstacleId].points, min, max) };
+		if (clipped.size() >= 3 && GetSignedArea(clipped) > minArea)
+			clippedObstacles.push_back(std::move(clipped));
+	}
+
+	std::vector<std::pair<Vector2, Vector2>> edges{};
+	std::set<std::pair<PointKey, PointKey>> coveredBorder{};
+	std::vector<Vector2> borderPoints{ min, { max.x, min.y }, max, { min.x, max.y } };
+	for (const auto& edge : GetUnionEdges(clippedObstacles))
+	{
+		const Vector2& a = edge.first;
+		const Vector2& b = edge.second;
+		if (a.x == min.x || a.x == max.x || a.y == min.y || a.y == max.y)
+			borderPoints.push_back(a);
+
+		if (isBorderEdge(a, b))
+		{
+			coveredBorder.insert({ GetPointKey(a), GetPointKey(b) });
+			coveredBorder.insert({ GetPointKey(b), GetPointKey(a) });
+		}
+		else
 		{
-			// GraphConnection2D(GetNextFreeNodeIndex()
-			AddConnection(new GraphConnection2D{ pFoundNodes[0]->GetIndex(), pFoundNodes[1]->GetIndex() });
-			AddConnection(new GraphConnection2D{ pFoundNodes[1]->GetIndex(), pFoundNodes[2]->GetIndex() });
-			AddConnection(new GraphConnection2D{ pFoundNodes[2]->GetIndex(), pFoundNodes[0]->GetIndex() });
+			edges.push_back({ b, a });
+		}
+	}
+
+	//2. Walk the border of the tile counterclockwise, the stretches not covered by an obstacle bound the free area
+	auto getBorderOrder = [&](const Vector2& p)
+	{
+		if (p.y == min.y) return std::make_pair(0, p.x);
+		if (p.x == max.x) return std::make_pair(1, p.y);
+		if (p.y == max.y) return std::make_pair(2, -p.x);
+		return std::make_pair(3, -p.y);
+	};
+	std::sort(borderPoints.begin(), borderPoints.end(), [&](const Vector2& a, const Vector2& b) { return getBorderOrder(a) < getBorderOrder(b); });
+	borderPoints.erase(std::unique(borderPoints.begin(), borderPoints.end()), borderPoints.end());
+	for (size_t i = 0; i < borderPoints.size(); ++i)
+	{
+		const Vector2& a = borderPoints[i];
+		const Vector2& b = borderPoints[(i + 1) % borderPoints.size()];
+		if (coveredBorder.find({ GetPointKey(a), GetPointKey(b) }) == coveredBorder.end())
+			edges.push_back({ a, b });
+	}
+
+	//3. Link the edges into rings: counterclockwise rings are outlines, clockwise rings are holes
+	std::map<PointKey, std::vector<int>> outgoingEdges{};
+	for (size_t i = 0; i < edges.size(); ++i)
+		outgoingEdges[GetPointKey(edges[i].first)].push_back((int)i);
+
+	std::vector<bool> isUsed(edges.size(), false);
+	std::vector<std::vector<Vector2>> outlines{}, holes{};
+	for (size_t i = 0; i < edges.size(); ++i)
+	{
+		if (isUsed[i])
+			continue;
+
+		std::vector<Vector2> ring{};
+		int edgeIdx{ (int)i };
+		while (edgeIdx != -1 && !isUsed[edgeIdx])
+		{
+			isUsed[edgeIdx] = true;
+			ring.push_back(edges[edgeIdx].first);
+
+			//Where merged obstacles touch in a corner, the free area on the left continues along the sharpest left turn
+			const Vector2 direction{ edges[edgeIdx].second - edges[edgeIdx].first };
+			const auto& nextEdges = outgoingEdges[GetPointKey(edges[edgeIdx].second)];
+			edgeIdx = -1;
+			float largestTurn{ -FLT_MAX };
+			for (int nextIdx : nextEdges)
+			{
+				if (isUsed[nextIdx])
+					continue;
+
+				const Vector2 nextDirection{ edges[nextIdx].second - edges[nextIdx].first };
+				const float turn{ atan2f(Cross(direction, nextDirection), Dot(direction, nextDirection)) };
+				if (turn > largestTurn)
+				{
+					edgeIdx = nextIdx;
+					largestTurn = turn;
+				}
+			}
+		}
+
+		const double area{ ring.size() < 3 ? 0.0 : GetSignedArea(ring) };
+		if (area > minArea)
+			outlines.push_back(ring);
+		else if (area < -minArea)
+			holes.push_back(ring);
+	}
+
+	//4. One polygon per outline, with the holes inside it as children. Free area enclosed by merged obstacles is an
+	//outline inside another one, a hole belongs to the smallest outline around it
+	std::vector<std::vector<const std::vector<Vector2>*>> holesPerOutline(outlines.size());
+	for (const auto& hole : holes)
+	{
+		int outlineIdx{ outlines.size() == 1 ? 0 : -1 };
+		double outlineArea{ DBL_MAX };
+		for (size_t o = 0; o < outlines.size() && outlines.size() > 1; ++o)
+		{
+			const double area{ GetSignedArea(outlines[o]) };
+			if (area < outlineArea && IsPointInRing(hole[0], outlines[o]))
+			{
+				outlineIdx = (int)o;
+				outlineArea = area;
+			}
+		}
+		if (outlineIdx != -1)
+			holesPerOutline[outlineIdx].push_back(&hole);
+	}
+
+	for (size_t o = 0; o < outlines.size(); ++o)
+	{
+		Polygon* pRegion = new Polygon(outlines[o]);
+		for (const std::vector<Vector2>* pHole : holesPerOutline[o])
+			pRegion->AddChild(Polygon(*pHole));
+		pRegion->Triangulate();
+		tile.regions.push_back(pRegion);
+	}
+}
+
+void Elite::NavGraph::CreateTileNodes(int tileIdx)
+{
+	NavMeshTile& tile = m_Tiles[tileIdx];
+	tile.lineToNodeIdx.resize(tile.regions.size());
+	for (size_t r = 0; r < tile.regions.size(); ++r)
+	{
+		const Polygon* pRegion = tile.regions[r];
+		tile.lineToNodeIdx[r].assign(pRegion->GetLines().size(), invalid_node_index);
+		for (const Line* pLine : pRegion->GetLines())
+		{
+			//Lines between two triangles get a node, lines on the tile border can get one shared with the neighbor
+			if (pRegion->GetTrianglesFromLineIndex(pLine->index).size() == 2)
+			{
+				const int nodeIdx{ CreateNode(pLine) };
+				tile.lineToNodeIdx[r][pLine->index] = nodeIdx;
+				tile.nodes.push_back(nodeIdx);
+				continue;
+			}
+
+			const Vector2& a = pLine->p1;
+			const Vector2& b = pLine->p2;
+			int side{ -1 };
+			if (a.y == b.y && a.y == tile.min.y) side = 0;
+			else if (a.x == b.x && a.x == tile.max.x) side = 1;
+			else if (a.y == b.y && a.y == tile.max.y) side = 2;
+			else if (a.x == b.x && a.x == tile.min.x) side = 3;
+			if (side == -1)
+				continue;
+
+			const bool isHorizontal{ side % 2 == 0 };
+			const float start{ isHorizontal ? a.x : a.y };
+			const float end{ isHorizontal ? b.x : b.y };
+			tile.borderLines[side].push_back({ (int)r, pLine->index, start < end ? start : end, start < end ? end : start });
 		}
 	}
-	
-	//3. Set the connections cost to the actual distance
-	SetConnectionCostsToDistance();
 
+	for (auto& borderLines : tile.borderLines)
+		std::sort(borderLines.begin(), borderLines.end(), [](const TileBorderLine& a, const TileBorderLine& b) { return a.start < b.start; });
 }
 
+void Elite::NavGraph::StitchTiles(int tileIdx, int side)
+{
+	//Both tiles clip the same obstacles against the same border, so their lines on it should line up
+	NavMeshTile& tile = m_Tiles[tileIdx];
+	NavMeshTile& neighbor = m_Tiles[GetNeighborTile(tileIdx, side)];
+	const auto& lines = tile.borderLines[side];
+	const auto& neighborLines = neighbor.borderLines[(side + 2) % 4];
+	const float epsilon{ 1e-4f * m_TileSize };
+
+	size_t i{}, j{};
+	while (i < lines.size() && j < neighborLines.size())
+	{
+		const TileBorderLine& line = lines[i];
+		const TileBorderLine& neighborLine = neighborLines[j];
+		if (fabs(line.start - neighborLine.start) < epsilon && fabs(line.end - neighborLine.end) < epsilon)
+		{
+			const int nodeIdx{ CreateNode(tile.regions[line.regionIdx]->GetLines()[line.lineIdx]) };
+			tile.lineToNodeIdx[line.regionIdx][line.lineIdx] = nodeIdx;
+			neighbor.lineToNodeIdx[neighborLine.regionIdx][neighborLine.lineIdx] = nodeIdx;
+			++i;
+			++j;
+		}
+		else if (line.end < neighborLine.end)
+		{
+			++i;
+		}
+		else
+		{
+			++j;
+		}
+	}
+}
+
+int Elite::NavGraph::CreateNode(const Line* pLine)
+{
+	//Reuse removed nodes, so the graph does not keep growing with every rebuild. The node itself is brought back
+	//instead of replaced: a path found before the rebuild can still point to it, see PathRequestQueue for detecting that
+	if (!m_FreeNodeIndices.empty())
+	{
+		const int nodeIdx{ m_FreeNodeIndices.back() };
+		m_FreeNodeIndices.pop_back();
+
+		NavGraphNode* pNode = GetNode(nodeIdx);
+		pNode->SetIndex(nodeIdx);
+		pNode->SetPosition((pLine->p1 + pLine->p2) / 2.f);
+		MarkGraphModified(true, false);
+		m_NodeLines[nodeIdx] = const_cast<Line*>(pLine);
+		return nodeIdx;
+	}
+
+	const int nodeIdx{ GetNextFreeNodeIndex() };
+	AddNode(new NavGraphNode{ nodeIdx, nodeIdx, (pLine->p1 + pLine->p2) / 2.f });
+	if (nodeIdx >= (int)m_NodeLines.size())
+		m_NodeLines.resize(nodeIdx + 1, nullptr);
+	m_NodeLines[nodeIdx] = const_cast<Line*>(pLine);
+	return nodeIdx;
+}
+
+void Elite::NavGraph::RemoveTileNode(int nodeIdx)
+{
+	RemoveNode(nodeIdx);
+	m_NodeLines[nodeIdx] = nullptr;
+	m_FreeNodeIndices.push_back(nodeIdx);
+}
+
+void Elite::NavGraph::ConnectNodesOnTriangle(const NavMeshTile& tile, int regionIdx, const Triangle* pTriangle)
+{
+	std::array<int, 3> foundNodes{};
+	int nrOfFoundNodes{ 0 };
+	for (int lineIdx : pTriangle->metaData.IndexLines)
+	{
+		const int nodeIdx{ tile.lineToNodeIdx[regionIdx][lineIdx] };
+		if (nodeIdx != invalid_node_index)
+			foundNodes[nrOfFoundNodes++] = nodeIdx;
+	}
+
+	for (int i = 0; i < nrOfFoundNodes; ++i)
+	{
+		for (int j = i + 1; j < nrOfFoundNodes; ++j)
+		{
+			if (IsUniqueConnection(foundNodes[i], foundNodes[j]))
+				AddConnection(new GraphConnection2D{ foundNodes[i], foundNodes[j], Distance(GetNodePos(foundNodes[i]), GetNodePos(foundNodes[j])) });
+		}
+	}
+}
+#pragma endregion //TiledNavMesh
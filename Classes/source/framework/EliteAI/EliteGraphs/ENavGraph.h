@@ -10,24 +10,102 @@ namespace Elite
 	{
 	public:
 		NavGraph(const Polygon& baseMesh, float playerRadius );
+		// Obstacles passed in directly instead of taken from the NavigationColliders in the physics world
+		NavGraph(const Polygon& baseMesh, const std::vector<Polygon>& obstacles, float playerRadius);
+		// Tiled navigation mesh over the bounding box of the base mesh: obstacles can be added and removed afterwards,
+		// only the tiles they overlap are triangulated again. The obstacles passed in get ids 0, 1, 2, ...
+		NavGraph(const Polygon& baseMesh, float playerRadius, float tileSize);
+		NavGraph(const Polygon& baseMesh, const std::vector<Polygon>& obstacles, float playerRadius, float tileSize);
 		~NavGraph();
 
 		int GetNodeIdxFromLineIdx(int lineIdx) const;
-		Polygon* GetNavMeshPolygon() const;
+		Polygon* GetNavMeshPolygon() const; // nullptr for a tiled navigation mesh
+		std::vector<Polygon*> GetNavMeshPolygons() const; // every region of every tile for a tiled navigation mesh
+
+		// Queries that work for both single and tiled navigation meshes
+		// Triangle at the position + the nodes on its lines (invalid_node_index for lines without node)
+		const Triangle* GetTriangleFromPosition(const Vector2& position, std::array<int, 3>& lineNodeIndices) const;
+		// Line of every node, indexed by NavGraphNode::GetLineIndex()
+		const std::vector<Line*>& GetLines() const;
+
+		// Tiled navigation mesh only: the obstacle is expanded by the player radius like the ones passed in the constructor,
+		// it may overlap other obstacles. Returns the id of the obstacle, or -1 when the mesh is not tiled
+		int AddObstacle(const Polygon& obstacle);
+		void RemoveObstacle(int obstacleId);
+
+		bool IsTiled() const { return m_TileSize > 0.f; }
+		float GetTileSize() const { return m_TileSize; }
+		int GetNrOfTiles() const { return (int)m_Tiles.size(); }
+		int GetNrOfRebuiltTiles() const { return m_NrOfRebuiltTiles; } // by the last add/remove
+		int GetNrOfObstacles() const;
 
 	private:
+		// A line on the border of a tile, lines of neighboring tiles on the same stretch of border share a node
+		struct TileBorderLine
+		{
+			int regionIdx;
+			int lineIdx;
+			float start; // position along the border, start < end
+			float end;
+		};
+
+		struct NavMeshTile
+		{
+			Vector2 min;
+			Vector2 max;
+			std::vector<int> obstacleIds; // obstacles overlapping the tile
+			std::vector<Polygon*> regions; // free area of the tile, one polygon (with holes) per connected part
+			std::vector<std::vector<int>> lineToNodeIdx; // per region, node on every line
+			std::vector<int> nodes; // nodes on the lines inside the tile, the nodes on the borders are shared with the neighbors
+			std::array<std::vector<TileBorderLine>, 4> borderLines; // per side: bottom, right, top, left
+		};
+
+		struct NavMeshObstacle
+		{
+			std::vector<Vector2> points; // expanded by the player radius, counterclockwise
+			Vector2 min;
+			Vector2 max;
+			bool isActive;
+		};
+
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
+		std::vector<int> m_LineToNodeIdx; //Node on every line of the navigation mesh, invalid_node_index for lines without one
+
+		// Tiled navigation mesh
+		float m_TileSize = 0.f;
+		float m_PlayerRadius = 0.f;
+		int m_NrOfTileColumns = 0;
+		int m_NrOfTileRows = 0;
+		std::vector<float> m_TileBordersX; // shared by the tiles on both sides, so both see the exact same coordinate
+		std::vector<float> m_TileBordersY;
+		std::vector<NavMeshTile> m_Tiles;
+		std::vector<NavMeshObstacle> m_Obstacles;
+		std::vector<Line*> m_NodeLines; // line of every node, tiled nodes use their own index as line index
+		std::vector<int> m_FreeNodeIndices;
+		int m_NrOfRebuiltTiles = 0;
 
 		void CreateNavigationGraph();
 
+		void InitializeTiles(const Polygon& baseMesh, const std::vector<Polygon>& obstacles);
+		int AddObstacleToTiles(const Polygon& obstacle);
+		void GetOverlappingTiles(const Vector2& min, const Vector2& max, std::vector<int>& tiles) const;
+		int GetNeighborTile(int tileIdx, int side) const;
+		void RebuildTiles(std::vector<int> tileIdxs);
+		void ClearTile(int tileIdx);
+		int GetTileFromPosition(const Vector2& position) const;
+		void CreateTileRegions(int tileIdx);
+		void CreateTileNodes(int tileIdx);
+		void StitchTiles(int tileIdx, int side);
+		int CreateNode(const Line* pLine);
+		void RemoveTileNode(int nodeIdx);
+		void ConnectNodesOnTriangle(const NavMeshTile& tile, int regionIdx, const Triangle* pTriangle);
 
 	private:
 		NavGraph(const NavGraph& other) = delete;
 		NavGraph& operator=(const NavGraph& other) = delete;
 		NavGraph(NavGraph&& other) = delete;
 		NavGraph& operator=(NavGraph&& other) = delete;
-		
+
 	};
 }
-
@@ -1,12 +1,19 @@
 #pragma once
+#include "ESearchContext.h"
 
 namespace Elite
 {
+	enum class AStarMode
+	{
+		OpenList, // original implementation: linear searches over the open and closed vectors
+		BinaryHeap, // binary heap open list + per-node records indexed by GraphNode::GetIndex()
+	};
+
 	template <class T_NodeType, class T_ConnectionType>
 	class AStar
 	{
 	public:
-		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, AStarMode mode = AStarMode::BinaryHeap);
 
 		// stores the optimal connection to a node and its total costs related to the start and end node of the path
 		struct NodeRecord
@@ -31,24 +38,53 @@ namespace Elite
 		};
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Binary heap search that reuses the buffers of the context, the returned path is owned by the context
+		const std::vector<T_NodeType*>& FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, SearchContext<T_NodeType, T_ConnectionType>& context);
+
+		AStarMode GetMode() const { return m_Mode; }
+		void SetMode(AStarMode mode) { m_Mode = mode; }
+
+		// Binary heap searches can walk the compact IGraph::GetCSR() snapshot instead of the connection lists
+		bool IsUsingCSR() const { return m_UseCSR; }
+		void SetUseCSR(bool useCSR) { m_UseCSR = useCSR; }
 
 	private:
+		std::vector<T_NodeType*> FindPathOpenList(T_NodeType* pStartNode, T_NodeType* pGoalNode);
+		std::vector<T_NodeType*> FindPathBinaryHeap(T_NodeType* pStartNode, T_NodeType* pGoalNode);
+
 		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
 
 		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
 		Heuristic m_HeuristicFunction;
+		AStarMode m_Mode;
+		bool m_UseCSR = false;
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
-	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, AStarMode mode)
 		: m_pGraph(pGraph)
 		, m_HeuristicFunction(hFunction)
+		, m_Mode(mode)
 	{
 	}
 
 	template <class T_NodeType, class T_ConnectionType>
 	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
 	{
+		switch (m_Mode)
+		{
+		case AStarMode::OpenList:
+			return FindPathOpenList(pStartNode, pGoalNode);
+		default:
+			return FindPathBinaryHeap(pStartNode, pGoalNode);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPathOpenList(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		ELITE_PROFILE_SCOPE("AStar::FindPath");
+
 		// Variables
 		vector<T_NodeType*> path;
 		vector<NodeRecord> openList;
@@ -166,6 +202,82 @@ namespace Elite
 		return path;
 	}
 
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPathBinaryHeap(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		// One-off query: the context only lives for this search
+		SearchContext<T_NodeType, T_ConnectionType> context{ m_pGraph };
+		return FindPath(pStartNode, pGoalNode, context);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const std::vector<T_NodeType*>& AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, SearchContext<T_NodeType, T_ConnectionType>& context)
+	{
+		ELITE_PROFILE_SCOPE("AStar::FindPath");
+		using OpenRecord = typename SearchContext<T_NodeType, T_ConnectionType>::OpenRecord;
+
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		// 1. Invalidate the records of the previous query
+		// Nodes without a record of this search count as unvisited with an infinite g-cost
+		context.BeginSearch();
+
+		// Open list as a min-heap on the f-cost
+		// Instead of a decrease-key we push a new record and skip the outdated one when it gets popped (lazy deletion)
+		context.SetRecord(startIdx, 0.f, invalid_node_index);
+		context.PushOpen(OpenRecord{ startIdx, 0.f, GetHeuristicCost(pStartNode, pGoalNode) });
+
+		bool isGoalFound{ false };
+		while (!context.IsOpenListEmpty())
+		{
+			OpenRecord currentRecord = context.PopOpen();
+
+			// 2.A Skip records that got replaced by a cheaper connection after they were pushed
+			if (currentRecord.costSoFar > context.GetCostSoFar(currentRecord.nodeIdx))
+				continue;
+			context.CountExpandedNode();
+
+			// 2.B If endnode was found, stop
+			if (currentRecord.nodeIdx == goalIdx)
+			{
+				isGoalFound = true;
+				break;
+			}
+
+			// 2.C Else, we get all the connections of the record's node
+			// 2.D Open or closed, a node only gets (re)opened when this connection is cheaper
+			auto visitConnection = [&](int nextIdx, float connectionCost)
+			{
+				const float newGCost{ currentRecord.costSoFar + connectionCost };
+				if (newGCost >= context.GetCostSoFar(nextIdx))
+					return;
+
+				context.SetRecord(nextIdx, newGCost, currentRecord.nodeIdx);
+				context.PushOpen(OpenRecord{ nextIdx, newGCost, newGCost + GetHeuristicCost(m_pGraph->GetNode(nextIdx), pGoalNode) });
+			};
+
+			if (m_UseCSR)
+			{
+				const GraphCSR& csr = m_pGraph->GetCSR();
+				for (int i = csr.GetBegin(currentRecord.nodeIdx); i < csr.GetEnd(currentRecord.nodeIdx); ++i)
+					visitConnection(csr.GetNeighbor(i), csr.GetCost(i));
+			}
+			else
+			{
+				for (auto con : m_pGraph->GetNodeConnections(currentRecord.nodeIdx))
+					visitConnection(con->GetTo(), con->GetCost());
+			}
+		}
+
+		// 3 Reconstruct path from the goal back to the start node, no path leaves it empty
+		if (isGoalFound)
+			context.BuildPath(startIdx, goalIdx);
+
+		context.EndSearch();
+		return context.GetPath();
+	}
+
 	template <class T_NodeType, class T_ConnectionType>
 	float Elite::AStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const
 	{
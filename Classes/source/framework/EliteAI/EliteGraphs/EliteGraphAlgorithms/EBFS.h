@@ -1,4 +1,5 @@
 #pragma once
+#include "ESearchContext.h"
 
 namespace Elite 
 {
@@ -9,8 +10,15 @@ namespace Elite
 		BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph);
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Same search, but reusing the buffers of the context, the returned path is owned by the context
+		const std::vector<T_NodeType*>& FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, SearchContext<T_NodeType, T_ConnectionType>& context);
+
+		// Context searches can walk the compact IGraph::GetCSR() snapshot instead of the connection lists
+		bool IsUsingCSR() const { return m_UseCSR; }
+		void SetUseCSR(bool useCSR) { m_UseCSR = useCSR; }
 	private:
 		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		bool m_UseCSR = false;
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
@@ -70,5 +78,62 @@ namespace Elite
 
 		return path;
 	}
-}
 
+	template <class T_NodeType, class T_ConnectionType>
+	const std::vector<T_NodeType*>& BFS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, SearchContext<T_NodeType, T_ConnectionType>& context)
+	{
+		const int startIdx = pStartNode->GetIndex();
+		const int destinationIdx = pDestinationNode->GetIndex();
+
+		// Nodes with a record of this search are the closed list, their connection is the history
+		context.BeginSearch();
+
+		// Add start node
+		context.SetRecord(startIdx, 0.f, invalid_node_index);
+		context.PushQueue(startIdx);
+
+		bool isDestinationFound{ false };
+		while (!context.IsQueueEmpty())
+		{
+			// Taking a node from the queue
+			const int currentIdx = context.PopQueue();
+			context.CountExpandedNode();
+
+			// If endnode was found, stop
+			if (currentIdx == destinationIdx)
+			{
+				isDestinationFound = true;
+				break;
+			}
+
+			auto visitConnection = [&](int nextIdx, float connectionCost)
+			{
+				if (!context.IsVisited(nextIdx))
+				{
+					// We did not find this node in the closedlist
+					context.SetRecord(nextIdx, context.GetCostSoFar(currentIdx) + connectionCost, currentIdx);
+					context.PushQueue(nextIdx);
+				}
+			};
+
+			if (m_UseCSR)
+			{
+				const GraphCSR& csr = m_pGraph->GetCSR();
+				for (int i = csr.GetBegin(currentIdx); i < csr.GetEnd(currentIdx); ++i)
+					visitConnection(csr.GetNeighbor(i), csr.GetCost(i));
+			}
+			else
+			{
+				for (auto con : m_pGraph->GetNodeConnections(currentIdx))
+					visitConnection(con->GetTo(), con->GetCost());
+			}
+		}
+
+		// Track back, no path leaves it empty
+		if (isDestinationFound)
+			context.BuildPath(startIdx, destinationIdx);
+
+		context.EndSearch();
+		return context.GetPath();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,672 @@
+#pragma once
+#include "ESearchContext.h"
+
+namespace Elite
+{
+	// Hierarchical pathfinding (HPA*) on an undirected GridGraph
+	// The grid is split in square clusters. Where 2 neighboring clusters are connected, entrance nodes are placed on both sides of the border.
+	// Entrances within the same cluster are connected by their shortest path inside the cluster (intra edges).
+	// A query searches this small abstract graph and only refines the segments between entrances into grid nodes.
+	// When a cell changes, only the clusters around it are recomputed (see OnNodeChanged).
+	template <class T_NodeType, class T_ConnectionType>
+	class HPAStar
+	{
+	public:
+		HPAStar(GridGraph<T_NodeType, T_ConnectionType>* pGridGraph, Heuristic hFunction, int clusterSize = 10);
+
+		// Recomputes the whole hierarchy, happens automatically on the first query
+		void Build();
+		// Marks the clusters touching this node as outdated, they get recomputed before the next query
+		void OnNodeChanged(int idx);
+
+		// Path on the abstract graph: start cell, entrance cells, goal cell. Empty when there is no path
+		const std::vector<int>& FindAbstractPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Appends the grid nodes after fromIdx up to and including toIdx, for 2 consecutive cells of an abstract path
+		void RefineSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path);
+		// Abstract path, fully refined
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void SetHeuristicFunction(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+
+		// Statistics
+		int GetNrOfClusters() const { return m_NrOfClustersX * m_NrOfClustersY; }
+		int GetNrOfAbstractNodes() const { return (int)m_AbstractNodes.size() - (int)m_FreeAbstractNodes.size(); }
+		unsigned int GetNrOfRebuiltClusters() const { return m_NrOfRebuiltClusters; } // since the last ResetCounters
+		void ResetCounters() { m_NrOfRebuiltClusters = 0; }
+
+	private:
+		using OpenRecord = typename SearchContext<T_NodeType, T_ConnectionType>::OpenRecord;
+
+		struct AbstractEdge
+		{
+			int toNode = invalid_node_index;
+			float cost = 0.f;
+			int borderIdx = invalid_node_index; // border an inter edge crosses, invalid for intra edges
+		};
+
+		struct AbstractNode
+		{
+			int cellIdx = invalid_node_index;
+			int clusterIdx = invalid_node_index;
+			vector<AbstractEdge> edges;
+		};
+
+		// Clusters and borders
+		int GetClusterIdx(int cellIdx) const;
+		void GetClusterBounds(int clusterIdx, int& minCol, int& minRow, int& maxCol, int& maxRow) const;
+		void GetBorders(int clusterIdx, vector<int>& borders) const;
+		void GetBorderClusters(int borderIdx, int& clusterIdx, int& otherClusterIdx) const;
+		void UpdateDirtyClusters();
+		void RebuildBorder(int borderIdx);
+		void RecomputeIntraEdges(int clusterIdx);
+
+		// Abstract nodes
+		int GetOrCreateAbstractNode(int cellIdx);
+		void RemoveAbstractNode(int nodeIdx);
+
+		// Grid searches, restricted to one cluster
+		bool SearchInCluster(int startIdx, int clusterIdx, int goalIdx);
+		float GetConnectionCost(int fromIdx, int toIdx) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGridGraph;
+		Heuristic m_HeuristicFunction;
+		SearchContext<T_NodeType, T_ConnectionType> m_Context;
+
+		int m_ClusterSize;
+		int m_NrOfClustersX = 0;
+		int m_NrOfClustersY = 0;
+		bool m_IsBuilt = false;
+
+		vector<AbstractNode> m_AbstractNodes;
+		vector<int> m_FreeAbstractNodes;
+		vector<int> m_AbstractNodeOfCell; // abstract node index per grid cell, invalid if the cell is no entrance
+		vector<vector<int>> m_ClusterNodes; // abstract nodes per cluster
+		vector<bool> m_IsClusterDirty;
+		vector<int> m_DirtyClusters;
+
+		// Scratch buffers of the abstract search
+		vector<float> m_AbstractCostSoFar;
+		vector<int> m_AbstractParent;
+		vector<float> m_GoalEdgeCost;
+		vector<AbstractEdge> m_StartEdges;
+		vector<OpenRecord> m_AbstractOpenList;
+		vector<int> m_AbstractPath;
+		vector<int> m_Segment;
+
+		unsigned int m_NrOfRebuiltClusters = 0;
+
+		// Entrances at least this wide get a transition at both ends instead of one in the middle
+		const int m_MaxEntranceWidth = 6;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	HPAStar<T_NodeType, T_ConnectionType>::HPAStar(GridGraph<T_NodeType, T_ConnectionType>* pGridGraph, Heuristic hFunction, int clusterSize)
+		: m_pGridGraph(pGridGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_Context(pGridGraph)
+		, m_ClusterSize(clusterSize)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::Build()
+	{
+		m_NrOfClustersX = (m_pGridGraph->GetColumns() + m_ClusterSize - 1) / m_ClusterSize;
+		m_NrOfClustersY = (m_pGridGraph->GetRows() + m_ClusterSize - 1) / m_ClusterSize;
+
+		m_AbstractNodes.clear();
+		m_FreeAbstractNodes.clear();
+		m_AbstractNodeOfCell.assign(m_pGridGraph->GetNrOfNodes(), invalid_node_index);
+		m_ClusterNodes.assign(GetNrOfClusters(), vector<int>{});
+		m_IsClusterDirty.assign(GetNrOfClusters(), false);
+		m_DirtyClusters.clear();
+
+		// Everything is outdated
+		for (int clusterIdx = 0; clusterIdx < GetNrOfClusters(); ++clusterIdx)
+		{
+			m_IsClusterDirty[clusterIdx] = true;
+			m_DirtyClusters.push_back(clusterIdx);
+		}
+
+		m_IsBuilt = true;
+		UpdateDirtyClusters();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::OnNodeChanged(int idx)
+	{
+		if (!m_IsBuilt || !m_pGridGraph->IsNodeValid(idx))
+			return;
+
+		// Connections to the neighbors of the node changed as well, the clusters on the other side of a border are handled when rebuilding it
+		const int clusterIdx = GetClusterIdx(idx);
+		if (!m_IsClusterDirty[clusterIdx])
+		{
+			m_IsClusterDirty[clusterIdx] = true;
+			m_DirtyClusters.push_back(clusterIdx);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HPAStar<T_NodeType, T_ConnectionType>::GetClusterIdx(int cellIdx) const
+	{
+		const int col = cellIdx % m_pGridGraph->GetColumns();
+		const int row = cellIdx / m_pGridGraph->GetColumns();
+		return (row / m_ClusterSize) * m_NrOfClustersX + col / m_ClusterSize;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::GetClusterBounds(int clusterIdx, int& minCol, int& minRow, int& maxCol, int& maxRow) const
+	{
+		// min inclusive, max exclusive
+		minCol = (clusterIdx % m_NrOfClustersX) * m_ClusterSize;
+		minRow = (clusterIdx / m_NrOfClustersX) * m_ClusterSize;
+		maxCol = (minCol + m_ClusterSize < m_pGridGraph->GetColumns()) ? minCol + m_ClusterSize : m_pGridGraph->GetColumns();
+		maxRow = (minRow + m_ClusterSize < m_pGridGraph->GetRows()) ? minRow + m_ClusterSize : m_pGridGraph->GetRows();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::GetBorders(int clusterIdx, vector<int>& borders) const
+	{
+		// Borders are numbered: first the vertical ones (cluster | cluster to the right), then the horizontal ones (cluster / cluster below),
+		// then 2 per corner where 4 clusters meet (top left \ bottom right, top right / bottom left)
+		const int clusterX = clusterIdx % m_NrOfClustersX;
+		const int clusterY = clusterIdx / m_NrOfClustersX;
+		const int nrOfVerticalBorders = (m_NrOfClustersX - 1) * m_NrOfClustersY;
+		const int firstCornerBorder = nrOfVerticalBorders + m_NrOfClustersX * (m_NrOfClustersY - 1);
+		auto getCornerBorder = [&](int cornerX, int cornerY, int diagonal) { return firstCornerBorder + 2 * (cornerY * (m_NrOfClustersX - 1) + cornerX) + diagonal; };
+
+		const bool hasLeft = clusterX > 0;
+		const bool hasRight = clusterX < m_NrOfClustersX - 1;
+		const bool hasTop = clusterY > 0;
+		const bool hasBottom = clusterY < m_NrOfClustersY - 1;
+
+		if (hasLeft)
+			borders.push_back(clusterY * (m_NrOfClustersX - 1) + clusterX - 1);
+		if (hasRight)
+			borders.push_back(clusterY * (m_NrOfClustersX - 1) + clusterX);
+		if (hasTop)
+			borders.push_back(nrOfVerticalBorders + (clusterY - 1) * m_NrOfClustersX + clusterX);
+		if (hasBottom)
+			borders.push_back(nrOfVerticalBorders + clusterY * m_NrOfClustersX + clusterX);
+
+		if (hasRight && hasBottom)
+			borders.push_back(getCornerBorder(clusterX, clusterY, 0));
+		if (hasLeft && hasTop)
+			borders.push_back(getCornerBorder(clusterX - 1, clusterY - 1, 0));
+		if (hasLeft && hasBottom)
+			borders.push_back(getCornerBorder(clusterX - 1, clusterY, 1));
+		if (hasRight && hasTop)
+			borders.push_back(getCornerBorder(clusterX, clusterY - 1, 1));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::GetBorderClusters(int borderIdx, int& clusterIdx, int& otherClusterIdx) const
+	{
+		const int nrOfVerticalBorders = (m_NrOfClustersX - 1) * m_NrOfClustersY;
+		const int firstCornerBorder = nrOfVerticalBorders + m_NrOfClustersX * (m_NrOfClustersY - 1);
+
+		if (borderIdx < nrOfVerticalBorders)
+		{
+			clusterIdx = (borderIdx / (m_NrOfClustersX - 1)) * m_NrOfClustersX + borderIdx % (m_NrOfClustersX - 1);
+			otherClusterIdx = clusterIdx + 1;
+		}
+		else if (borderIdx < firstCornerBorder)
+		{
+			clusterIdx = borderIdx - nrOfVerticalBorders;
+			otherClusterIdx = clusterIdx + m_NrOfClustersX;
+		}
+		else
+		{
+			// Top left cluster of the corner, for the / diagonal the top right one
+			const int corner = (borderIdx - firstCornerBorder) / 2;
+			const int topLeftClusterIdx = (corner / (m_NrOfClustersX - 1)) * m_NrOfClustersX + corner % (m_NrOfClustersX - 1);
+			const bool isBackslash = (borderIdx - firstCornerBorder) % 2 == 0;
+			clusterIdx = isBackslash ? topLeftClusterIdx : topLeftClusterIdx + 1;
+			otherClusterIdx = isBackslash ? topLeftClusterIdx + m_NrOfClustersX + 1 : topLeftClusterIdx + m_NrOfClustersX;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::UpdateDirtyClusters()
+	{
+		if (m_DirtyClusters.empty())
+			return;
+
+		// 1. Rebuild the entrances on every border of a dirty cluster
+		// The clusters on the other side get new entrances too, so their intra edges need to be recomputed as well
+		vector<int> borders{};
+		for (int clusterIdx : m_DirtyClusters)
+			GetBorders(clusterIdx, borders);
+
+		std::sort(borders.begin(), borders.end());
+		borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+		vector<int> clustersToRecompute{ m_DirtyClusters };
+		for (int borderIdx : borders)
+		{
+			RebuildBorder(borderIdx);
+
+			int clusterIdx, otherClusterIdx;
+			GetBorderClusters(borderIdx, clusterIdx, otherClusterIdx);
+			clustersToRecompute.push_back(clusterIdx);
+			clustersToRecompute.push_back(otherClusterIdx);
+		}
+
+		std::sort(clustersToRecompute.begin(), clustersToRecompute.end());
+		clustersToRecompute.erase(std::unique(clustersToRecompute.begin(), clustersToRecompute.end()), clustersToRecompute.end());
+
+		// 2. Entrances that lost all their inter edges are no entrances anymore
+		for (int clusterIdx : clustersToRecompute)
+		{
+			vector<int> nodes = m_ClusterNodes[clusterIdx];
+			for (int nodeIdx : nodes)
+			{
+				const auto& edges = m_AbstractNodes[nodeIdx].edges;
+				if (std::none_of(edges.begin(), edges.end(), [](const AbstractEdge& edge) { return edge.borderIdx != invalid_node_index; }))
+					RemoveAbstractNode(nodeIdx);
+			}
+		}
+
+		// 3. Connect the entrances within each affected cluster
+		for (int clusterIdx : clustersToRecompute)
+		{
+			RecomputeIntraEdges(clusterIdx);
+			++m_NrOfRebuiltClusters;
+		}
+
+		for (int clusterIdx : m_DirtyClusters)
+			m_IsClusterDirty[clusterIdx] = false;
+		m_DirtyClusters.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RebuildBorder(int borderIdx)
+	{
+		int clusterIdx, otherClusterIdx;
+		GetBorderClusters(borderIdx, clusterIdx, otherClusterIdx);
+
+		// 1. Remove the old inter edges of this border
+		for (int idx : { clusterIdx, otherClusterIdx })
+		{
+			for (int nodeIdx : m_ClusterNodes[idx])
+			{
+				auto& edges = m_AbstractNodes[nodeIdx].edges;
+				edges.erase(std::remove_if(edges.begin(), edges.end(), [borderIdx](const AbstractEdge& edge) { return edge.borderIdx == borderIdx; }), edges.end());
+			}
+		}
+
+		auto addTransition = [&](int cellIdx, int otherCellIdx)
+		{
+			const float cost = GetConnectionCost(cellIdx, otherCellIdx);
+			const int nodeIdx = GetOrCreateAbstractNode(cellIdx);
+			const int otherNodeIdx = GetOrCreateAbstractNode(otherCellIdx);
+			m_AbstractNodes[nodeIdx].edges.push_back(AbstractEdge{ otherNodeIdx, cost, borderIdx });
+			m_AbstractNodes[otherNodeIdx].edges.push_back(AbstractEdge{ nodeIdx, cost, borderIdx });
+		};
+
+		int minCol, minRow, maxCol, maxRow;
+		GetClusterBounds(clusterIdx, minCol, minRow, maxCol, maxRow);
+
+		// 2. Corner: the only crossing is the diagonal connection between the 2 corner cells
+		const int nrOfVerticalBorders = (m_NrOfClustersX - 1) * m_NrOfClustersY;
+		const int firstCornerBorder = nrOfVerticalBorders + m_NrOfClustersX * (m_NrOfClustersY - 1);
+		if (borderIdx >= firstCornerBorder)
+		{
+			const bool isBackslash = otherClusterIdx == clusterIdx + m_NrOfClustersX + 1;
+			const int cellIdx = isBackslash ? m_pGridGraph->GetIndex(maxCol - 1, maxRow - 1) : m_pGridGraph->GetIndex(minCol, maxRow - 1);
+			const int otherCellIdx = isBackslash ? m_pGridGraph->GetIndex(maxCol, maxRow) : m_pGridGraph->GetIndex(minCol - 1, maxRow);
+			if (GetConnectionCost(cellIdx, otherCellIdx) < FLT_MAX)
+				addTransition(cellIdx, otherCellIdx);
+			return;
+		}
+
+		// 3. Walk along the border and find the stretches of cell pairs that are connected straight across
+		// A stretch also ends where the cells on either side are not connected to their predecessor, so every cell of an entrance can reach its transition
+		const bool isVertical = borderIdx < nrOfVerticalBorders;
+		const int length = isVertical ? maxRow - minRow : maxCol - minCol;
+
+		auto getCell = [&](int i) { return isVertical ? m_pGridGraph->GetIndex(maxCol - 1, minRow + i) : m_pGridGraph->GetIndex(minCol + i, maxRow - 1); };
+		auto getOtherCell = [&](int i) { return isVertical ? m_pGridGraph->GetIndex(maxCol, minRow + i) : m_pGridGraph->GetIndex(minCol + i, maxRow); };
+
+		vector<bool> isConnected(length);
+		for (int i = 0; i < length; ++i)
+			isConnected[i] = GetConnectionCost(getCell(i), getOtherCell(i)) < FLT_MAX;
+
+		auto isAlongBorder = [&](int i, int j) { return GetConnectionCost(getCell(i), getCell(j)) < FLT_MAX && GetConnectionCost(getOtherCell(i), getOtherCell(j)) < FLT_MAX; };
+
+		int entranceStart = invalid_node_index;
+		for (int i = 0; i <= length; ++i)
+		{
+			if (entranceStart != invalid_node_index && i < length && isConnected[i] && isAlongBorder(i - 1, i))
+				continue;
+
+			if (entranceStart != invalid_node_index)
+			{
+				// Entrance [entranceStart, i - 1]
+				const int entranceEnd = i - 1;
+				if (entranceEnd - entranceStart + 1 < m_MaxEntranceWidth)
+				{
+					const int middle = (entranceStart + entranceEnd) / 2;
+					addTransition(getCell(middle), getOtherCell(middle));
+				}
+				else
+				{
+					addTransition(getCell(entranceStart), getOtherCell(entranceStart));
+					addTransition(getCell(entranceEnd), getOtherCell(entranceEnd));
+				}
+				entranceStart = invalid_node_index;
+			}
+
+			if (i < length && isConnected[i])
+				entranceStart = i;
+		}
+
+		// 4. Diagonal crossings that can't be replaced by a detour over a straight crossing next to it (squeezing past a corner)
+		for (int i = 0; i < length; ++i)
+		{
+			for (int j : { i - 1, i + 1 })
+			{
+				if (j < 0 || j >= length || GetConnectionCost(getCell(i), getOtherCell(j)) == FLT_MAX)
+					continue;
+
+				const bool hasDetour = (isConnected[j] && GetConnectionCost(getCell(i), getCell(j)) < FLT_MAX)
+					|| (isConnected[i] && GetConnectionCost(getOtherCell(i), getOtherCell(j)) < FLT_MAX);
+				if (!hasDetour)
+					addTransition(getCell(i), getOtherCell(j));
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RecomputeIntraEdges(int clusterIdx)
+	{
+		const vector<int>& nodes = m_ClusterNodes[clusterIdx];
+
+		for (int nodeIdx : nodes)
+		{
+			auto& edges = m_AbstractNodes[nodeIdx].edges;
+			edges.erase(std::remove_if(edges.begin(), edges.end(), [](const AbstractEdge& edge) { return edge.borderIdx == invalid_node_index; }), edges.end());
+		}
+
+		// One search per entrance, reaching all other entrances of the cluster
+		for (int nodeIdx : nodes)
+		{
+			SearchInCluster(m_AbstractNodes[nodeIdx].cellIdx, clusterIdx, invalid_node_index);
+
+			for (int otherNodeIdx : nodes)
+			{
+				const int otherCellIdx = m_AbstractNodes[otherNodeIdx].cellIdx;
+				if (otherNodeIdx != nodeIdx && m_Context.IsVisited(otherCellIdx))
+					m_AbstractNodes[nodeIdx].edges.push_back(AbstractEdge{ otherNodeIdx, m_Context.GetCostSoFar(otherCellIdx), invalid_node_index });
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HPAStar<T_NodeType, T_ConnectionType>::GetOrCreateAbstractNode(int cellIdx)
+	{
+		if (m_AbstractNodeOfCell[cellIdx] != invalid_node_index)
+			return m_AbstractNodeOfCell[cellIdx];
+
+		int nodeIdx;
+		if (!m_FreeAbstractNodes.empty())
+		{
+			nodeIdx = m_FreeAbstractNodes.back();
+			m_FreeAbstractNodes.pop_back();
+		}
+		else
+		{
+			nodeIdx = (int)m_AbstractNodes.size();
+			m_AbstractNodes.push_back(AbstractNode{});
+		}
+
+		AbstractNode& node = m_AbstractNodes[nodeIdx];
+		node.cellIdx = cellIdx;
+		node.clusterIdx = GetClusterIdx(cellIdx);
+		node.edges.clear();
+
+		m_AbstractNodeOfCell[cellIdx] = nodeIdx;
+		m_ClusterNodes[node.clusterIdx].push_back(nodeIdx);
+		return nodeIdx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RemoveAbstractNode(int nodeIdx)
+	{
+		AbstractNode& node = m_AbstractNodes[nodeIdx];
+
+		auto& clusterNodes = m_ClusterNodes[node.clusterIdx];
+		clusterNodes.erase(std::remove(clusterNodes.begin(), clusterNodes.end(), nodeIdx), clusterNodes.end());
+
+		m_AbstractNodeOfCell[node.cellIdx] = invalid_node_index;
+		node.cellIdx = invalid_node_index;
+		node.clusterIdx = invalid_node_index;
+		node.edges.clear();
+
+		m_FreeAbstractNodes.push_back(nodeIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool HPAStar<T_NodeType, T_ConnectionType>::SearchInCluster(int startIdx, int clusterIdx, int goalIdx)
+	{
+		// A* that ignores every connection leaving the cluster, without a goal it turns into Dijkstra over the whole cluster
+		int minCol, minRow, maxCol, maxRow;
+		GetClusterBounds(clusterIdx, minCol, minRow, maxCol, maxRow);
+		const int columns = m_pGridGraph->GetColumns();
+		const GraphCSR& csr = m_pGridGraph->GetCSR();
+
+		m_Context.BeginSearch();
+		m_Context.SetRecord(startIdx, 0.f, invalid_node_index);
+		m_Context.PushOpen(OpenRecord{ startIdx, 0.f, 0.f });
+
+		bool isGoalFound{ false };
+		while (!m_Context.IsOpenListEmpty())
+		{
+			OpenRecord currentRecord = m_Context.PopOpen();
+			if (currentRecord.costSoFar > m_Context.GetCostSoFar(currentRecord.nodeIdx))
+				continue;
+			m_Context.CountExpandedNode();
+
+			if (currentRecord.nodeIdx == goalIdx)
+			{
+				isGoalFound = true;
+				break;
+			}
+
+			for (int i = csr.GetBegin(currentRecord.nodeIdx); i < csr.GetEnd(currentRecord.nodeIdx); ++i)
+			{
+				const int nextIdx = csr.GetNeighbor(i);
+				const int col = nextIdx % columns;
+				const int row = nextIdx / columns;
+				if (col < minCol || col >= maxCol || row < minRow || row >= maxRow)
+					continue;
+
+				const float newGCost{ currentRecord.costSoFar + csr.GetCost(i) };
+				if (newGCost >= m_Context.GetCostSoFar(nextIdx))
+					continue;
+
+				const float hCost = (goalIdx != invalid_node_index) ? GetHeuristicCost(nextIdx, goalIdx) : 0.f;
+				m_Context.SetRecord(nextIdx, newGCost, currentRecord.nodeIdx);
+				m_Context.PushOpen(OpenRecord{ nextIdx, newGCost, newGCost + hCost });
+			}
+		}
+
+		m_Context.EndSearch();
+		return isGoalFound;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const std::vector<int>& HPAStar<T_NodeType, T_ConnectionType>::FindAbstractPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		if (!m_IsBuilt || (int)m_AbstractNodeOfCell.size() != m_pGridGraph->GetNrOfNodes())
+			Build();
+		UpdateDirtyClusters();
+
+		m_AbstractPath.clear();
+		const int startCellIdx = pStartNode->GetIndex();
+		const int goalCellIdx = pGoalNode->GetIndex();
+		const int startClusterIdx = GetClusterIdx(startCellIdx);
+		const int goalClusterIdx = GetClusterIdx(goalCellIdx);
+
+		// Start and goal in the same cluster and connected within it: no need for the abstract graph
+		if (startClusterIdx == goalClusterIdx && SearchInCluster(startCellIdx, startClusterIdx, goalCellIdx))
+		{
+			m_AbstractPath.push_back(startCellIdx);
+			if (goalCellIdx != startCellIdx)
+				m_AbstractPath.push_back(goalCellIdx);
+			return m_AbstractPath;
+		}
+
+		// 1. Temporarily connect start and goal to the entrances of their clusters
+		// The abstract search uses index nrOfNodes for the start and nrOfNodes + 1 for the goal
+		const int nrOfNodes = (int)m_AbstractNodes.size();
+		const int startNodeIdx = nrOfNodes;
+		const int goalNodeIdx = nrOfNodes + 1;
+
+		m_StartEdges.clear();
+		SearchInCluster(startCellIdx, startClusterIdx, invalid_node_index);
+		for (int nodeIdx : m_ClusterNodes[startClusterIdx])
+		{
+			if (m_Context.IsVisited(m_AbstractNodes[nodeIdx].cellIdx))
+				m_StartEdges.push_back(AbstractEdge{ nodeIdx, m_Context.GetCostSoFar(m_AbstractNodes[nodeIdx].cellIdx), invalid_node_index });
+		}
+
+		// Undirected grid: the cost from an entrance to the goal equals the cost from the goal to that entrance
+		m_GoalEdgeCost.assign(nrOfNodes, FLT_MAX);
+		SearchInCluster(goalCellIdx, goalClusterIdx, invalid_node_index);
+		for (int nodeIdx : m_ClusterNodes[goalClusterIdx])
+		{
+			if (m_Context.IsVisited(m_AbstractNodes[nodeIdx].cellIdx))
+				m_GoalEdgeCost[nodeIdx] = m_Context.GetCostSoFar(m_AbstractNodes[nodeIdx].cellIdx);
+		}
+
+		auto getCellIdx = [&](int nodeIdx) { return nodeIdx == startNodeIdx ? startCellIdx : nodeIdx == goalNodeIdx ? goalCellIdx : m_AbstractNodes[nodeIdx].cellIdx; };
+
+		// 2. A* on the abstract graph
+		m_AbstractCostSoFar.assign(nrOfNodes + 2, FLT_MAX);
+		m_AbstractParent.assign(nrOfNodes + 2, invalid_node_index);
+		m_AbstractOpenList.clear();
+
+		auto relax = [&](int fromNodeIdx, int toNodeIdx, float cost)
+		{
+			const float newGCost = m_AbstractCostSoFar[fromNodeIdx] + cost;
+			if (newGCost >= m_AbstractCostSoFar[toNodeIdx])
+				return;
+
+			m_AbstractCostSoFar[toNodeIdx] = newGCost;
+			m_AbstractParent[toNodeIdx] = fromNodeIdx;
+			m_AbstractOpenList.push_back(OpenRecord{ toNodeIdx, newGCost, newGCost + GetHeuristicCost(getCellIdx(toNodeIdx), goalCellIdx) });
+			std::push_heap(m_AbstractOpenList.begin(), m_AbstractOpenList.end(), std::greater<OpenRecord>());
+		};
+
+		m_AbstractCostSoFar[startNodeIdx] = 0.f;
+		m_AbstractOpenList.push_back(OpenRecord{ startNodeIdx, 0.f, GetHeuristicCost(startCellIdx, goalCellIdx) });
+
+		bool isGoalFound{ false };
+		while (!m_AbstractOpenList.empty())
+		{
+			std::pop_heap(m_AbstractOpenList.begin(), m_AbstractOpenList.end(), std::greater<OpenRecord>());
+			OpenRecord currentRecord = m_AbstractOpenList.back();
+			m_AbstractOpenList.pop_back();
+
+			if (currentRecord.costSoFar > m_AbstractCostSoFar[currentRecord.nodeIdx])
+				continue;
+
+			if (currentRecord.nodeIdx == goalNodeIdx)
+			{
+				isGoalFound = true;
+				break;
+			}
+
+			if (currentRecord.nodeIdx == startNodeIdx)
+			{
+				for (const AbstractEdge& edge : m_StartEdges)
+					relax(startNodeIdx, edge.toNode, edge.cost);
+				continue;
+			}
+
+			for (const AbstractEdge& edge : m_AbstractNodes[currentRecord.nodeIdx].edges)
+				relax(currentRecord.nodeIdx, edge.toNode, edge.cost);
+
+			if (m_GoalEdgeCost[currentRecord.nodeIdx] < FLT_MAX)
+				relax(currentRecord.nodeIdx, goalNodeIdx, m_GoalEdgeCost[currentRecord.nodeIdx]);
+		}
+
+		// 3. Abstract path as grid cells, from start to goal
+		if (isGoalFound)
+		{
+			for (int nodeIdx = goalNodeIdx; nodeIdx != invalid_node_index; nodeIdx = m_AbstractParent[nodeIdx])
+			{
+				// The start or goal cell can be an entrance itself, don't list it twice
+				const int cellIdx = getCellIdx(nodeIdx);
+				if (m_AbstractPath.empty() || m_AbstractPath.back() != cellIdx)
+					m_AbstractPath.push_back(cellIdx);
+			}
+			std::reverse(m_AbstractPath.begin(), m_AbstractPath.end());
+		}
+
+		return m_AbstractPath;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RefineSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path)
+	{
+		const int clusterIdx = GetClusterIdx(fromIdx);
+
+		// Inter edge: the cells are neighbors on both sides of a border
+		if (clusterIdx != GetClusterIdx(toIdx))
+		{
+			path.push_back(m_pGridGraph->GetNode(toIdx));
+			return;
+		}
+
+		// Intra edge: redo the search inside the cluster
+		if (!SearchInCluster(fromIdx, clusterIdx, toIdx))
+			return;
+
+		m_Segment.clear();
+		for (int idx = toIdx; idx != fromIdx; idx = m_Context.GetParent(idx))
+			m_Segment.push_back(idx);
+
+		for (auto it = m_Segment.rbegin(); it != m_Segment.rend(); ++it)
+			path.push_back(m_pGridGraph->GetNode(*it));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> HPAStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		vector<T_NodeType*> path;
+
+		const vector<int>& abstractPath = FindAbstractPath(pStartNode, pGoalNode);
+		if (abstractPath.empty())
+			return path;
+
+		path.push_back(pStartNode);
+		for (size_t i = 1; i < abstractPath.size(); ++i)
+			RefineSegment(abstractPath[i - 1], abstractPath[i], path);
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float HPAStar<T_NodeType, T_ConnectionType>::GetConnectionCost(int fromIdx, int toIdx) const
+	{
+		const GraphCSR& csr = m_pGridGraph->GetCSR();
+		for (int i = csr.GetBegin(fromIdx); i < csr.GetEnd(fromIdx); ++i)
+		{
+			if (csr.GetNeighbor(i) == toIdx)
+				return csr.GetCost(i);
+		}
+
+		return FLT_MAX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float HPAStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGridGraph->GetNodePos(toIdx) - m_pGridGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
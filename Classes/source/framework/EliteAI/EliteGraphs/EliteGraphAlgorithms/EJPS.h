@@ -0,0 +1,355 @@
+#pragma once
+#include "EAStar.h"
+
+namespace Elite
+{
+	// Jump Point Search on a uniform-cost, diagonally connected GridGraph
+	// Instead of pushing every neighbor on the open list, it jumps along straight and diagonal lines
+	// and only stops at nodes where the path could change direction (jump points).
+	// A cell is walkable when it has connections, so blocking a cell = removing its connections.
+	// Grids that do not match the layout of GridGraph::InitializeGrid (custom costs, missing connections, ...) fall back to A*.
+	template <class T_NodeType, class T_ConnectionType>
+	class JPS
+	{
+	public:
+		JPS(GridGraph<T_NodeType, T_ConnectionType>* pGridGraph, Heuristic hFunction);
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void SetHeuristicFunction(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+
+		// Uniform straight/diagonal costs, undirected and every walkable neighbor connected (cached until the graph changes)
+		bool IsGridEligible();
+
+		// Statistics of the last query
+		unsigned int GetNrOfExpandedNodes() const { return m_Context.GetNrOfExpandedNodes(); }
+		bool HasUsedFallback() const { return m_HasUsedFallback; }
+
+	private:
+		using OpenRecord = typename SearchContext<T_NodeType, T_ConnectionType>::OpenRecord;
+
+		bool IsWalkable(int col, int row) const { return m_pGridGraph->IsWithinBounds(col, row) && m_IsWalkable[m_pGridGraph->GetIndex(col, row)]; }
+		void AddSuccessors(int idx, int goalIdx);
+		void PushJumpPoint(int fromIdx, int jumpIdx, int goalIdx);
+		int Jump(int col, int row, int dirCol, int dirRow, int goalIdx) const;
+		int JumpStraight(int col, int row, int dirCol, int dirRow, int goalIdx) const;
+		float GetCost(int fromIdx, int toIdx) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGridGraph;
+		Heuristic m_HeuristicFunction;
+		SearchContext<T_NodeType, T_ConnectionType> m_Context;
+
+		vector<bool> m_IsWalkable;
+		bool m_IsEligible = false;
+		bool m_HasCheckedEligibility = false;
+		unsigned int m_CheckedRevision = 0;
+		bool m_HasUsedFallback = false;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	JPS<T_NodeType, T_ConnectionType>::JPS(GridGraph<T_NodeType, T_ConnectionType>* pGridGraph, Heuristic hFunction)
+		: m_pGridGraph(pGridGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_Context(pGridGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool JPS<T_NodeType, T_ConnectionType>::IsGridEligible()
+	{
+		if (m_HasCheckedEligibility && m_CheckedRevision == m_pGridGraph->GetRevision())
+			return m_IsEligible;
+
+		m_HasCheckedEligibility = true;
+		m_CheckedRevision = m_pGridGraph->GetRevision();
+
+		const GraphCSR& csr = m_pGridGraph->GetCSR();
+		const int nrOfNodes = m_pGridGraph->GetNrOfNodes();
+		const float costStraight = m_pGridGraph->GetDefaultCostStraight();
+		const float costDiagonal = m_pGridGraph->GetDefaultCostDiagonal();
+
+		m_IsWalkable.assign(nrOfNodes, false);
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+			m_IsWalkable[idx] = csr.GetBegin(idx) != csr.GetEnd(idx);
+
+		// Pruning the neighbors is only safe when a diagonal step is cheaper than going around (but not cheaper than a straight step)
+		m_IsEligible = m_pGridGraph->IsConnectedDiagonally()
+			&& !m_pGridGraph->IsDirectionalGraph()
+			&& costStraight > 0.f
+			&& costStraight <= costDiagonal && costDiagonal <= 2 * costStraight
+			&& nrOfNodes == m_pGridGraph->GetColumns() * m_pGridGraph->GetRows();
+
+		// Every walkable cell has to be connected to all of its walkable neighbors, at the default cost
+		for (int idx = 0; m_IsEligible && idx < nrOfNodes; ++idx)
+		{
+			if (!m_IsWalkable[idx])
+				continue;
+
+			const int col = idx % m_pGridGraph->GetColumns();
+			const int row = idx / m_pGridGraph->GetColumns();
+
+			int nrOfWalkableNeighbors = 0;
+			for (int dirRow = -1; dirRow <= 1; ++dirRow)
+			{
+				for (int dirCol = -1; dirCol <= 1; ++dirCol)
+				{
+					if ((dirCol != 0 || dirRow != 0) && IsWalkable(col + dirCol, row + dirRow))
+						++nrOfWalkableNeighbors;
+				}
+			}
+
+			if (csr.GetEnd(idx) - csr.GetBegin(idx) != nrOfWalkableNeighbors)
+			{
+				m_IsEligible = false;
+				break;
+			}
+
+			for (int i = csr.GetBegin(idx); i < csr.GetEnd(idx); ++i)
+			{
+				const int neighborIdx = csr.GetNeighbor(i);
+				const int deltaCol = abs(neighborIdx % m_pGridGraph->GetColumns() - col);
+				const int deltaRow = abs(neighborIdx / m_pGridGraph->GetColumns() - row);
+				const float expectedCost = (deltaCol == 1 && deltaRow == 1) ? costDiagonal : costStraight;
+
+				if (deltaCol > 1 || deltaRow > 1 || abs(csr.GetCost(i) - expectedCost) > 0.0001f)
+				{
+					m_IsEligible = false;
+					break;
+				}
+			}
+		}
+
+		return m_IsEligible;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JPS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		vector<T_NodeType*> path;
+
+		// Not a uniform grid: plain A* gives the same result
+		m_HasUsedFallback = !IsGridEligible();
+		if (m_HasUsedFallback)
+		{
+			AStar<T_NodeType, T_ConnectionType> pathfinder{ m_pGridGraph, m_HeuristicFunction };
+			pathfinder.SetUseCSR(true);
+			path = pathfinder.FindPath(pStartNode, pGoalNode, m_Context);
+			return path;
+		}
+
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		// A blocked start node can not go anywhere, just like it has no connections for A*
+		if (!m_IsWalkable[startIdx] && startIdx != goalIdx)
+			return path;
+
+		// 1. Same loop as the binary heap A*, except that the successors of a node are its jump points
+		m_Context.BeginSearch();
+		m_Context.SetRecord(startIdx, 0.f, invalid_node_index);
+		m_Context.PushOpen(OpenRecord{ startIdx, 0.f, GetHeuristicCost(startIdx, goalIdx) });
+
+		bool isGoalFound{ false };
+		while (!m_Context.IsOpenListEmpty())
+		{
+			OpenRecord currentRecord = m_Context.PopOpen();
+
+			// 2.A Skip records that got replaced by a cheaper connection after they were pushed
+			if (currentRecord.costSoFar > m_Context.GetCostSoFar(currentRecord.nodeIdx))
+				continue;
+			m_Context.CountExpandedNode();
+
+			// 2.B If endnode was found, stop
+			if (currentRecord.nodeIdx == goalIdx)
+			{
+				isGoalFound = true;
+				break;
+			}
+
+			// 2.C Else, jump in every direction that is not pruned
+			AddSuccessors(currentRecord.nodeIdx, goalIdx);
+		}
+
+		// 3. Reconstruct the path: fill in the cells on the straight/diagonal line between 2 jump points
+		if (isGoalFound)
+		{
+			const int columns = m_pGridGraph->GetColumns();
+			int currentIdx = goalIdx;
+			while (currentIdx != startIdx)
+			{
+				const int parentIdx = m_Context.GetParent(currentIdx);
+				const int dirCol = (parentIdx % columns > currentIdx % columns) - (parentIdx % columns < currentIdx % columns);
+				const int dirRow = (parentIdx / columns > currentIdx / columns) - (parentIdx / columns < currentIdx / columns);
+
+				for (int idx = currentIdx; idx != parentIdx; idx += dirRow * columns + dirCol)
+					path.push_back(m_pGridGraph->GetNode(idx));
+
+				currentIdx = parentIdx;
+			}
+
+			// Add start node
+			path.push_back(pStartNode);
+
+			// Reverse path
+			std::reverse(path.begin(), path.end());
+		}
+
+		m_Context.EndSearch();
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JPS<T_NodeType, T_ConnectionType>::AddSuccessors(int idx, int goalIdx)
+	{
+		const int columns = m_pGridGraph->GetColumns();
+		const int col = idx % columns;
+		const int row = idx / columns;
+		const int parentIdx = m_Context.GetParent(idx);
+
+		// Start node: look in all directions
+		if (parentIdx == invalid_node_index)
+		{
+			for (int dirRow = -1; dirRow <= 1; ++dirRow)
+			{
+				for (int dirCol = -1; dirCol <= 1; ++dirCol)
+				{
+					if (dirCol != 0 || dirRow != 0)
+						PushJumpPoint(idx, Jump(col, row, dirCol, dirRow, goalIdx), goalIdx);
+				}
+			}
+			return;
+		}
+
+		// Direction we are travelling in
+		const int dirCol = (col > parentIdx % columns) - (col < parentIdx % columns);
+		const int dirRow = (row > parentIdx / columns) - (row < parentIdx / columns);
+
+		if (dirCol != 0 && dirRow != 0)
+		{
+			// Diagonal: natural neighbors
+			PushJumpPoint(idx, Jump(col, row, dirCol, 0, goalIdx), goalIdx);
+			PushJumpPoint(idx, Jump(col, row, 0, dirRow, goalIdx), goalIdx);
+			PushJumpPoint(idx, Jump(col, row, dirCol, dirRow, goalIdx), goalIdx);
+
+			// Forced neighbors
+			if (!IsWalkable(col - dirCol, row))
+				PushJumpPoint(idx, Jump(col, row, -dirCol, dirRow, goalIdx), goalIdx);
+			if (!IsWalkable(col, row - dirRow))
+				PushJumpPoint(idx, Jump(col, row, dirCol, -dirRow, goalIdx), goalIdx);
+		}
+		else if (dirCol != 0)
+		{
+			// Horizontal
+			PushJumpPoint(idx, Jump(col, row, dirCol, 0, goalIdx), goalIdx);
+			if (!IsWalkable(col, row + 1))
+				PushJumpPoint(idx, Jump(col, row, dirCol, 1, goalIdx), goalIdx);
+			if (!IsWalkable(col, row - 1))
+				PushJumpPoint(idx, Jump(col, row, dirCol, -1, goalIdx), goalIdx);
+		}
+		else
+		{
+			// Vertical
+			PushJumpPoint(idx, Jump(col, row, 0, dirRow, goalIdx), goalIdx);
+			if (!IsWalkable(col + 1, row))
+				PushJumpPoint(idx, Jump(col, row, 1, dirRow, goalIdx), goalIdx);
+			if (!IsWalkable(col - 1, row))
+				PushJumpPoint(idx, Jump(col, row, -1, dirRow, goalIdx), goalIdx);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JPS<T_NodeType, T_ConnectionType>::PushJumpPoint(int fromIdx, int jumpIdx, int goalIdx)
+	{
+		if (jumpIdx == invalid_node_index)
+			return;
+
+		const float newGCost{ m_Context.GetCostSoFar(fromIdx) + GetCost(fromIdx, jumpIdx) };
+		if (newGCost >= m_Context.GetCostSoFar(jumpIdx))
+			return;
+
+		m_Context.SetRecord(jumpIdx, newGCost, fromIdx);
+		m_Context.PushOpen(OpenRecord{ jumpIdx, newGCost, newGCost + GetHeuristicCost(jumpIdx, goalIdx) });
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::Jump(int col, int row, int dirCol, int dirRow, int goalIdx) const
+	{
+		if (dirCol == 0 || dirRow == 0)
+			return JumpStraight(col, row, dirCol, dirRow, goalIdx);
+
+		// Diagonal: step until a blocked cell, the goal, a forced neighbor
+		// or a cell from where a straight jump finds something
+		while (true)
+		{
+			col += dirCol;
+			row += dirRow;
+
+			if (!IsWalkable(col, row))
+				return invalid_node_index;
+
+			const int idx = m_pGridGraph->GetIndex(col, row);
+			if (idx == goalIdx)
+				return idx;
+
+			if ((IsWalkable(col - dirCol, row + dirRow) && !IsWalkable(col - dirCol, row))
+				|| (IsWalkable(col + dirCol, row - dirRow) && !IsWalkable(col, row - dirRow)))
+				return idx;
+
+			if (JumpStraight(col, row, dirCol, 0, goalIdx) != invalid_node_index
+				|| JumpStraight(col, row, 0, dirRow, goalIdx) != invalid_node_index)
+				return idx;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::JumpStraight(int col, int row, int dirCol, int dirRow, int goalIdx) const
+	{
+		// Straight: step until a blocked cell, the goal or a forced neighbor
+		while (true)
+		{
+			col += dirCol;
+			row += dirRow;
+
+			if (!IsWalkable(col, row))
+				return invalid_node_index;
+
+			const int idx = m_pGridGraph->GetIndex(col, row);
+			if (idx == goalIdx)
+				return idx;
+
+			if (dirCol != 0)
+			{
+				if ((IsWalkable(col + dirCol, row + 1) && !IsWalkable(col, row + 1))
+					|| (IsWalkable(col + dirCol, row - 1) && !IsWalkable(col, row - 1)))
+					return idx;
+			}
+			else
+			{
+				if ((IsWalkable(col + 1, row + dirRow) && !IsWalkable(col + 1, row))
+					|| (IsWalkable(col - 1, row + dirRow) && !IsWalkable(col - 1, row)))
+					return idx;
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float JPS<T_NodeType, T_ConnectionType>::GetCost(int fromIdx, int toIdx) const
+	{
+		// Jump points are always on a straight or diagonal line from each other
+		const int columns = m_pGridGraph->GetColumns();
+		const int deltaCol = abs(toIdx % columns - fromIdx % columns);
+		const int deltaRow = abs(toIdx / columns - fromIdx / columns);
+		const int nrOfDiagonalSteps = (deltaCol < deltaRow) ? deltaCol : deltaRow;
+		const int nrOfStraightSteps = abs(deltaCol - deltaRow);
+
+		return nrOfDiagonalSteps * m_pGridGraph->GetDefaultCostDiagonal() + nrOfStraightSteps * m_pGridGraph->GetDefaultCostStraight();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float JPS<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGridGraph->GetNodePos(toIdx) - m_pGridGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
@@ -0,0 +1,378 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <deque>
+#include <memory>
+#include "ESearchContext.h"
+
+namespace Elite
+{
+	// Frozen copy of the connections and node positions of a graph, can be read from any thread
+	struct GraphSnapshot
+	{
+		GraphCSR csr;
+		vector<Vector2> nodePositions;
+		unsigned int revision = 0;
+	};
+
+	// Asynchronous path requests, solved by a pool of worker threads with A* on a GraphSnapshot
+	// Everything but the search itself happens on the update thread:
+	// - Submit queues a request, a request with the same start and goal as an unfinished one just waits for that one
+	// - Update, once per frame, refreshes the snapshot when the graph changed, hands at most the dispatch budget of
+	//   requests to the workers and delivers finished paths until the delivery budget is used up
+	// Callbacks and futures are only completed inside Update, so agents get their new paths at a frame boundary.
+	// A path is solved on the snapshot taken before it was dispatched, it does not see later changes to the graph.
+	template <class T_NodeType, class T_ConnectionType>
+	class PathRequestQueue
+	{
+	public:
+		using Callback = std::function<void(const std::vector<T_NodeType*>& path)>;
+
+		// Without workers the dispatched requests are solved on the update thread, inside Update
+		PathRequestQueue(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int nrOfWorkers = GetDefaultNrOfWorkers());
+		~PathRequestQueue();
+
+		void Submit(T_NodeType* pStartNode, T_NodeType* pDestinationNode, Callback callback);
+		std::future<std::vector<T_NodeType*>> Submit(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void Update();
+
+		// Budgets of a single Update call
+		void SetMaxDispatchesPerFrame(int maxDispatches) { m_MaxDispatchesPerFrame = maxDispatches; }
+		void SetMaxDeliveryTimePerFrame(float maxDeliveryTimeMs) { m_MaxDeliveryTimePerFrame = maxDeliveryTimeMs; }
+		void SetHeuristicFunction(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+
+		// Statistics
+		int GetNrOfPendingRequests() const { return (int)m_PendingRequests.size(); } // not dispatched yet
+		int GetNrOfUnfinishedRequests() const { return (int)m_UnfinishedRequests.size(); } // not delivered yet, includes the pending ones
+		unsigned int GetNrOfSubmittedRequests() const { return m_NrOfSubmittedRequests; }
+		unsigned int GetNrOfMergedRequests() const { return m_NrOfMergedRequests; } // submitted while an identical one was unfinished
+		unsigned int GetNrOfSolvedRequests() const { return m_NrOfSolvedRequests; }
+		int GetNrOfWorkers() const { return (int)m_Workers.size(); }
+
+		static int GetDefaultNrOfWorkers();
+
+	private:
+		struct Request
+		{
+			int startIdx = invalid_node_index;
+			int goalIdx = invalid_node_index;
+			Heuristic heuristicFunction = nullptr;
+			std::shared_ptr<const GraphSnapshot> pSnapshot = nullptr;
+
+			// Everyone waiting for this path
+			vector<Callback> callbacks;
+			vector<std::promise<std::vector<T_NodeType*>>> promises;
+
+			// Written by the worker that solves it
+			vector<int> path;
+		};
+
+		// Unfinished requests are keyed on start and goal, for the deduplication
+		using RequestKey = unsigned long long;
+		static RequestKey GetRequestKey(int startIdx, int goalIdx) { return ((RequestKey)(unsigned int)startIdx << 32) | (unsigned int)goalIdx; }
+
+		Request& GetOrCreateRequest(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		void RefreshSnapshot();
+		void Deliver(Request& request);
+		void WorkerLoop();
+		static void SolveRequest(Request& request, SearchContext<T_NodeType, T_ConnectionType>& context);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		std::shared_ptr<const GraphSnapshot> m_pSnapshot = nullptr;
+
+		// Update thread only
+		std::unordered_map<RequestKey, std::shared_ptr<Request>> m_UnfinishedRequests;
+		std::deque<std::shared_ptr<Request>> m_PendingRequests;
+		SearchContext<T_NodeType, T_ConnectionType> m_Context; // solves requests when there are no workers
+
+		// Shared with the workers, guarded by m_Mutex
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkAvailable;
+		std::deque<std::shared_ptr<Request>> m_DispatchedRequests;
+		vector<std::shared_ptr<Request>> m_SolvedRequests;
+		bool m_IsShuttingDown = false;
+		vector<std::thread> m_Workers;
+
+		int m_MaxDispatchesPerFrame = 64;
+		float m_MaxDeliveryTimePerFrame = 1.f;
+
+		unsigned int m_NrOfSubmittedRequests = 0;
+		unsigned int m_NrOfMergedRequests = 0;
+		unsigned int m_NrOfSolvedRequests = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRequestQueue<T_NodeType, T_ConnectionType>::PathRequestQueue(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int nrOfWorkers)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_Context(pGraph)
+	{
+		for (int i = 0; i < nrOfWorkers; ++i)
+			m_Workers.push_back(std::thread(&PathRequestQueue::WorkerLoop, this));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRequestQueue<T_NodeType, T_ConnectionType>::~PathRequestQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsShuttingDown = true;
+		}
+		m_WorkAvailable.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int PathRequestQueue<T_NodeType, T_ConnectionType>::GetDefaultNrOfWorkers()
+	{
+		// Leave a core for the update thread
+		const int nrOfCores = (int)std::thread::hardware_concurrency();
+		return nrOfCores > 1 ? nrOfCores - 1 : 1;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::Submit(T_NodeType* pStartNode, T_NodeType* pDestinationNode, Callback callback)
+	{
+		GetOrCreateRequest(pStartNode, pDestinationNode).callbacks.push_back(callback);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::future<std::vector<T_NodeType*>> PathRequestQueue<T_NodeType, T_ConnectionType>::Submit(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	{
+		Request& request = GetOrCreateRequest(pStartNode, pDestinationNode);
+		request.promises.push_back(std::promise<std::vector<T_NodeType*>>{});
+		return request.promises.back().get_future();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename PathRequestQueue<T_NodeType, T_ConnectionType>::Request& PathRequestQueue<T_NodeType, T_ConnectionType>::GetOrCreateRequest(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	{
+		++m_NrOfSubmittedRequests;
+
+		// The workers never touch the waiting callbacks and promises, so merging into a dispatched request is fine too
+		const RequestKey key = GetRequestKey(pStartNode->GetIndex(), pDestinationNode->GetIndex());
+		auto foundIt = m_UnfinishedRequests.find(key);
+		if (foundIt != m_UnfinishedRequests.end())
+		{
+			++m_NrOfMergedRequests;
+			return *foundIt->second;
+		}
+
+		auto pRequest = std::make_shared<Request>();
+		pRequest->startIdx = pStartNode->GetIndex();
+		pRequest->goalIdx = pDestinationNode->GetIndex();
+
+		m_UnfinishedRequests[key] = pRequest;
+		m_PendingRequests.push_back(pRequest);
+		return *pRequest;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::Update()
+	{
+		// 1. Hand out pending requests, up to the budget
+		if (!m_PendingRequests.empty())
+		{
+			RefreshSnapshot();
+
+			vector<std::shared_ptr<Request>> dispatched{};
+			while (!m_PendingRequests.empty() && (int)dispatched.size() < m_MaxDispatchesPerFrame)
+			{
+				auto pRequest = m_PendingRequests.front();
+				m_PendingRequests.pop_front();
+
+				pRequest->pSnapshot = m_pSnapshot;
+				pRequest->heuristicFunction = m_HeuristicFunction;
+				dispatched.push_back(pRequest);
+			}
+
+			if (m_Workers.empty())
+			{
+				for (auto& pRequest : dispatched)
+					SolveRequest(*pRequest, m_Context);
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_SolvedRequests.insert(m_SolvedRequests.end(), dispatched.begin(), dispatched.end());
+			}
+			else
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_DispatchedRequests.insert(m_DispatchedRequests.end(), dispatched.begin(), dispatched.end());
+				}
+				m_WorkAvailable.notify_all();
+			}
+		}
+
+		// 2. Deliver solved requests until the time budget runs out, the rest waits for the next frame
+		vector<std::shared_ptr<Request>> solved{};
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			solved.swap(m_SolvedRequests);
+		}
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		size_t nrOfDelivered = 0;
+		while (nrOfDelivered < solved.size())
+		{
+			Deliver(*solved[nrOfDelivered++]);
+
+			const auto now = std::chrono::high_resolution_clock::now();
+			if (std::chrono::duration<float, std::milli>(now - start).count() >= m_MaxDeliveryTimePerFrame)
+				break;
+		}
+
+		if (nrOfDelivered < solved.size())
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_SolvedRequests.insert(m_SolvedRequests.begin(), solved.begin() + nrOfDelivered, solved.end());
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::RefreshSnapshot()
+	{
+		if (m_pSnapshot && m_pSnapshot->revision == m_pGraph->GetRevision())
+			return;
+
+		// Requests in flight keep the old snapshot alive until they are done with it
+		auto pSnapshot = std::make_shared<GraphSnapshot>();
+		pSnapshot->csr = m_pGraph->GetCSR();
+		pSnapshot->revision = m_pGraph->GetRevision();
+		pSnapshot->nodePositions.resize(m_pGraph->GetNrOfNodes());
+		for (int idx = 0; idx < m_pGraph->GetNrOfNodes(); ++idx)
+		{
+			if (m_pGraph->IsNodeValid(idx))
+				pSnapshot->nodePositions[idx] = m_pGraph->GetNodePos(idx);
+		}
+
+		m_pSnapshot = pSnapshot;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::Deliver(Request& request)
+	{
+		// When the graph changed since the snapshot was taken, a node on the path can be removed, or replaced by another node
+		// at the same index, and a step can be disconnected: only hand out the path when all of it is still there
+		const GraphSnapshot& snapshot = *request.pSnapshot;
+		const bool isGraphModified = snapshot.revision != m_pGraph->GetRevision();
+
+		vector<T_NodeType*> path{};
+		path.reserve(request.path.size());
+		for (size_t i = 0; i < request.path.size(); ++i)
+		{
+			const int idx = request.path[i];
+			bool isStale = !m_pGraph->IsNodeValid(idx) || m_pGraph->GetNode(idx)->GetIndex() != idx;
+			if (!isStale && isGraphModified)
+			{
+				isStale = m_pGraph->GetNodePos(idx) != snapshot.nodePositions[idx]
+					|| (i > 0 && m_pGraph->GetConnection(request.path[i - 1], idx) == nullptr);
+			}
+
+			if (isStale)
+			{
+				path.clear();
+				break;
+			}
+			path.push_back(m_pGraph->GetNode(idx));
+		}
+
+		m_UnfinishedRequests.erase(GetRequestKey(request.startIdx, request.goalIdx));
+		++m_NrOfSolvedRequests;
+
+		for (auto& callback : request.callbacks)
+			callback(path);
+		for (auto& promise : request.promises)
+			promise.set_value(path);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::WorkerLoop()
+	{
+		// Every worker has its own scratch memory, it never touches the graph itself
+		SearchContext<T_NodeType, T_ConnectionType> context{ nullptr };
+
+		while (true)
+		{
+			std::shared_ptr<Request> pRequest{};
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WorkAvailable.wait(lock, [this]() { return m_IsShuttingDown || !m_DispatchedRequests.empty(); });
+				if (m_IsShuttingDown)
+					return;
+
+				pRequest = m_DispatchedRequests.front();
+				m_DispatchedRequests.pop_front();
+			}
+
+			SolveRequest(*pRequest, context);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_SolvedRequests.push_back(pRequest);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::SolveRequest(Request& request, SearchContext<T_NodeType, T_ConnectionType>& context)
+	{
+		// Binary heap A* with lazy deletion, the same search as AStar::FindPath with a SearchContext, on the snapshot
+		using OpenRecord = typename SearchContext<T_NodeType, T_ConnectionType>::OpenRecord;
+
+		const GraphSnapshot& snapshot = *request.pSnapshot;
+		const int nrOfNodes = snapshot.csr.GetNrOfNodes();
+		request.path.clear();
+		if (request.startIdx < 0 || request.startIdx >= nrOfNodes || request.goalIdx < 0 || request.goalIdx >= nrOfNodes)
+			return;
+
+		auto getHeuristicCost = [&](int idx)
+		{
+			Vector2 toDestination = snapshot.nodePositions[request.goalIdx] - snapshot.nodePositions[idx];
+			return request.heuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		};
+
+		context.BeginSearch(nrOfNodes);
+		context.SetRecord(request.startIdx, 0.f, invalid_node_index);
+		context.PushOpen(OpenRecord{ request.startIdx, 0.f, getHeuristicCost(request.startIdx) });
+
+		bool isGoalFound{ false };
+		while (!context.IsOpenListEmpty())
+		{
+			OpenRecord currentRecord = context.PopOpen();
+			if (currentRecord.costSoFar > context.GetCostSoFar(currentRecord.nodeIdx))
+				continue;
+			context.CountExpandedNode();
+
+			if (currentRecord.nodeIdx == request.goalIdx)
+			{
+				isGoalFound = true;
+				break;
+			}
+
+			for (int i = snapshot.csr.GetBegin(currentRecord.nodeIdx); i < snapshot.csr.GetEnd(currentRecord.nodeIdx); ++i)
+			{
+				const int nextIdx = snapshot.csr.GetNeighbor(i);
+				const float newGCost{ currentRecord.costSoFar + snapshot.csr.GetCost(i) };
+				if (newGCost >= context.GetCostSoFar(nextIdx))
+					continue;
+
+				context.SetRecord(nextIdx, newGCost, currentRecord.nodeIdx);
+				context.PushOpen(OpenRecord{ nextIdx, newGCost, newGCost + getHeuristicCost(nextIdx) });
+			}
+		}
+
+		if (isGoalFound)
+		{
+			for (int idx = request.goalIdx; idx != invalid_node_index; idx = context.GetParent(idx))
+				request.path.push_back(idx);
+			std::reverse(request.path.begin(), request.path.end());
+		}
+
+		context.EndSearch();
+	}
+}
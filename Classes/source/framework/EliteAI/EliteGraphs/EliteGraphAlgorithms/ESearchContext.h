@@ -0,0 +1,196 @@
+/*=============================================================================*/
+// ESearchContext.h: per-graph scratch memory of the graph searches, reused between queries.
+/*=============================================================================*/
+#pragma once
+
+namespace Elite
+{
+	// Scratch memory for the graph searches (AStar, BFS), sized to IGraph::GetNrOfNodes()
+	// Keep one around per graph and pass it to FindPath: every buffer keeps its capacity between queries,
+	// so once the buffers are warmed up a query does not allocate anymore.
+	// Node records are stamped with the generation of the search that wrote them,
+	// which means "clearing" all records at the start of a query is a single increment.
+	template <class T_NodeType, class T_ConnectionType>
+	class SearchContext
+	{
+	public:
+		// per-node record, only valid when generation matches the current search
+		struct NodeRecord
+		{
+			unsigned int generation = 0;
+			float costSoFar = 0.f; // g-cost
+			int parentIdx = invalid_node_index; // node this node was reached from
+		};
+
+		// entry of the open list, ordered on the f-cost
+		struct OpenRecord
+		{
+			int nodeIdx = invalid_node_index;
+			float costSoFar = 0.f;
+			float estimatedTotalCost = 0.f;
+
+			bool operator>(const OpenRecord& other) const
+			{
+				return estimatedTotalCost > other.estimatedTotalCost;
+			}
+		};
+
+		explicit SearchContext(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Invalidates all records of the previous search and makes sure there is a record for every node
+		void BeginSearch();
+		// Same, for searches that don't go through the graph itself (e.g. on a GraphSnapshot from another thread)
+		void BeginSearch(int nrOfNodes);
+		// Updates the allocation counter, call when the query is done with the buffers
+		void EndSearch();
+
+		bool IsVisited(int idx) const { return m_Records[idx].generation == m_Generation; }
+		float GetCostSoFar(int idx) const { return IsVisited(idx) ? m_Records[idx].costSoFar : FLT_MAX; }
+		int GetParent(int idx) const { return IsVisited(idx) ? m_Records[idx].parentIdx : invalid_node_index; }
+		void SetRecord(int idx, float costSoFar, int parentIdx);
+
+		// open list as a binary min-heap, backed by a vector that keeps its capacity
+		bool IsOpenListEmpty() const { return m_OpenList.empty(); }
+		void PushOpen(const OpenRecord& record);
+		OpenRecord PopOpen();
+
+		// FIFO queue for breadth first searches
+		bool IsQueueEmpty() const { return m_QueueFront == m_Queue.size(); }
+		void PushQueue(int idx) { m_Queue.push_back(idx); }
+		int PopQueue() { return m_Queue[m_QueueFront++]; }
+
+		// Rebuilds the path by following the stored parents back from the goal
+		const std::vector<T_NodeType*>& BuildPath(int startIdx, int goalIdx);
+		const std::vector<T_NodeType*>& GetPath() const { return m_Path; }
+		void ClearPath() { m_Path.clear(); }
+
+		IGraph<T_NodeType, T_ConnectionType>* GetGraph() const { return m_pGraph; }
+
+		// Statistics
+		void CountExpandedNode() { ++m_NrOfExpandedNodes; }
+		unsigned int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; } // of the last query
+		unsigned int GetNrOfQueries() const { return m_NrOfQueries; }
+		unsigned int GetNrOfAllocations() const { return m_NrOfAllocations; } // times any of the buffers had to grow
+		void ResetCounters() { m_NrOfQueries = 0; m_NrOfAllocations = 0; }
+
+	private:
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		unsigned int m_Generation = 0;
+
+		vector<NodeRecord> m_Records;
+		vector<OpenRecord> m_OpenList;
+		vector<int> m_Queue;
+		size_t m_QueueFront = 0;
+		vector<T_NodeType*> m_Path;
+
+		// capacities seen at the end of the previous query, used to count reallocations
+		size_t m_RecordsCapacity = 0;
+		size_t m_OpenListCapacity = 0;
+		size_t m_QueueCapacity = 0;
+		size_t m_PathCapacity = 0;
+
+		unsigned int m_NrOfExpandedNodes = 0;
+		unsigned int m_NrOfQueries = 0;
+		unsigned int m_NrOfAllocations = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	SearchContext<T_NodeType, T_ConnectionType>::SearchContext(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SearchContext<T_NodeType, T_ConnectionType>::BeginSearch()
+	{
+		BeginSearch(m_pGraph->GetNrOfNodes());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SearchContext<T_NodeType, T_ConnectionType>::BeginSearch(int nrOfNodes)
+	{
+		// The graph might have grown since the last query
+		if ((int)m_Records.size() < nrOfNodes)
+			m_Records.resize(nrOfNodes);
+
+		// When the generation wraps around, old stamps could become valid again: wipe them
+		if (++m_Generation == 0)
+		{
+			for (auto& record : m_Records)
+				record.generation = 0;
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+		m_Queue.clear();
+		m_QueueFront = 0;
+		m_Path.clear();
+		m_NrOfExpandedNodes = 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SearchContext<T_NodeType, T_ConnectionType>::EndSearch()
+	{
+		auto countGrowth = [this](size_t& lastCapacity, size_t capacity)
+		{
+			if (capacity != lastCapacity)
+			{
+				++m_NrOfAllocations;
+				lastCapacity = capacity;
+			}
+		};
+
+		countGrowth(m_RecordsCapacity, m_Records.capacity());
+		countGrowth(m_OpenListCapacity, m_OpenList.capacity());
+		countGrowth(m_QueueCapacity, m_Queue.capacity());
+		countGrowth(m_PathCapacity, m_Path.capacity());
+
+		++m_NrOfQueries;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SearchContext<T_NodeType, T_ConnectionType>::SetRecord(int idx, float costSoFar, int parentIdx)
+	{
+		NodeRecord& record = m_Records[idx];
+		record.generation = m_Generation;
+		record.costSoFar = costSoFar;
+		record.parentIdx = parentIdx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SearchContext<T_NodeType, T_ConnectionType>::PushOpen(const OpenRecord& record)
+	{
+		m_OpenList.push_back(record);
+		std::push_heap(m_OpenList.begin(), m_OpenList.end(), std::greater<OpenRecord>());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename SearchContext<T_NodeType, T_ConnectionType>::OpenRecord SearchContext<T_NodeType, T_ConnectionType>::PopOpen()
+	{
+		std::pop_heap(m_OpenList.begin(), m_OpenList.end(), std::greater<OpenRecord>());
+		OpenRecord record = m_OpenList.back();
+		m_OpenList.pop_back();
+		return record;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const std::vector<T_NodeType*>& SearchContext<T_NodeType, T_ConnectionType>::BuildPath(int startIdx, int goalIdx)
+	{
+		m_Path.clear();
+
+		int currentIdx = goalIdx;
+		while (currentIdx != startIdx)
+		{
+			m_Path.push_back(m_pGraph->GetNode(currentIdx));
+			currentIdx = m_Records[currentIdx].parentIdx;
+		}
+
+		// Add start node
+		m_Path.push_back(m_pGraph->GetNode(startIdx));
+
+		// Reverse path
+		std::reverse(m_Path.begin(), m_Path.end());
+
+		return m_Path;
+	}
+}
@@ -58,6 +58,7 @@ bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>
 				pGraph->AddConnectionsToAdjacentCells(idx);
 				break;
 			}
+			m_LastChangedNodeIdx = idx;
 			return true;
 		}
 	}
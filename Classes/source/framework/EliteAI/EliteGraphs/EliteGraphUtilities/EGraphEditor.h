@@ -21,8 +21,12 @@ namespace Elite
 		template <class T_NodeType, class T_ConnectionType>
 		bool UpdateGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
 
+		// Grid node whose connections were changed by the last UpdateGraph call that returned true
+		int GetLastChangedNodeIdx() const { return m_LastChangedNodeIdx; }
+
 	private:
 		int m_SelectedNodeIdx = -1;
+		int m_LastChangedNodeIdx = -1;
 		int m_SelectedTerrainType = (int)TerrainType::Ground;
 
 		Elite::Vector2 m_MousePos;
@@ -116,6 +120,7 @@ namespace Elite
 			if (idx != invalid_node_index)
 			{
 				pGraph->AddConnectionsToAdjacentCells(idx);
+				m_LastChangedNodeIdx = idx;
 				hasGraphChanged = true;
 			}
 		}
@@ -128,6 +133,7 @@ namespace Elite
 			if (idx != invalid_node_index)
 			{
 				pGraph->RemoveConnectionsToAdjacentNodes(idx);
+				m_LastChangedNodeIdx = idx;
 				hasGraphChanged = true;
 			}
 		}
@@ -4,16 +4,137 @@
 #include "framework/EliteMath/EMath.h"
 #include "framework\EliteAI\EliteGraphs\ENavGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ESearchContext.h"
 
 namespace Elite
 {
 	class NavMeshPathfinding
 	{
 	public:
+		// Start and end are virtual nodes on top of the base graph, they only exist during the search
+		// The graph itself is left untouched, the search only needs the scratch memory of the context
+		static std::vector<Elite::Vector2> FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos, Elite::NavGraph* pNavGraph, SearchContext<NavGraphNode, GraphConnection2D>& context, std::vector<Elite::Vector2>& debugNodePositions, std::vector<Elite::Portal>& debugPortals)
+		{
+			using OpenRecord = SearchContext<NavGraphNode, GraphConnection2D>::OpenRecord;
+
+			//Create the path to return
+			std::vector<Elite::Vector2> finalPath{};
+
+			//Get the start and endTriangle, with the nodes on their lines
+			//Virtual connections: from the start node to the nodes on the lines of the first triangle,
+			//from the nodes on the lines of the last triangle to the end node
+			std::array<int, 3> startConnections{}, endConnections{};
+			const Triangle* pFirstTriangle = pNavGraph->GetTriangleFromPosition(startPos, startConnections);
+			const Triangle* pLastTriangle = pNavGraph->GetTriangleFromPosition(endPos, endConnections);
+			if (!(pFirstTriangle && pLastTriangle)) return finalPath;
+			if (pFirstTriangle == pLastTriangle)
+			{
+				finalPath.push_back(endPos);
+				return finalPath;
+			}
+
+			//The virtual nodes get the first indices after the graph
+			const int nrOfNodes = pNavGraph->GetNrOfNodes();
+			const int startIdx = nrOfNodes;
+			const int endIdx = nrOfNodes + 1;
+			NavGraphNode startNode{ startIdx, -1, startPos };
+			NavGraphNode endNode{ endIdx, -1, endPos };
+
+			auto getPosition = [&](int idx) { return idx == startIdx ? startPos : idx == endIdx ? endPos : pNavGraph->GetNodePos(idx); };
+			auto getHeuristicCost = [&](int idx)
+			{
+				Vector2 toDestination = endPos - getPosition(idx);
+				return HeuristicFunctions::Euclidean(abs(toDestination.x), abs(toDestination.y));
+			};
+
+			//Run A star on the base graph + the virtual nodes
+			const GraphCSR& csr = pNavGraph->GetCSR();
+			context.BeginSearch(nrOfNodes + 2);
+			context.SetRecord(startIdx, 0.f, invalid_node_index);
+			context.PushOpen(OpenRecord{ startIdx, 0.f, getHeuristicCost(startIdx) });
+
+			bool isGoalFound{ false };
+			while (!context.IsOpenListEmpty())
+			{
+				OpenRecord currentRecord = context.PopOpen();
+				if (currentRecord.costSoFar > context.GetCostSoFar(currentRecord.nodeIdx))
+					continue;
+				context.CountExpandedNode();
+
+				if (currentRecord.nodeIdx == endIdx)
+				{
+					isGoalFound = true;
+					break;
+				}
+
+				auto visitConnection = [&](int nextIdx, float connectionCost)
+				{
+					const float newGCost{ currentRecord.costSoFar + connectionCost };
+					if (newGCost >= context.GetCostSoFar(nextIdx))
+						return;
+
+					context.SetRecord(nextIdx, newGCost, currentRecord.nodeIdx);
+					context.PushOpen(OpenRecord{ nextIdx, newGCost, newGCost + getHeuristicCost(nextIdx) });
+				};
+
+				if (currentRecord.nodeIdx == startIdx)
+				{
+					for (int nodeIdx : startConnections)
+					{
+						if (nodeIdx != invalid_node_index)
+							visitConnection(nodeIdx, Elite::Distance(startPos, pNavGraph->GetNodePos(nodeIdx)));
+					}
+					continue;
+				}
+
+				for (int i = csr.GetBegin(currentRecord.nodeIdx); i < csr.GetEnd(currentRecord.nodeIdx); ++i)
+					visitConnection(csr.GetNeighbor(i), csr.GetCost(i));
+
+				for (int nodeIdx : endConnections)
+				{
+					if (nodeIdx == currentRecord.nodeIdx)
+						visitConnection(endIdx, Elite::Distance(endPos, pNavGraph->GetNodePos(nodeIdx)));
+				}
+			}
+
+			std::vector<NavGraphNode*> nodePath{};
+			if (isGoalFound)
+			{
+				for (int idx = endIdx; idx != invalid_node_index; idx = context.GetParent(idx))
+					nodePath.push_back(idx == startIdx ? &startNode : idx == endIdx ? &endNode : pNavGraph->GetNode(idx));
+				std::reverse(nodePath.begin(), nodePath.end());
+			}
+			context.EndSearch();
+
+			//OPTIONAL BUT ADVICED: Debug Visualisation
+			debugNodePositions.clear();
+			for (NavGraphNode* pNode : nodePath) debugNodePositions.push_back(pNode->GetPosition());
+
+			if (nodePath.empty())
+				return finalPath;
+
+			//Run optimiser on the path
+			auto portals = SSFA::FindPortals(nodePath, pNavGraph->GetLines());
+			finalPath = SSFA::OptimizePortals(portals);
+			debugPortals = portals;
+
+			return finalPath;
+		}
+
 		static std::vector<Elite::Vector2> FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos, Elite::NavGraph* pNavGraph, std::vector<Elite::Vector2>& debugNodePositions, std::vector<Elite::Portal>& debugPortals)
+		{
+			//Scratch memory shared by all queries on this thread, it only grows with the largest graph queried
+			static thread_local SearchContext<NavGraphNode, GraphConnection2D> context{ nullptr };
+			return FindPath(startPos, endPos, pNavGraph, context, debugNodePositions, debugPortals);
+		}
+
+		// Reference implementation: copies the whole graph and adds start and end as real nodes
+		// Only for a single navigation mesh polygon, the nodes of a tiled navigation mesh are not tied to polygon lines
+		static std::vector<Elite::Vector2> FindPathOnClone(Elite::Vector2 startPos, Elite::Vector2 endPos, Elite::NavGraph* pNavGraph, std::vector<Elite::Vector2>& debugNodePositions, std::vector<Elite::Portal>& debugPortals)
 		{
 			//Create the path to return
 			std::vector<Elite::Vector2> finalPath{};
+			if (!pNavGraph->GetNavMeshPolygon()) return finalPath;
 
 			//Get the start and endTriangle
 
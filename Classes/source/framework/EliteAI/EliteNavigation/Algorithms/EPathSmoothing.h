@@ -27,6 +27,14 @@ namespace Elite
 		static std::vector<Portal> FindPortals(
 			const std::vector<NavGraphNode*>& nodePath,
 			Polygon* navMeshPolygon)
+		{
+			return FindPortals(nodePath, navMeshPolygon->GetLines());
+		}
+
+		// Lines indexed by the line index of the nodes
+		static std::vector<Portal> FindPortals(
+			const std::vector<NavGraphNode*>& nodePath,
+			const std::vector<Line*>& lines)
 		{
 			//Container
 			std::vector<Portal> vPortals = {};
@@ -38,7 +46,7 @@ namespace Elite
 			{
 				//Local variables
 				auto pNode = nodePath[i]; //Store node, except last node, because this is our target node!
-				auto pLine = navMeshPolygon->GetLines()[pNode->GetLineIndex()];
+				auto pLine = lines[pNode->GetLineIndex()];
 
 				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point
 				auto centerLine = (pLine->p1 + pLine->p2) / 2.0f;
@@ -8,6 +8,7 @@
 //#include "EGeometry.h"
 #include "EGeometry2DTypes.h"
 #include "EGeometry2DUtilities.h"
+#include <set>
 
 #pragma region Polygon
 #pragma region Constructors
@@ -165,9 +166,41 @@ bool Elite::Polygon::OverlappingYAxis(const Polygon& poly) const
 
 std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangle* t) const
 {
+	std::vector<Triangle*> adjTriangles;
+
+#ifdef USE_TRIANGLE_METADATA
+	//Two triangles sharing two points share the line between them: only look at the triangles on our own lines
+	if (HasTriangleIndex())
+	{
+		std::vector<int> candidates;
+		for (const auto lineIndex : t->metaData.IndexLines)
+		{
+			if (lineIndex < 0)
+				continue;
+			for (auto i = m_LineTriangleOffsets[lineIndex]; i < m_LineTriangleOffsets[lineIndex + 1]; ++i)
+			{
+				if (m_vpTriangles[m_LineTriangles[i]] != t)
+					candidates.push_back(m_LineTriangles[i]);
+			}
+		}
+
+		//Same order as the full scan, a triangle sharing more than one line shares all three points
+		std::sort(candidates.begin(), candidates.end());
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			size_t j = i;
+			while (j + 1 < candidates.size() && candidates[j + 1] == candidates[i])
+				++j;
+			if (j == i)
+				adjTriangles.push_back(m_vpTriangles[candidates[i]]);
+			i = j;
+		}
+		return adjTriangles;
+	}
+#endif
+
 	//For this triangle, go over all triangles and look if any of it's edges matches the edges of a triangle,
 	//in other words, two points overlap. If two points match, it's an adjacent triangle
-	std::vector<Triangle*> adjTriangles;
 	for (auto ct : m_vpTriangles)
 	{
 		if (t == ct) //If same triangle, ignore
@@ -196,16 +229,37 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 	std::vector<Triangle*> adjTriangles;
 
 #ifdef USE_TRIANGLE_METADATA
-	//Start by getting index of line in matrix
+	//Start by getting index of line in matrix, usually it is one of the lines of the triangle itself
 	auto lRev = Line(l.p2, l.p1);
-	const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
-	{ return (*rl == l || *rl == lRev); });
-	if (it == m_vpLines.end())
+	int lineIndex = -1;
+	for (const auto idx : t->metaData.IndexLines)
 	{
-		std::cout << "WARNING: line not found!" << std::endl;
+		if (idx >= 0 && idx < static_cast<int>(m_vpLines.size()) && (*m_vpLines[idx] == l || *m_vpLines[idx] == lRev))
+			lineIndex = idx;
+	}
+	if (lineIndex == -1)
+	{
+		const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
+		{ return (*rl == l || *rl == lRev); });
+		if (it == m_vpLines.end())
+		{
+			std::cout << "WARNING: line not found!" << std::endl;
+			return adjTriangles;
+		}
+		lineIndex = it - m_vpLines.begin();
+	}
+
+	//Use the triangles stored per line
+	if (HasTriangleIndex())
+	{
+		for (auto i = m_LineTriangleOffsets[lineIndex]; i < m_LineTriangleOffsets[lineIndex + 1]; ++i)
+		{
+			const auto ct = m_vpTriangles[m_LineTriangles[i]];
+			if (t != ct)
+				adjTriangles.push_back(ct);
+		}
 		return adjTriangles;
 	}
-	const int lineIndex = it - m_vpLines.begin();
 
 	//Go over all the triangles and compare lines
 	for (auto ct : m_vpTriangles)
@@ -225,6 +279,25 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 
 const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& position, bool onLineAllowed /*= false*/) const
 {
+	//Only test the triangles overlapping the cell of the position.
+	//Cells list their triangles in ascending order, so the first hit is the same as with the full scan
+	if (HasTriangleIndex())
+	{
+		const auto col = static_cast<int>(floorf((position.x - m_IndexOrigin.x) / m_IndexCellSize));
+		const auto row = static_cast<int>(floorf((position.y - m_IndexOrigin.y) / m_IndexCellSize));
+		if (col < 0 || col >= m_IndexColumns || row < 0 || row >= m_IndexRows)
+			return nullptr;
+
+		const auto cell = row * m_IndexColumns + col;
+		for (auto i = m_CellTriangleOffsets[cell]; i < m_CellTriangleOffsets[cell + 1]; ++i)
+		{
+			const auto t = m_vpTriangles[m_CellTriangles[i]];
+			if (PointInTriangle(position, t->p1, t->p2, t->p3, onLineAllowed))
+				return t;
+		}
+		return nullptr;
+	}
+
 	for (size_t i = 0; i < m_vpTriangles.size(); i++)
 	{
 		if (PointInTriangle(position, m_vpTriangles[i]->p1, m_vpTriangles[i]->p2, m_vpTriangles[i]->p3, onLineAllowed))
@@ -237,6 +310,16 @@ const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& po
 const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIndex(unsigned int lineIndex) const
 {
 	std::vector<const Triangle*> vpFoundTriangles = {};
+	if (HasTriangleIndex())
+	{
+		if (lineIndex + 1 < m_LineTriangleOffsets.size())
+		{
+			for (auto i = m_LineTriangleOffsets[lineIndex]; i < m_LineTriangleOffsets[lineIndex + 1]; ++i)
+				vpFoundTriangles.push_back(m_vpTriangles[m_LineTriangles[i]]);
+		}
+		return vpFoundTriangles;
+	}
+
 	for (auto pT : m_vpTriangles)
 	{
 		if (pT->metaData.IndexLines[0] == lineIndex ||
@@ -259,76 +342,22 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 	//Check winding
 	OrientateWithChildren(Winding::CCW);
 
-	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
-	for (auto child : m_vChildren)
-	{
-		//Check for overlap, if so merge, create new child and remove old ones!
-		//FILL IN FUNCTIONS!
-	}
-
-	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
-	std::sort(m_vChildren.begin(), m_vChildren.end(),
-		[](const Polygon& p1, const Polygon& p2)
-	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
-
-	//Copy children as backup after sort
-	const auto children = m_vChildren;
-	
-	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
-	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
-	{
-		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
-		{
-			//Swap if i.y < i+1.y
-			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
-			{
-				const auto temp = m_vChildren[i];
-				m_vChildren[i] = m_vChildren[i + 1];
-				m_vChildren[i + 1] = temp;
-			}
-		}
-	}
-
-	//First split polygon
-	while (m_vChildren.size() != 0)
-		Split();
-
-	//Triangle list - Clear first (if already containing triangles)
+	//Triangle and line list - Clear first (if already containing triangles)
 	for (auto t : m_vpTriangles)
 		SAFE_DELETE(t);
 	m_vpTriangles.clear();
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+	m_vpLines.clear();
 
-	std::list<Vector2> copyPoints;
-	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
-
-	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
-	while (copyPoints.size() > 3)
+	//The sweep line handles the holes directly, ear clipping is kept for input the sweep can't make sense of (overlapping holes, ...)
+	if (!TriangulateMonotone())
 	{
-		list<Vector2>::const_iterator earListIt = copyPoints.end();
-		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
-		{
-			if (earListIt != copyPoints.end())
-				break;
-			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
-				earListIt = it;
-		}
-
-		//Push triangle
-		Vector2 current, prev, next;
-		GetTriangle(copyPoints, earListIt, current, prev, next);
-		Triangle* t = new Triangle(prev, current, next);
-		m_vpTriangles.push_back(t);
-
-		//Remove current from pointslist
-		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
-		copyPoints.erase(currentIt); //remove
+		for (auto t : m_vpTriangles)
+			SAFE_DELETE(t);
+		m_vpTriangles.clear();
+		TriangulateEarClipping();
 	}
-	//Add the remaining 3 vertices to the triangulated polygon
-	std::vector<Vector2> tempCopy;
-	for (const auto p : copyPoints)
-		tempCopy.push_back(p);
-	Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
-	m_vpTriangles.push_back(lastTriangle);
 
 	//Flag as triangulated for later use
 	m_isTriangulated = true; 
@@ -336,8 +365,8 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 #ifdef USE_TRIANGLE_METADATA
 	GenerateLineMatrix();
 #endif
+	BuildTriangleIndex();
 
-	m_vChildren = children;
 	return m_vpTriangles;
 }
 
@@ -439,47 +468,141 @@ bool Elite::Polygon::IsEar(const list<Vector2>& l, const list<Vector2>::const_it
 void Elite::Polygon::GenerateLineMatrix()
 {
 #ifdef USE_TRIANGLE_METADATA
-	//Go over all the triangles
-	for (auto t : m_vpTriangles)
+	//Lines are looked up on their (sorted) end points, triangles share the exact same vertex values
+	struct LineKey
 	{
-		//Go over all the lines of the triangle, search if they are already in the matrix
-		//If not add them and store it's index in the triangles meta data
-		const Line l1{ t->p1, t->p2 };
-		const Line l1rev{ t->p2, t->p1 };
-		const Line l2{ t->p2, t->p3 };
-		const Line l2rev{ t->p3, t->p2 };
-		const Line l3{ t->p3, t->p1 };
-		const Line l3rev{ t->p1, t->p3 };
-		for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
-		{
-			const auto l = m_vpLines[i];
-			if (*l == l1 || *l == l1rev)
-				t->metaData.IndexLines[0] = i;
-			if (*l == l2 || *l == l2rev)
-				t->metaData.IndexLines[1] = i;
-			if (*l == l3 || *l == l3rev)
-				t->metaData.IndexLines[2] = i;
-		}
-		//Not found, add to matrix
-		if (t->metaData.IndexLines[0] == -1)
+		float x1, y1, x2, y2;
+		bool operator==(const LineKey& other) const
+		{ return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2; }
+	};
+	struct LineKeyHash
+	{
+		size_t operator()(const LineKey& key) const
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p1, t->p2, index));
-			t->metaData.IndexLines[0] = index;
+			size_t hash = 0;
+			for (const auto value : { key.x1, key.y1, key.x2, key.y2 })
+				hash = hash * 31 + std::hash<float>()(value);
+			return hash;
 		}
-		if (t->metaData.IndexLines[1] == -1)
+	};
+	auto makeKey = [](const Vector2& a, const Vector2& b)
+	{
+		const auto aFirst = a.x < b.x || (a.x == b.x && a.y < b.y);
+		const auto& p1 = aFirst ? a : b;
+		const auto& p2 = aFirst ? b : a;
+		return LineKey{ p1.x + 0.f, p1.y + 0.f, p2.x + 0.f, p2.y + 0.f }; //+ 0.f turns -0 into 0
+	};
+
+	std::unordered_map<LineKey, int, LineKeyHash> lineIndices;
+	lineIndices.reserve(m_vpLines.size() + m_vpTriangles.size() * 2);
+	for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
+		lineIndices.insert({ makeKey(m_vpLines[i]->p1, m_vpLines[i]->p2), i });
+
+	//Go over all the lines of all triangles, add the ones that are not in the matrix yet and store their index in the triangles meta data
+	for (auto t : m_vpTriangles)
+	{
+		const std::array<std::pair<Vector2, Vector2>, 3> lines{ { { t->p1, t->p2 }, { t->p2, t->p3 }, { t->p3, t->p1 } } };
+		for (auto i = 0; i < 3; ++i)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p2, t->p3, index));
-			t->metaData.IndexLines[1] = index;
+			const int newIndex = m_vpLines.size();
+			const auto result = lineIndices.insert({ makeKey(lines[i].first, lines[i].second), newIndex });
+			if (result.second) //Not found, add to matrix
+				m_vpLines.push_back(new Line(lines[i].first, lines[i].second, newIndex));
+			t->metaData.IndexLines[i] = result.first->second;
 		}
-		if (t->metaData.IndexLines[2] == -1)
+	}
+#endif
+}
+
+void Elite::Polygon::BuildTriangleIndex()
+{
+	m_IndexColumns = 0;
+	m_IndexRows = 0;
+	m_CellTriangleOffsets.clear();
+	m_CellTriangles.clear();
+	m_LineTriangleOffsets.clear();
+	m_LineTriangles.clear();
+	if (m_vpTriangles.empty())
+		return;
+
+	//1. Bounds of all triangles
+	Vector2 boundsMin = { (std::numeric_limits<float>::max)(), (std::numeric_limits<float>::max)() };
+	Vector2 boundsMax = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	for (const auto t : m_vpTriangles)
+	{
+		for (const auto& p : { t->p1, t->p2, t->p3 })
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p3, t->p1, index));
-			t->metaData.IndexLines[2] = index;
+			if (p.x < boundsMin.x)
+				boundsMin.x = p.x;
+			if (p.y < boundsMin.y)
+				boundsMin.y = p.y;
+			if (p.x > boundsMax.x)
+				boundsMax.x = p.x;
+			if (p.y > boundsMax.y)
+				boundsMax.y = p.y;
 		}
 	}
+
+	//2. Cell size: about one triangle per cell
+	const auto width = boundsMax.x - boundsMin.x;
+	const auto height = boundsMax.y - boundsMin.y;
+	const auto area = width * height;
+	m_IndexCellSize = area > 0.f ? sqrtf(area / static_cast<float>(m_vpTriangles.size())) : (width > height ? width : height);
+	if (m_IndexCellSize <= 0.f)
+		m_IndexCellSize = 1.f;
+	m_IndexOrigin = boundsMin;
+	m_IndexColumns = static_cast<int>(width / m_IndexCellSize) + 1;
+	m_IndexRows = static_cast<int>(height / m_IndexCellSize) + 1;
+
+	//3. Count the triangles per cell (the bounding box of the triangle decides which cells it overlaps)
+	auto toCell = [this](float v, float origin, int count)
+	{
+		const auto c = static_cast<int>(floorf((v - origin) / m_IndexCellSize));
+		return c < 0 ? 0 : (c >= count ? count - 1 : c);
+	};
+	auto forEachCell = [&](const Triangle* t, auto&& func)
+	{
+		const auto minX = t->p1.x < t->p2.x ? (t->p1.x < t->p3.x ? t->p1.x : t->p3.x) : (t->p2.x < t->p3.x ? t->p2.x : t->p3.x);
+		const auto maxX = t->p1.x > t->p2.x ? (t->p1.x > t->p3.x ? t->p1.x : t->p3.x) : (t->p2.x > t->p3.x ? t->p2.x : t->p3.x);
+		const auto minY = t->p1.y < t->p2.y ? (t->p1.y < t->p3.y ? t->p1.y : t->p3.y) : (t->p2.y < t->p3.y ? t->p2.y : t->p3.y);
+		const auto maxY = t->p1.y > t->p2.y ? (t->p1.y > t->p3.y ? t->p1.y : t->p3.y) : (t->p2.y > t->p3.y ? t->p2.y : t->p3.y);
+		const auto colEnd = toCell(maxX, m_IndexOrigin.x, m_IndexColumns);
+		const auto rowEnd = toCell(maxY, m_IndexOrigin.y, m_IndexRows);
+		for (auto row = toCell(minY, m_IndexOrigin.y, m_IndexRows); row <= rowEnd; ++row)
+			for (auto col = toCell(minX, m_IndexOrigin.x, m_IndexColumns); col <= colEnd; ++col)
+				func(row * m_IndexColumns + col);
+	};
+
+	const auto nrOfCells = m_IndexColumns * m_IndexRows;
+	m_CellTriangleOffsets.assign(nrOfCells + 1, 0);
+	for (const auto t : m_vpTriangles)
+		forEachCell(t, [this](int cell) { ++m_CellTriangleOffsets[cell + 1]; });
+	for (auto i = 0; i < nrOfCells; ++i)
+		m_CellTriangleOffsets[i + 1] += m_CellTriangleOffsets[i];
+
+	//4. Fill, going over the triangles in order keeps every cell sorted on triangle index
+	m_CellTriangles.resize(m_CellTriangleOffsets[nrOfCells]);
+	std::vector<int> cursor(m_CellTriangleOffsets.begin(), m_CellTriangleOffsets.end() - 1);
+	for (auto i = 0; i < static_cast<int>(m_vpTriangles.size()); ++i)
+		forEachCell(m_vpTriangles[i], [&](int cell) { m_CellTriangles[cursor[cell]++] = i; });
+
+#ifdef USE_TRIANGLE_METADATA
+	//5. Same layout for the triangles on each line
+	const auto nrOfLines = static_cast<int>(m_vpLines.size());
+	m_LineTriangleOffsets.assign(nrOfLines + 1, 0);
+	for (const auto t : m_vpTriangles)
+		for (const auto lineIndex : t->metaData.IndexLines)
+			if (lineIndex >= 0 && lineIndex < nrOfLines)
+				++m_LineTriangleOffsets[lineIndex + 1];
+	for (auto i = 0; i < nrOfLines; ++i)
+		m_LineTriangleOffsets[i + 1] += m_LineTriangleOffsets[i];
+
+	m_LineTriangles.resize(m_LineTriangleOffsets[nrOfLines]);
+	cursor.assign(m_LineTriangleOffsets.begin(), m_LineTriangleOffsets.end() - 1);
+	for (auto i = 0; i < static_cast<int>(m_vpTriangles.size()); ++i)
+		for (const auto lineIndex : m_vpTriangles[i]->metaData.IndexLines)
+			if (lineIndex >= 0 && lineIndex < nrOfLines)
+				m_LineTriangles[cursor[lineIndex]++] = i;
 #endif
 }
 #pragma endregion //PrivateGeneralFunctions
@@ -644,6 +767,478 @@ void Elite::Polygon::Split()
 	m_vChildren.clear();
 	m_vChildren = newChildren;
 }
+void Elite::Polygon::TriangulateEarClipping()
+{
+	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
+	for (auto child : m_vChildren)
+	{
+		//Check for overlap, if so merge, create new child and remove old ones!
+		//FILL IN FUNCTIONS!
+	}
+
+	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
+	std::sort(m_vChildren.begin(), m_vChildren.end(),
+		[](const Polygon& p1, const Polygon& p2)
+	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
+
+	//Copy children as backup after sort
+	const auto children = m_vChildren;
+	
+	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
+	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
+	{
+		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
+		{
+			//Swap if i.y < i+1.y
+			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
+			{
+				const auto temp = m_vChildren[i];
+				m_vChildren[i] = m_vChildren[i + 1];
+				m_vChildren[i + 1] = temp;
+			}
+		}
+	}
+
+	//First split polygon
+	while (m_vChildren.size() != 0)
+		Split();
+
+	std::list<Vector2> copyPoints;
+	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
+
+	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
+	while (copyPoints.size() > 3)
+	{
+		list<Vector2>::const_iterator earListIt = copyPoints.end();
+		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
+		{
+			if (earListIt != copyPoints.end())
+				break;
+			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
+				earListIt = it;
+		}
+		if (earListIt == copyPoints.end()) //No ear left, the input is not a simple polygon
+			break;
+
+		//Push triangle
+		Vector2 current, prev, next;
+		GetTriangle(copyPoints, earListIt, current, prev, next);
+		Triangle* t = new Triangle(prev, current, next);
+		m_vpTriangles.push_back(t);
+
+		//Remove current from pointslist
+		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
+		copyPoints.erase(currentIt); //remove
+	}
+	//Add the remaining 3 vertices to the triangulated polygon
+	std::vector<Vector2> tempCopy;
+	for (const auto p : copyPoints)
+		tempCopy.push_back(p);
+	if (tempCopy.size() == 3)
+	{
+		Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
+		m_vpTriangles.push_back(lastTriangle);
+	}
+
+	m_vChildren = children;
+
+}
+
+bool Elite::Polygon::TriangulateMonotone()
+{
+	//Sweep line triangulation: split the area into y-monotone pieces (de Berg et al., chapter 3) and triangulate those in linear time.
+	//Holes are part of the sweep, so they don't have to be bridged to the outline first. Returns false when the input doesn't add up.
+	enum class VertexType { Start, End, Split, Merge, Regular };
+
+	//1. Gather all rings: this outline, its holes, the islands in those holes, ...
+	//Every ring is stored with the inside on its left side (outlines counterclockwise, holes clockwise)
+	std::vector<Vector2> positions;
+	std::vector<int> nextVertex;
+	std::vector<int> prevVertex;
+	double expectedArea = 0.0;
+	int expectedNrOfTriangles = 0;
+	bool isOutlinePositive = true; //Triangles get the same orientation as the outline
+	std::vector<std::pair<const Polygon*, bool>> rings{ { this, true } };
+	while (!rings.empty())
+	{
+		const auto ring = rings.back();
+		rings.pop_back();
+		for (const auto& child : ring.first->m_vChildren)
+			rings.push_back({ &child, !ring.second });
+
+		const auto& points = ring.first->m_vPoints;
+		if (points.size() < 3)
+		{
+			if (ring.first == this)
+				return false;
+			continue;
+		}
+
+		const int first = static_cast<int>(positions.size());
+		positions.insert(positions.end(), points.begin(), points.end());
+		const int count = static_cast<int>(positions.size()) - first;
+
+		auto area = 0.f;
+		for (auto i = 0; i < count; ++i)
+			area += Cross(positions[first + i], positions[first + (i + 1) % count]);
+		area *= 0.5f;
+		if (ring.first == this)
+			isOutlinePositive = area > 0.f;
+		if ((area > 0.f) != ring.second)
+		{
+			std::reverse(positions.begin() + first, positions.end());
+			area = -area;
+		}
+
+		expectedArea += area;
+		expectedNrOfTriangles += count + (ring.second ? -2 : 2);
+		for (auto i = 0; i < count; ++i)
+		{
+			nextVertex.push_back(first + (i + 1) % count);
+			prevVertex.push_back(first + (i + count - 1) % count);
+		}
+	}
+	if (expectedArea <= 0.0)
+		return false;
+	const int nrOfVertices = static_cast<int>(positions.size());
+
+	//2. Sort the vertices from top to bottom, left to right on the same height
+	auto isAbove = [&positions](int a, int b)
+	{
+		const auto& pa = positions[a];
+		const auto& pb = positions[b];
+		if (pa.y != pb.y)
+			return pa.y > pb.y;
+		if (pa.x != pb.x)
+			return pa.x < pb.x;
+		return a < b;
+	};
+	//Turn direction of a -> b -> c, positive when turning left. In double: obstacles close to each other give nearly collinear points
+	auto getTurn = [&positions](int a, int b, int c)
+	{
+		const double abX = double(positions[b].x) - positions[a].x, abY = double(positions[b].y) - positions[a].y;
+		const double bcX = double(positions[c].x) - positions[b].x, bcY = double(positions[c].y) - positions[b].y;
+		return abX * bcY - abY * bcX;
+	};
+	std::vector<int> sweepOrder(nrOfVertices);
+	for (auto i = 0; i < nrOfVertices; ++i)
+		sweepOrder[i] = i;
+	std::sort(sweepOrder.begin(), sweepOrder.end(), isAbove);
+
+	std::vector<VertexType> types(nrOfVertices);
+	for (auto v = 0; v < nrOfVertices; ++v)
+	{
+		const auto prevBelow = isAbove(v, prevVertex[v]);
+		const auto nextBelow = isAbove(v, nextVertex[v]);
+		const auto isConvex = getTurn(prevVertex[v], v, nextVertex[v]) > 0.0;
+		if (prevBelow && nextBelow)
+			types[v] = isConvex ? VertexType::Start : VertexType::Split;
+		else if (!prevBelow && !nextBelow)
+			types[v] = isConvex ? VertexType::End : VertexType::Merge;
+		else
+			types[v] = VertexType::Regular;
+	}
+
+	//3. Sweep. The status holds the edges (named after their first vertex) that have the inside on their right, ordered on x at the sweep line
+	struct EdgeOrder
+	{
+		using is_transparent = void;
+		const std::vector<Vector2>* pPositions;
+		const std::vector<int>* pNextVertex;
+		const float* pSweepY;
+
+		float GetX(int edge) const
+		{
+			const auto& p = (*pPositions)[edge];
+			const auto& q = (*pPositions)[(*pNextVertex)[edge]];
+			if (p.y == q.y)
+				return p.x > q.x ? p.x : q.x;
+			return p.x + (*pSweepY - p.y) * (q.x - p.x) / (q.y - p.y);
+		}
+		float GetDrift(int edge) const //Horizontal movement when going down along the edge
+		{
+			const auto& p = (*pPositions)[edge];
+			const auto& q = (*pPositions)[(*pNextVertex)[edge]];
+			if (p.y == q.y)
+				return (std::numeric_limits<float>::max)();
+			return (q.x - p.x) / (p.y - q.y);
+		}
+		bool operator()(int a, int b) const
+		{
+			const auto xa = GetX(a);
+			const auto xb = GetX(b);
+			if (xa != xb)
+				return xa < xb;
+			return GetDrift(a) < GetDrift(b);
+		}
+		bool operator()(int edge, float x) const { return GetX(edge) < x; }
+		bool operator()(float x, int edge) const { return x < GetX(edge); }
+	};
+
+	auto sweepY = 0.f;
+	std::set<int, EdgeOrder> status{ EdgeOrder{ &positions, &nextVertex, &sweepY } };
+	std::vector<std::set<int, EdgeOrder>::iterator> statusEntries(nrOfVertices, status.end());
+	std::vector<int> helpers(nrOfVertices, -1);
+
+	struct HalfEdge
+	{
+		int to;
+		bool isUsed;
+	};
+	std::vector<std::vector<HalfEdge>> diagonals(nrOfVertices);
+	auto addDiagonal = [&](int a, int b)
+	{
+		if (a == b || nextVertex[a] == b || nextVertex[b] == a)
+			return;
+		for (const auto& d : diagonals[a])
+		{
+			if (d.to == b)
+				return;
+		}
+		diagonals[a].push_back({ b, false });
+		diagonals[b].push_back({ a, false });
+	};
+	auto insertEdge = [&](int edge)
+	{
+		statusEntries[edge] = status.insert(edge).first;
+		helpers[edge] = edge;
+	};
+	//Edge ending in v leaves the status, connecting to its helper first when that was a merge vertex
+	auto finishEdge = [&](int v)
+	{
+		const auto edge = prevVertex[v];
+		if (statusEntries[edge] == status.end())
+			return false;
+		if (types[helpers[edge]] == VertexType::Merge)
+			addDiagonal(v, helpers[edge]);
+		status.erase(statusEntries[edge]);
+		statusEntries[edge] = status.end();
+		return true;
+	};
+	//Edge directly left of v becomes helped by v
+	auto updateLeftEdge = [&](int v, bool alwaysConnect)
+	{
+		auto it = status.lower_bound(positions[v].x);
+		if (it == status.begin())
+			return false;
+		const auto edge = *std::prev(it);
+		if (alwaysConnect || types[helpers[edge]] == VertexType::Merge)
+			addDiagonal(v, helpers[edge]);
+		helpers[edge] = v;
+		return true;
+	};
+
+	for (const auto v : sweepOrder)
+	{
+		sweepY = positions[v].y;
+		auto isValid = true;
+		switch (types[v])
+		{
+		case VertexType::Start:
+			insertEdge(v);
+			break;
+		case VertexType::End:
+			isValid = finishEdge(v);
+			break;
+		case VertexType::Split:
+			isValid = updateLeftEdge(v, true);
+			insertEdge(v);
+			break;
+		case VertexType::Merge:
+			isValid = finishEdge(v) && updateLeftEdge(v, false);
+			break;
+		case VertexType::Regular:
+			if (isAbove(prevVertex[v], v)) //Inside on the right
+			{
+				isValid = finishEdge(v);
+				insertEdge(v);
+			}
+			else
+				isValid = updateLeftEdge(v, false);
+			break;
+		}
+		if (!isValid)
+			return false;
+	}
+
+	//4. Walk the monotone pieces: follow the outline, turning into the first diagonal found clockwise
+	auto getNextVertex = [&](int from, int v)
+	{
+		if (diagonals[v].empty())
+			return nextVertex[v];
+
+		//Compare on cross products (in double, nearly collinear diagonals are common) instead of angles
+		const auto& origin = positions[v];
+		auto getDirection = [&](int to) { return std::make_pair(double(positions[to].x) - origin.x, double(positions[to].y) - origin.y); };
+		auto cross = [](const std::pair<double, double>& a, const std::pair<double, double>& b) { return a.first * b.second - a.second * b.first; };
+		const auto back = getDirection(from);
+		//First half turn clockwise from the way back, or the second one
+		auto isInFirstHalf = [&](const std::pair<double, double>& dir)
+		{
+			const auto side = cross(back, dir);
+			return side < 0.0 || (side == 0.0 && back.first * dir.first + back.second * dir.second < 0.0);
+		};
+		auto isBefore = [&](int a, int b)
+		{
+			const auto dirA = getDirection(a);
+			const auto dirB = getDirection(b);
+			const auto isAFirstHalf = isInFirstHalf(dirA);
+			if (isAFirstHalf != isInFirstHalf(dirB))
+				return isAFirstHalf;
+			return cross(dirA, dirB) < 0.0;
+		};
+
+		auto bestVertex = nextVertex[v];
+		for (const auto& d : diagonals[v])
+		{
+			if (d.to != from && isBefore(d.to, bestVertex))
+				bestVertex = d.to;
+		}
+		return bestVertex;
+	};
+	//Marks the half edge as walked, returns false when it was walked before
+	std::vector<bool> isOutlineUsed(nrOfVertices, false);
+	auto useHalfEdge = [&](int from, int to)
+	{
+		if (to == nextVertex[from] && !isOutlineUsed[from])
+		{
+			isOutlineUsed[from] = true;
+			return true;
+		}
+		for (auto& d : diagonals[from])
+		{
+			if (d.to == to && !d.isUsed)
+			{
+				d.isUsed = true;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	auto triangulatedArea = 0.0;
+	auto emitTriangle = [&](int a, int b, int c)
+	{
+		const auto doubleArea = Cross(positions[b] - positions[a], positions[c] - positions[a]);
+		triangulatedArea += fabs(doubleArea) * 0.5;
+		if ((doubleArea > 0.f) != isOutlinePositive)
+			std::swap(b, c);
+		m_vpTriangles.push_back(new Triangle(positions[a], positions[b], positions[c]));
+	};
+
+	std::vector<int> piece;
+	std::vector<int> sortedPiece;
+	std::vector<bool> isOnLeftChain;
+	std::vector<int> stack;
+	auto triangulatePiece = [&]()
+	{
+		//Merge both chains from top to bottom: going forward from the top follows the left chain
+		const int count = static_cast<int>(piece.size());
+		auto top = 0;
+		auto bottom = 0;
+		for (auto i = 1; i < count; ++i)
+		{
+			if (isAbove(piece[i], piece[top]))
+				top = i;
+			if (isAbove(piece[bottom], piece[i]))
+				bottom = i;
+		}
+
+		sortedPiece.clear();
+		isOnLeftChain.clear();
+		sortedPiece.push_back(piece[top]);
+		isOnLeftChain.push_back(true);
+		auto left = (top + 1) % count;
+		auto right = (top + count - 1) % count;
+		while (left != bottom || right != bottom)
+		{
+			const auto takeLeft = right == bottom || (left != bottom && isAbove(piece[left], piece[right]));
+			sortedPiece.push_back(takeLeft ? piece[left] : piece[right]);
+			isOnLeftChain.push_back(takeLeft);
+			takeLeft ? left = (left + 1) % count : right = (right + count - 1) % count;
+		}
+		sortedPiece.push_back(piece[bottom]);
+		isOnLeftChain.push_back(false);
+
+		//Stack of vertices that still need triangles, always a reflex chain
+		stack.clear();
+		stack.push_back(0);
+		stack.push_back(1);
+		for (auto j = 2; j < count - 1; ++j)
+		{
+			const auto current = sortedPiece[j];
+			if (isOnLeftChain[j] != isOnLeftChain[stack.back()])
+			{
+				//Opposite chain: fan to everything on the stack
+				for (size_t i = 0; i + 1 < stack.size(); ++i)
+					emitTriangle(current, sortedPiece[stack[i]], sortedPiece[stack[i + 1]]);
+				const auto last = stack.back();
+				stack.clear();
+				stack.push_back(last);
+				stack.push_back(j);
+			}
+			else
+			{
+				//Same chain: cut off triangles as long as the vertex in between is convex
+				auto last = stack.back();
+				stack.pop_back();
+				while (!stack.empty())
+				{
+					const auto top = sortedPiece[stack.back()];
+					const auto turn = isOnLeftChain[j] ? getTurn(top, sortedPiece[last], current) : getTurn(current, sortedPiece[last], top);
+					if (turn <= 0.0)
+						break;
+					emitTriangle(current, sortedPiece[last], sortedPiece[stack.back()]);
+					last = stack.back();
+					stack.pop_back();
+				}
+				stack.push_back(last);
+				stack.push_back(j);
+			}
+		}
+		//Bottom vertex closes everything that is left
+		for (size_t i = 0; i + 1 < stack.size(); ++i)
+			emitTriangle(sortedPiece[count - 1], sortedPiece[stack[i]], sortedPiece[stack[i + 1]]);
+	};
+
+	const int maxPieceSize = nrOfVertices + 1;
+	auto walkPiece = [&](int from, int to)
+	{
+		piece.clear();
+		piece.push_back(from);
+		while (to != piece.front())
+		{
+			if (static_cast<int>(piece.size()) > maxPieceSize)
+				return false;
+			piece.push_back(to);
+			const auto next = getNextVertex(from, to);
+			if (!useHalfEdge(to, next))
+				return false;
+			from = to;
+			to = next;
+		}
+		if (piece.size() < 3)
+			return false;
+		triangulatePiece();
+		return true;
+	};
+
+	for (auto v = 0; v < nrOfVertices; ++v)
+	{
+		if (!isOutlineUsed[v] && !(useHalfEdge(v, nextVertex[v]) && walkPiece(v, nextVertex[v])))
+			return false;
+		for (auto& d : diagonals[v])
+		{
+			if (!d.isUsed && !(useHalfEdge(v, d.to) && walkPiece(v, d.to)))
+				return false;
+		}
+	}
+
+	//5. Validate: overlapping holes or self intersections break the sweep, the triangles won't cover the area exactly once
+	return static_cast<int>(m_vpTriangles.size()) == expectedNrOfTriangles
+		&& fabs(triangulatedArea - expectedArea) <= expectedArea * 1e-3;
+}
+
 #pragma endregion //PrivateTriangulationFunctions
 //----------------------------------------------------------
 #pragma endregion //Polygon
@@ -140,12 +140,27 @@ namespace Elite
 		std::vector<Line*> m_vpLines; //Lines constructing this polygon!
 		bool m_isTriangulated = false;
 
+		//Spatial index, built when triangulating: uniform grid over the bounding boxes of the triangles
+		//Both the cells and the lines list their triangles in a flat array, [offsets[i], offsets[i + 1]) belongs to cell/line i
+		Vector2 m_IndexOrigin = {};
+		float m_IndexCellSize = 0.f;
+		int m_IndexColumns = 0;
+		int m_IndexRows = 0;
+		std::vector<int> m_CellTriangleOffsets;
+		std::vector<int> m_CellTriangles;
+		std::vector<int> m_LineTriangleOffsets;
+		std::vector<int> m_LineTriangles;
+
 		//=== Functions ===
 		//Private General Functions
 		void GetTriangle(const list<Vector2>& l, const list<Vector2>::const_iterator p, Vector2& currentTip, Vector2& previous, Vector2& next) const;
 		bool IsConvexInPolygon(const list<Vector2>& l, const list<Vector2>::const_iterator p) const;
 		bool IsEar(const list<Vector2>& l, const list<Vector2>::const_iterator p) const;
 		void GenerateLineMatrix();
+		bool TriangulateMonotone();
+		void TriangulateEarClipping();
+		void BuildTriangleIndex();
+		bool HasTriangleIndex() const { return m_IndexColumns > 0; }
 
 		//Private Triangulation Functions
 		void FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner);
@@ -0,0 +1,296 @@
+#include "stdafx.h"
+#include "EProfiler.h"
+
+using namespace Elite;
+
+namespace
+{
+	// Nesting of the scopes that are open on this thread
+	thread_local int s_Depth = 0;
+
+	// Same name, same color
+	ImU32 GetColor(const char* name)
+	{
+		unsigned int hash = 2166136261u;
+		for (const char* c = name; *c != '\0'; ++c)
+		{
+			hash ^= static_cast<unsigned char>(*c);
+			hash *= 16777619u;
+		}
+		return ImColor::HSV((hash % 360) / 360.f, 0.45f, 0.85f);
+	}
+
+	void WriteJsonString(std::ofstream& file, const char* text)
+	{
+		file << '"';
+		for (const char* c = text; *c != '\0'; ++c)
+		{
+			if (*c == '"' || *c == '\\') file << '\\';
+			file << *c;
+		}
+		file << '"';
+	}
+}
+
+//--- Profiler ---
+EProfiler::EProfiler()
+	: m_Epoch{ std::chrono::high_resolution_clock::now() }
+	, m_Frames(m_NrOfFrames)
+{
+}
+
+long long EProfiler::GetTime() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_Epoch).count();
+}
+
+void EProfiler::BeginFrame()
+{
+	const long long now = GetTime();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	GetThreadIdx(std::this_thread::get_id());
+
+	//1. Keep the frame that ends, the oldest kept frame makes room for it
+	if (m_CurrentFrame.start != 0 && m_IsEnabled && !m_IsPaused)
+	{
+		m_CurrentFrame.duration = now - m_CurrentFrame.start;
+		m_LastFrameIdx = (m_LastFrameIdx + 1) % m_NrOfFrames;
+		std::swap(m_Frames[m_LastFrameIdx], m_CurrentFrame);
+		m_NrOfRecordedFrames = m_NrOfRecordedFrames < m_NrOfFrames ? m_NrOfRecordedFrames + 1 : m_NrOfFrames;
+	}
+
+	//2. Start the next one, reusing the events of the frame that was dropped
+	m_CurrentFrame.start = now;
+	m_CurrentFrame.duration = 0;
+	m_CurrentFrame.events.clear();
+	m_CurrentFrame.nrOfDroppedEvents = 0;
+}
+
+void EProfiler::RecordEvent(const char* name, long long start, long long end, int depth)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if ((int)m_CurrentFrame.events.size() >= m_MaxEventsPerFrame)
+	{
+		++m_CurrentFrame.nrOfDroppedEvents;
+		return;
+	}
+
+	m_CurrentFrame.events.push_back(ProfileEvent{ name, start, end - start, depth, GetThreadIdx(std::this_thread::get_id()) });
+}
+
+int EProfiler::GetThreadIdx(std::thread::id threadId)
+{
+	//Called with the mutex locked, only a few threads so a linear search
+	for (size_t i = 0; i < m_ThreadIds.size(); ++i)
+	{
+		if (m_ThreadIds[i] == threadId)
+			return static_cast<int>(i);
+	}
+
+	m_ThreadIds.push_back(threadId);
+	return static_cast<int>(m_ThreadIds.size()) - 1;
+}
+
+const ProfileFrame* EProfiler::GetFrame(int framesAgo) const
+{
+	//The kept frames only change in BeginFrame, on the thread that reads them
+	if (framesAgo < 0 || framesAgo >= m_NrOfRecordedFrames)
+		return nullptr;
+
+	return &m_Frames[(m_LastFrameIdx - framesAgo + m_NrOfFrames) % m_NrOfFrames];
+}
+
+bool EProfiler::ExportChromeTrace(const std::string& filePath) const
+{
+	std::ofstream file{ filePath };
+	if (!file.is_open())
+		return false;
+
+	//Complete events ("X") with times in microseconds, a "Frame" event around the scopes of every frame
+	file << "{\"traceEvents\":[\n";
+	file << std::fixed;
+	file.precision(3);
+	bool isFirstEvent = true;
+	auto writeEvent = [&](const char* name, long long start, long long duration, int threadIdx)
+	{
+		file << (isFirstEvent ? "" : ",\n") << "{\"name\":";
+		WriteJsonString(file, name);
+		file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIdx << ",\"ts\":" << start / 1000.0 << ",\"dur\":" << duration / 1000.0 << "}";
+		isFirstEvent = false;
+	};
+
+	int nrOfThreads = 1;
+	for (int framesAgo = m_NrOfRecordedFrames - 1; framesAgo >= 0; --framesAgo)
+	{
+		const ProfileFrame& frame = *GetFrame(framesAgo);
+		writeEvent("Frame", frame.start, frame.duration, 0);
+		for (const ProfileEvent& event : frame.events)
+		{
+			writeEvent(event.name, event.start, event.duration, event.threadIdx);
+			nrOfThreads = event.threadIdx + 1 > nrOfThreads ? event.threadIdx + 1 : nrOfThreads;
+		}
+	}
+
+	for (int threadIdx = 0; threadIdx < nrOfThreads; ++threadIdx)
+	{
+		file << (isFirstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadIdx
+			<< ",\"args\":{\"name\":\"" << (threadIdx == 0 ? "Main" : "Worker ") << (threadIdx == 0 ? "" : std::to_string(threadIdx)) << "\"}}";
+		isFirstEvent = false;
+	}
+	file << "\n]}\n";
+	return true;
+}
+
+void EProfiler::UpdateAndRenderUI()
+{
+	if (INPUTMANAGER->IsKeyboardKeyUp(eScancode_F1))
+		m_IsWindowVisible = !m_IsWindowVisible;
+	if (!m_IsWindowVisible)
+		return;
+
+	//Setup
+	const int menuWidth = 460;
+	ImGui::SetNextWindowPos(ImVec2(10, 10));
+	ImGui::SetNextWindowSize(ImVec2((float)menuWidth, 420));
+	ImGui::Begin("Profiler (F1)", &m_IsWindowVisible, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+	ImGui::PushAllowKeyboardFocus(false);
+
+	bool isEnabled = m_IsEnabled;
+	if (ImGui::Checkbox("Enabled", &isEnabled))
+		m_IsEnabled = isEnabled;
+	ImGui::SameLine();
+	ImGui::Checkbox("Paused", &m_IsPaused);
+	ImGui::SameLine();
+	if (ImGui::Button("Export trace"))
+	{
+		const std::string filePath = "profile_trace.json";
+		if (ExportChromeTrace(filePath))
+			std::cout << "Profiler: " << m_NrOfRecordedFrames << " frames written to " << filePath << std::endl;
+		else
+			std::cout << "Profiler: could not write " << filePath << std::endl;
+	}
+
+	if (m_NrOfRecordedFrames == 0)
+	{
+		ImGui::PopAllowKeyboardFocus();
+		ImGui::End();
+		return;
+	}
+
+	//Frame times, oldest on the left
+	std::vector<float> frameTimes(m_NrOfRecordedFrames);
+	float maxFrameTime = 0.f;
+	for (int framesAgo = 0; framesAgo < m_NrOfRecordedFrames; ++framesAgo)
+	{
+		const float frameTime = GetFrame(framesAgo)->duration / 1000000.f;
+		frameTimes[m_NrOfRecordedFrames - 1 - framesAgo] = frameTime;
+		maxFrameTime = frameTime > maxFrameTime ? frameTime : maxFrameTime;
+	}
+	ImGui::PlotHistogram("##FrameTimes", frameTimes.data(), m_NrOfRecordedFrames, 0, "ms/frame", 0.f, maxFrameTime, ImVec2(ImGui::GetContentRegionAvail().x, 60));
+
+	m_SelectedFrame = m_SelectedFrame < m_NrOfRecordedFrames ? m_SelectedFrame : m_NrOfRecordedFrames - 1;
+	ImGui::SliderInt("Frames ago", &m_SelectedFrame, 0, m_NrOfRecordedFrames - 1, "%.0f");
+	const ProfileFrame& frame = *GetFrame(m_SelectedFrame);
+	ImGui::Text("%.3f ms, %d scopes", frame.duration / 1000000.f, (int)frame.events.size());
+	if (frame.nrOfDroppedEvents > 0)
+	{
+		ImGui::SameLine();
+		ImGui::Text(", %d dropped", frame.nrOfDroppedEvents);
+	}
+
+	RenderFlameGraph(frame);
+
+	//Total time and calls per scope name, the most expensive first
+	std::map<std::string, std::pair<long long, int>> totals{};
+	for (const ProfileEvent& event : frame.events)
+	{
+		auto& total = totals[event.name];
+		total.first += event.duration;
+		++total.second;
+	}
+	std::vector<std::pair<std::string, std::pair<long long, int>>> sortedTotals(totals.begin(), totals.end());
+	std::sort(sortedTotals.begin(), sortedTotals.end(), [](const auto& a, const auto& b) { return a.second.first > b.second.first; });
+
+	ImGui::Spacing();
+	ImGui::Separator();
+	for (const auto& total : sortedTotals)
+		ImGui::Text("%-32s %8.3f ms %6d x", total.first.c_str(), total.second.first / 1000000.f, total.second.second);
+
+	ImGui::PopAllowKeyboardFocus();
+	ImGui::End();
+}
+
+void EProfiler::RenderFlameGraph(const ProfileFrame& frame)
+{
+	//One row per depth, the threads below each other, hovering a bar shows its scope
+	const float rowHeight = 18.f;
+	std::vector<int> nrOfRows{};
+	for (const ProfileEvent& event : frame.events)
+	{
+		if (event.threadIdx >= (int)nrOfRows.size())
+			nrOfRows.resize(event.threadIdx + 1, 0);
+		nrOfRows[event.threadIdx] = event.depth + 1 > nrOfRows[event.threadIdx] ? event.depth + 1 : nrOfRows[event.threadIdx];
+	}
+	std::vector<int> firstRows(nrOfRows.size(), 0);
+	int totalNrOfRows = 0;
+	for (size_t threadIdx = 0; threadIdx < nrOfRows.size(); ++threadIdx)
+	{
+		firstRows[threadIdx] = totalNrOfRows;
+		totalNrOfRows += nrOfRows[threadIdx];
+	}
+
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	const float width = ImGui::GetContentRegionAvail().x;
+	const float height = totalNrOfRows * rowHeight;
+	ImDrawList* pDrawList = ImGui::GetWindowDrawList();
+	pDrawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), ImColor(40, 40, 40));
+	if (frame.duration <= 0)
+	{
+		ImGui::Dummy(ImVec2(width, height));
+		return;
+	}
+
+	const float scale = width / frame.duration;
+	for (const ProfileEvent& event : frame.events)
+	{
+		//Scopes of other threads can start before the frame or end after it
+		float left = (event.start - frame.start) * scale;
+		float right = (event.start + event.duration - frame.start) * scale;
+		left = left < 0.f ? 0.f : left;
+		right = right > width ? width : right;
+		right = right < left + 1.f ? left + 1.f : right;
+
+		const ImVec2 min{ origin.x + left, origin.y + (firstRows[event.threadIdx] + event.depth) * rowHeight };
+		const ImVec2 max{ origin.x + right, min.y + rowHeight - 1.f };
+		pDrawList->AddRectFilled(min, max, GetColor(event.name));
+		if (ImGui::CalcTextSize(event.name).x < max.x - min.x - 4.f)
+			pDrawList->AddText(ImVec2(min.x + 2.f, min.y + 2.f), ImColor(0, 0, 0), event.name);
+
+		if (ImGui::IsMouseHoveringRect(min, max))
+			ImGui::SetTooltip("%s: %.3f ms", event.name, event.duration / 1000000.f);
+	}
+	ImGui::Dummy(ImVec2(width, height));
+}
+
+//--- Scope ---
+ProfileScope::ProfileScope(const char* name)
+	: m_Name{ name }
+	, m_Start{ 0 }
+	, m_IsRecording{ PROFILER->IsEnabled() }
+{
+	if (!m_IsRecording)
+		return;
+
+	++s_Depth;
+	m_Start = PROFILER->GetTime();
+}
+
+ProfileScope::~ProfileScope()
+{
+	if (!m_IsRecording)
+		return;
+
+	const long long end = PROFILER->GetTime();
+	--s_Depth;
+	PROFILER->RecordEvent(m_Name, m_Start, end, s_Depth);
+}
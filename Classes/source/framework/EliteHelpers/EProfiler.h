@@ -0,0 +1,102 @@
+/*=============================================================================*/
+// EProfiler.h: scoped timers, kept per frame for the last frames, drawn in a window and exported as a Chrome trace.
+/*=============================================================================*/
+#ifndef ELITE_PROFILER
+#define	ELITE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+namespace Elite
+{
+	// Times in nanoseconds since the profiler was created
+	struct ProfileEvent
+	{
+		const char* name; // string literal, only the pointer is kept
+		long long start;
+		long long duration;
+		int depth; // nesting on its thread, 0 for an outer scope
+		int threadIdx; // 0 for the thread that calls BeginFrame first
+	};
+
+	struct ProfileFrame
+	{
+		long long start = 0;
+		long long duration = 0;
+		std::vector<ProfileEvent> events; // in the order the scopes ended, children before their parent
+		int nrOfDroppedEvents = 0;
+	};
+
+	// BeginFrame closes the frame before and starts a new one, the last m_NrOfFrames frames are kept
+	// Scopes can end on any thread, an event belongs to the frame that is running when it ends
+	class EProfiler final : public ESingleton<EProfiler>
+	{
+	public:
+		EProfiler();
+		~EProfiler() = default;
+
+		void BeginFrame();
+		void RecordEvent(const char* name, long long start, long long end, int depth);
+		long long GetTime() const;
+
+		void SetEnabled(bool isEnabled) { m_IsEnabled = isEnabled; }
+		bool IsEnabled() const { return m_IsEnabled; }
+
+		// 0 is the last finished frame, nullptr past the frames that are kept
+		const ProfileFrame* GetFrame(int framesAgo) const;
+		int GetNrOfFrames() const { return m_NrOfRecordedFrames; }
+
+		// Every kept frame in the trace event format of chrome://tracing and Perfetto
+		bool ExportChromeTrace(const std::string& filePath) const;
+
+		// F1 shows and hides the window
+		void UpdateAndRenderUI();
+
+	private:
+		static const int m_NrOfFrames = 120;
+		static const int m_MaxEventsPerFrame = 16384;
+
+		const std::chrono::high_resolution_clock::time_point m_Epoch;
+		std::atomic<bool> m_IsEnabled{ true }; // read by the scopes on every thread
+
+		mutable std::mutex m_Mutex; // the current frame and the thread ids
+		ProfileFrame m_CurrentFrame;
+		std::vector<ProfileFrame> m_Frames; // ring buffer
+		int m_LastFrameIdx = -1;
+		int m_NrOfRecordedFrames = 0;
+		std::vector<std::thread::id> m_ThreadIds;
+
+		// UI
+		bool m_IsWindowVisible = false;
+		bool m_IsPaused = false;
+		int m_SelectedFrame = 0; // frames ago
+
+		int GetThreadIdx(std::thread::id threadId);
+		void RenderFlameGraph(const ProfileFrame& frame);
+	};
+
+	// Times the scope it is declared in
+	class ProfileScope final
+	{
+	public:
+		explicit ProfileScope(const char* name);
+		~ProfileScope();
+
+	private:
+		const char* m_Name;
+		long long m_Start;
+		bool m_IsRecording;
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	};
+}
+
+#define ELITE_PROFILE_CONCAT_INNER(a, b) a##b
+#define ELITE_PROFILE_CONCAT(a, b) ELITE_PROFILE_CONCAT_INNER(a, b)
+#define ELITE_PROFILE_SCOPE(name) Elite::ProfileScope ELITE_PROFILE_CONCAT(profileScope, __LINE__){ name }
+#endif
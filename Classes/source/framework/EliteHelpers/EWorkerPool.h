@@ -0,0 +1,132 @@
+/*=============================================================================*/
+// EWorkerPool.h: persistent threads that split a loop over indices between them.
+/*=============================================================================*/
+#ifndef ELITE_WORKER_POOL
+#define	ELITE_WORKER_POOL
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace Elite
+{
+	// ParallelFor hands out chunks of [0, count) to the workers and the calling thread, and returns when every
+	// chunk is done. Which thread runs which chunk is not fixed, so a job must only write to the indices it gets.
+	class WorkerPool final
+	{
+	public:
+		// nrOfThreads includes the calling thread, 1 runs every job on the calling thread
+		explicit WorkerPool(int nrOfThreads = GetDefaultNrOfThreads())
+		{
+			for (int i = 1; i < nrOfThreads; ++i)
+				m_Workers.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_IsShuttingDown = true;
+			}
+			m_WorkAvailable.notify_all();
+
+			for (std::thread& worker : m_Workers)
+				worker.join();
+		}
+
+		void ParallelFor(int count, const std::function<void(int begin, int end)>& job)
+		{
+			// A few chunks per thread so a slow chunk does not hold up the others
+			const int nrOfThreads = GetNrOfThreads();
+			int chunkSize = count / (nrOfThreads * 4);
+			chunkSize = chunkSize < m_MinChunkSize ? m_MinChunkSize : chunkSize;
+			if (m_Workers.empty() || count <= chunkSize)
+			{
+				if (count > 0) job(0, count);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_pJob = &job;
+				m_Count = count;
+				m_ChunkSize = chunkSize;
+				m_NextChunkStart = 0;
+				m_NrOfBusyWorkers = (int)m_Workers.size();
+				++m_Generation;
+			}
+			m_WorkAvailable.notify_all();
+
+			RunChunks();
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkDone.wait(lock, [this]() { return m_NrOfBusyWorkers == 0; });
+			m_pJob = nullptr;
+		}
+
+		int GetNrOfThreads() const { return (int)m_Workers.size() + 1; }
+		void SetMinChunkSize(int minChunkSize) { m_MinChunkSize = minChunkSize > 0 ? minChunkSize : 1; }
+
+		static int GetDefaultNrOfThreads()
+		{
+			const int nrOfCores = (int)std::thread::hardware_concurrency();
+			return nrOfCores > 0 ? nrOfCores : 1;
+		}
+
+	private:
+		void WorkerLoop()
+		{
+			unsigned int generation = 0;
+			while (true)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_WorkAvailable.wait(lock, [this, generation]() { return m_IsShuttingDown || m_Generation != generation; });
+					if (m_IsShuttingDown)
+						return;
+					generation = m_Generation;
+				}
+
+				RunChunks();
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (--m_NrOfBusyWorkers == 0)
+					m_WorkDone.notify_one();
+			}
+		}
+
+		void RunChunks()
+		{
+			while (true)
+			{
+				const int begin = m_NextChunkStart.fetch_add(m_ChunkSize);
+				if (begin >= m_Count)
+					return;
+				const int end = begin + m_ChunkSize;
+				(*m_pJob)(begin, end < m_Count ? end : m_Count);
+			}
+		}
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkAvailable;
+		std::condition_variable m_WorkDone;
+		bool m_IsShuttingDown = false;
+		unsigned int m_Generation = 0;
+		int m_NrOfBusyWorkers = 0;
+
+		// Current job, written under the mutex before the workers are woken
+		const std::function<void(int, int)>* m_pJob = nullptr;
+		int m_Count = 0;
+		int m_ChunkSize = 0;
+		int m_MinChunkSize = 256;
+		std::atomic<int> m_NextChunkStart{ 0 };
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+	};
+}
+#endif
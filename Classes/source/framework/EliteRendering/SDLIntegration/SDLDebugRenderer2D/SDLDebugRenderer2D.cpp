@@ -58,8 +58,19 @@ void SDLDebugRenderer2D::Initialize(Camera2D* pActiveCamera)
 	}
 }
 
+void SDLDebugRenderer2D::InitializeHeadless(Camera2D* pActiveCamera)
+{
+	//Only the camera, so the apps can still convert between screen and world
+	m_pActiveCamera = pActiveCamera;
+	m_CurrDepthSlice = DEPTH_SLICE_MAX;
+	m_IsHeadless = true;
+}
+
 void SDLDebugRenderer2D::Render()
 {
+	if (m_IsHeadless)
+		return;
+
 	//Clear color
 	glClear(GL_COLOR_BUFFER_BIT);
 	glClear(GL_DEPTH_BUFFER_BIT);
@@ -134,6 +145,9 @@ void SDLDebugRenderer2D::Shutdown()
 	m_vLines.clear();
 	m_vTriangles.clear();
 
+	if (m_IsHeadless)
+		return;
+
 	glDeleteBuffers(1, m_bufferIDs);
 	glDeleteVertexArrays(1, &m_vaoId);
 	glDeleteProgram(m_programID);
@@ -141,6 +155,9 @@ void SDLDebugRenderer2D::Shutdown()
 
 void SDLDebugRenderer2D::DrawPolygon(Elite::Polygon* polygon, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	//Copy data to vector
 	std::vector<Elite::Vector2> points;
 	points.assign(polygon->GetPoints().begin(), polygon->GetPoints().end());
@@ -180,6 +197,9 @@ void SDLDebugRenderer2D::DrawPolygon(Elite::Polygon* polygon, const Color& color
 
 void SDLDebugRenderer2D::DrawPolygon(const Elite::Vector2* points, int count, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	auto p1 = points[count - 1];
 	for (auto i = 0; i < count; ++i)
 	{
@@ -192,6 +212,9 @@ void SDLDebugRenderer2D::DrawPolygon(const Elite::Vector2* points, int count, co
 
 void SDLDebugRenderer2D::DrawSolidPolygon(Elite::Polygon* polygon, const Color& color, float depth, bool triangulate)
 {
+	if (m_IsHeadless)
+		return;
+
 	//Color
 	const Color fillColor(0.5f * color.r, 0.5f * color.g, 0.5f * color.b, 0.5f);
 
@@ -259,6 +282,9 @@ void SDLDebugRenderer2D::DrawSolidPolygon(const Elite::Polygon* polygon, const C
 
 void SDLDebugRenderer2D::DrawSolidPolygon(const Elite::Vector2* points, int count, const Color& color, float depth, bool triangluate)
 {
+	if (m_IsHeadless)
+		return;
+
 	//Color
 	const Color fillColor(0.5f * color.r, 0.5f * color.g, 0.5f * color.b, 0.5f);
 
@@ -305,6 +331,9 @@ void SDLDebugRenderer2D::DrawSolidPolygon(const Elite::Vector2* points, int coun
 
 void SDLDebugRenderer2D::DrawCircle(const Elite::Vector2& center, float radius, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	const auto k_segments = 16.0f;
 	const auto k_increment = 2.0f * b2_pi / k_segments;
 	const auto sinInc = sinf(k_increment);
@@ -327,6 +356,9 @@ void SDLDebugRenderer2D::DrawCircle(const Elite::Vector2& center, float radius,
 
 void SDLDebugRenderer2D::DrawSolidCircle(const Elite::Vector2& center, float radius, const Elite::Vector2& axis, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	const auto k_segments = 16.0f;
 	const auto k_increment = 2.0f * b2_pi / k_segments;
 	const auto sinInc = sinf(k_increment);
@@ -380,6 +412,9 @@ void SDLDebugRenderer2D::DrawSolidCircle(const Elite::Vector2& center, float rad
 
 void SDLDebugRenderer2D::DrawSegment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	m_vLines.push_back(Vertex(p1, depth, color));
 	m_vLines.push_back(Vertex(p2, depth, color));
 }
@@ -396,6 +431,9 @@ void SDLDebugRenderer2D::DrawDirection(const Elite::Vector2& p, const Elite::Vec
 
 void SDLDebugRenderer2D::DrawTransform(const Elite::Vector2& p, const Elite::Vector2& xAxis, const Elite::Vector2& yAxis, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	const auto k_axisScale = 0.4f;
 	const Color red(1.0f, 0.0f, 0.0f);
 	const Color green(0.0f, 1.0f, 0.0f);
@@ -412,11 +450,17 @@ void SDLDebugRenderer2D::DrawTransform(const Elite::Vector2& p, const Elite::Vec
 
 void SDLDebugRenderer2D::DrawPoint(const Elite::Vector2& p, float size, const Color& color, float depth)
 {
+	if (m_IsHeadless)
+		return;
+
 	m_vPoints.push_back(Vertex(p, depth, color, size));
 }
 
 void SDLDebugRenderer2D::DrawString(int x, int y, const char* string, ...) const
 {
+	if (m_IsHeadless)
+		return;
+
 	//TODO: ADD CLEAN TEXRENDERING
 	va_list arg;
 	va_start(arg, string);
@@ -441,6 +485,9 @@ void SDLDebugRenderer2D::DrawString(int x, int y, const char* string, ...) const
 
 void SDLDebugRenderer2D::DrawString(const Elite::Vector2& pw, const char* string, ...) const
 {
+	if (m_IsHeadless)
+		return;
+
 	//TODO: ADD CLEAN TEXRENDERING
 	if (!m_pActiveCamera)
 		return;
@@ -24,6 +24,7 @@ namespace Elite
 
 		//--- Functions ---
 		void Initialize(Camera2D* pActiveCamera);
+		void InitializeHeadless(Camera2D* pActiveCamera);
 		void Render();
 		unsigned int LoadShadersToProgram(const char* vertexShaderPath, const char* fragmentShaderPath);
 		unsigned int LoadShadersToProgramFromEmbeddedSource(const char* vertexShader, const char* fragmentShader);
@@ -58,6 +59,7 @@ namespace Elite
 		int m_sizeAttribute = 2;
 		unsigned int m_vaoId = 0;
 		unsigned int m_bufferIDs[1];
+		bool m_IsHeadless = false; //No OpenGL context, every draw is ignored
 
 		//Functions
 		void Shutdown();
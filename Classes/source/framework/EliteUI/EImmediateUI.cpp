@@ -13,11 +13,14 @@ GLint Elite::EImmediateUI::m_positionAttribute = 0, Elite::EImmediateUI::m_uvAtt
 Elite::EImmediateUI::~EImmediateUI()
 {
 	//Shutdown
-	glDeleteVertexArrays(1, &m_vaoID);
-	glDeleteBuffers(1, &m_vboID);
-	glDeleteBuffers(1, &m_elementsID);
-	glDeleteProgram(m_programID);
-	glDeleteTextures(1, &m_atlasTextureID);
+	if (!m_isHeadless)
+	{
+		glDeleteVertexArrays(1, &m_vaoID);
+		glDeleteBuffers(1, &m_vboID);
+		glDeleteBuffers(1, &m_elementsID);
+		glDeleteProgram(m_programID);
+		glDeleteTextures(1, &m_atlasTextureID);
+	}
 	ImGui::GetIO().Fonts->TexID = nullptr;
 	m_atlasTextureID = 0;
 	ImGui::Shutdown();
@@ -303,6 +306,33 @@ void Elite::EImmediateUI::NewFrame(EliteRawWindow pWindow, float deltaTime)
 	ImGui::NewFrame();
 }
 
+void Elite::EImmediateUI::InitializeHeadless(int width, int height)
+{
+	m_isHeadless = true;
+
+	//No draw function, ImGui::Render then only finishes the frame
+	ImGuiIO& io = ImGui::GetIO();
+	io.RenderDrawListsFn = nullptr;
+	io.DisplaySize = ImVec2((float)width, (float)height);
+	io.IniFilename = nullptr;
+
+	//The font atlas still has to be built before the first frame, on the CPU only
+	unsigned char* pixels;
+	int atlasWidth, atlasHeight;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+
+	SetupStyle();
+}
+
+void Elite::EImmediateUI::NewFrameHeadless(float deltaTime)
+{
+	//No mouse, no keys
+	ImGuiIO& io = ImGui::GetIO();
+	io.DeltaTime = deltaTime;
+	io.MousePos = ImVec2(-1, -1);
+	ImGui::NewFrame();
+}
+
 bool Elite::EImmediateUI::FocussedOnUI()
 {
 	ImGuiIO& io = ImGui::GetIO();
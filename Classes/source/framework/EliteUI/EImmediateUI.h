@@ -27,11 +27,16 @@ namespace Elite
 		void NewFrame(EliteRawWindow pWindow, float deltaTime);
 		bool FocussedOnUI();
 
+		//Without a window: the UI code of the apps still runs, nothing is drawn
+		void InitializeHeadless(int width, int height);
+		void NewFrameHeadless(float deltaTime);
+
 	private:
 		//--- Datamembers ---
 		static float m_sMouseWheel;
 		static bool m_sMousePressed[3];
 		unsigned int m_atlasTextureID = 0;
+		bool m_isHeadless = false;
 
 		static GLuint m_programID;
 		static GLuint m_vboID, m_vaoID, m_elementsID;
@@ -58,6 +63,8 @@ namespace Elite
 		static void StaticRender(ImDrawData* drawData){};
 		void NewFrame(EliteRawWindow pWindow, float deltaTime){};
 		bool FocussedOnUI() { return false; }
+		void InitializeHeadless(int width, int height){};
+		void NewFrameHeadless(float deltaTime){};
 	};
 #endif
 }
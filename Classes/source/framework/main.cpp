@@ -36,10 +36,131 @@
 //Hotfix for genetic algorithms project
 bool gRequestShutdown = false;
 
+//Application Creation
+IApp* CreateApp()
+{
+	IApp* myApp = nullptr;
+
+#ifdef ActiveApp_Sandbox
+	myApp = new App_Sandbox();
+#elif defined(ActiveApp_SteeringBehaviors)
+	myApp = new App_SteeringBehaviors();
+#elif defined(ActiveApp_CombinedSteering)
+	myApp = new App_CombinedSteering();
+#elif defined(ActiveApp_Flocking)
+	myApp = new App_Flocking();
+#elif defined(ActiveApp_GraphTheory)
+	myApp = new App_GraphTheory();
+#elif defined(ActiveApp_AStar)
+	myApp = new App_PathfindingAStar();
+#elif defined(ActiveApp_NavMeshGraph)
+	myApp = new App_NavMeshGraph();
+#elif defined(ActiveApp_FSM)
+	myApp = new App_AgarioGame();
+#elif defined(ActiveApp_BT)
+	myApp = new App_AgarioGame_BT();
+#elif defined(ActiveApp_InflueceMaps)
+	myApp = new App_InfluenceMap();
+#elif defined(ActiveApp_QLearning)
+	myApp = new App_MachineLearning();
+#endif
+	ELITE_ASSERT(myApp, "Application has not been created.");
+	return myApp;
+}
+
+//Headless: no window and no OpenGL context, the app and physics step with a fixed delta time as fast as they can
+//Debug drawing is ignored and the UI code runs without drawing, so the apps need no changes
+int RunHeadless(int nrOfTicks, float deltaTime, unsigned int seed)
+{
+	//Same random numbers every run
+	srand(seed);
+
+	Elite::WindowParams params;
+	Camera2D* pCamera = new Camera2D(params.width, params.height);
+	DEBUGRENDERER2D->InitializeHeadless(pCamera);
+
+	Elite::EImmediateUI* pImmediateUI = new Elite::EImmediateUI();
+	pImmediateUI->InitializeHeadless(params.width, params.height);
+
+	PHYSICSWORLD; //Boot
+	PROFILER;
+	TIMER->Start();
+
+	IApp* myApp = CreateApp();
+	myApp->Start();
+
+	int tick = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (; tick < nrOfTicks && !gRequestShutdown; ++tick)
+	{
+		PROFILER->BeginFrame();
+		pImmediateUI->NewFrameHeadless(deltaTime);
+		{
+			ELITE_PROFILE_SCOPE("PhysicsWorld::Simulate");
+			PHYSICSWORLD->Simulate(deltaTime);
+		}
+		{
+			ELITE_PROFILE_SCOPE("App::Update");
+			myApp->Update(deltaTime);
+		}
+		pImmediateUI->Render();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	const float seconds = std::chrono::duration<float>(end - start).count();
+
+	std::cout << tick << " ticks of " << deltaTime << " s in " << seconds << " s, "
+		<< (seconds > 0.f ? tick / seconds : 0.f) << " ticks/sec" << std::endl;
+
+	//Reversed Deletion
+	SAFE_DELETE(myApp);
+	SAFE_DELETE(pImmediateUI);
+	SAFE_DELETE(pCamera);
+
+	PHYSICSWORLD->Destroy();
+	DEBUGRENDERER2D->Destroy();
+	INPUTMANAGER->Destroy();
+	TIMER->Destroy();
+	PROFILER->Destroy();
+	return 0;
+}
+
 //Main
 #undef main //Undefine SDL_main as main
 int main(int argc, char* argv[])
 {
+	//GPP_Framework.exe --headless <ticks> [delta time] [seed]
+	if (argc >= 2 && string(argv[1]) == "--headless")
+	{
+		int nrOfTicks{};
+		float deltaTime{ 1.f / 60.f };
+		unsigned int seed{};
+		try
+		{
+			if (argc < 3) throw std::invalid_argument("--headless without a number of ticks");
+			nrOfTicks = stoi(string(argv[2]));
+			if (argc >= 4) deltaTime = stof(string(argv[3]));
+			if (argc >= 5) seed = static_cast<unsigned int>(stoul(string(argv[4])));
+			if (nrOfTicks <= 0) throw std::invalid_argument(argv[2]);
+			if (!(deltaTime > 0.f)) throw std::invalid_argument(argv[3]);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "Invalid argument " << e.what() << std::endl;
+			std::cout << "Usage: GPP_Framework --headless <ticks> [delta time] [seed], with ticks and delta time above 0" << std::endl;
+			return 1;
+		}
+
+		try
+		{
+			return RunHeadless(nrOfTicks, deltaTime, seed);
+		}
+		catch (const Elite_Exception& e)
+		{
+			std::cout << e._msg << " Error: " << std::endl;
+			return 1;
+		}
+	}
+
 	int x{}, y{};
 	bool runExeWithCoordinates{ argc == 3 };
 
@@ -78,36 +199,14 @@ int main(int argc, char* argv[])
 		//Create Physics
 		PHYSICSWORLD; //Boot
 
+		//Create Profiler, F1 shows its window
+		PROFILER;
+
 		//Start Timer
 		TIMER->Start();
 
 		//Application Creation
-		IApp* myApp = nullptr;
-
-#ifdef ActiveApp_Sandbox
-		myApp = new App_Sandbox();
-#elif defined(ActiveApp_SteeringBehaviors)
-		myApp = new App_SteeringBehaviors();
-#elif defined(ActiveApp_CombinedSteering)
-		myApp = new App_CombinedSteering();
-#elif defined(ActiveApp_Flocking)
-		myApp = new App_Flocking();
-#elif defined(ActiveApp_GraphTheory)
-		myApp = new App_GraphTheory();
-#elif defined(ActiveApp_AStar)
-		myApp = new App_PathfindingAStar();
-#elif defined(ActiveApp_NavMeshGraph)
-		myApp = new App_NavMeshGraph();
-#elif defined(ActiveApp_FSM)
-		myApp = new App_AgarioGame();
-#elif defined(ActiveApp_BT)
-		myApp = new App_AgarioGame_BT();
-#elif defined(ActiveApp_InflueceMaps)
-		myApp = new App_InfluenceMap();
-#elif defined(ActiveApp_QLearning)
-		myApp = new App_MachineLearning();
-#endif
-		ELITE_ASSERT(myApp, "Application has not been created.");
+		IApp* myApp = CreateApp();
 		//Boot application
 		myApp->Start();
 
@@ -115,6 +214,7 @@ int main(int argc, char* argv[])
 		while (!pWindow->ShutdownRequested())
 		{
 			//Timer
+			PROFILER->BeginFrame();
 			TIMER->Update();
 			auto const elapsed = TIMER->GetElapsed();
 
@@ -128,14 +228,27 @@ int main(int argc, char* argv[])
 			pImmediateUI->NewFrame(pWindow->GetRawWindowHandle(), elapsed);
 
 			//Update (Physics, App)
-			PHYSICSWORLD->Simulate(elapsed);
+			{
+				ELITE_PROFILE_SCOPE("PhysicsWorld::Simulate");
+				PHYSICSWORLD->Simulate(elapsed);
+			}
 			pCamera->Update();
-			myApp->Update(elapsed);
+			{
+				ELITE_PROFILE_SCOPE("App::Update");
+				myApp->Update(elapsed);
+			}
 
 			//Render and Present Frame
-			PHYSICSWORLD->RenderDebug();
-			myApp->Render(elapsed);
-			pFrame->SubmitAndFlipFrame(pImmediateUI);
+			{
+				ELITE_PROFILE_SCOPE("App::Render");
+				PHYSICSWORLD->RenderDebug();
+				myApp->Render(elapsed);
+			}
+			PROFILER->UpdateAndRenderUI();
+			{
+				ELITE_PROFILE_SCOPE("SubmitAndFlipFrame");
+				pFrame->SubmitAndFlipFrame(pImmediateUI);
+			}
 		}
 
 		//Reversed Deletion
@@ -150,6 +263,7 @@ int main(int argc, char* argv[])
 		DEBUGRENDERER2D->Destroy();
 		INPUTMANAGER->Destroy();
 		TIMER->Destroy();
+		PROFILER->Destroy();
 	}
 	catch (const Elite_Exception& e)
 	{
@@ -67,7 +67,7 @@ void App_AgarioGame_BT::Start()
 		Elite::Blackboard* pBlackboard = CreateBlackboard(newAgent);
 		
 		//2. Create BehaviorTree
-		Elite::BehaviorTree* pBehaviorTree{ new Elite::BehaviorTree{pBlackboard
+		Elite::CompiledBehaviorTree* pBehaviorTree{ new Elite::CompiledBehaviorTree{pBlackboard
 											, new BehaviorAction{ChangeToWander}} };
 
 		//3. Set the BehaviorTree active on the agent 
@@ -91,7 +91,7 @@ void App_AgarioGame_BT::Start()
 	Elite::Blackboard* pBlackboard = CreateBlackboard(m_pUberAgent);
 
 	//2. Create BehaviorTree
-	Elite::BehaviorTree* pBehaviorTree{ new Elite::BehaviorTree{pBlackboard,
+	Elite::CompiledBehaviorTree* pBehaviorTree{ new Elite::CompiledBehaviorTree{pBlackboard,
 										new BehaviorSelector{
 											{
 												new BehaviorSelector
@@ -18,6 +18,7 @@ bool App_NavMeshGraph::sShowGraph = false;
 bool App_NavMeshGraph::sDrawPortals = false;
 bool App_NavMeshGraph::sDrawFinalPath = true;
 bool App_NavMeshGraph::sDrawNonOptimisedPath = false;
+bool App_NavMeshGraph::sUseTiledNavMesh = false;
 
 //Destructor
 App_NavMeshGraph::~App_NavMeshGraph()
@@ -47,10 +48,8 @@ void App_NavMeshGraph::Start()
 	m_vNavigationColliders.push_back(new NavigationColliderElement(Elite::Vector2(15.f, -21.f), 50.0f, 3.0f));
 
 	//----------- NAVMESH  ------------
-	std::list<Elite::Vector2> baseBox
-	{ { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
-
-	m_pNavGraph = new Elite::NavGraph(Elite::Polygon(baseBox), m_AgentRadius);
+	m_NavMeshContour = { { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
+	CreateNavGraph();
 
 	//----------- AGENT ------------
 	m_pSeekBehavior = new Seek();
@@ -75,6 +74,17 @@ void App_NavMeshGraph::Update(float deltaTime)
 		Elite::Vector2 mouseTarget = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
 			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
 		m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, m_pNavGraph, m_DebugNodePositions, m_Portals);
+		m_PathTarget = mouseTarget;
+		m_HasPathTarget = true;
+	}
+
+	//Add or remove a collider, only the tiles around it are rebuilt when the navigation mesh is tiled
+	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eRight))
+	{
+		auto mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eRight);
+		Elite::Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
+			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
+		ToggleColliderAtPosition(mousePos);
 	}
 
 	//Check if a path exist and move to the following point
@@ -113,10 +123,13 @@ void App_NavMeshGraph::Render(float deltaTime) const
 
 	if (sShowPolygon)
 	{
-		DEBUGRENDERER2D->DrawPolygon(m_pNavGraph->GetNavMeshPolygon(),
-			Color(0.1f, 0.1f, 0.1f));
-		DEBUGRENDERER2D->DrawSolidPolygon(m_pNavGraph->GetNavMeshPolygon(),
-			Color(0.0f, 0.5f, 0.1f, 0.05f), 0.4f);
+		for (Elite::Polygon* pPolygon : m_pNavGraph->GetNavMeshPolygons())
+		{
+			DEBUGRENDERER2D->DrawPolygon(pPolygon,
+				Color(0.1f, 0.1f, 0.1f));
+			DEBUGRENDERER2D->DrawSolidPolygon(pPolygon,
+				Color(0.0f, 0.5f, 0.1f, 0.05f), 0.4f);
+		}
 	}
 
 	if (sDrawPortals)
@@ -160,6 +173,78 @@ void App_NavMeshGraph::Render(float deltaTime) const
 
 }
 
+void App_NavMeshGraph::CreateNavGraph()
+{
+	SAFE_DELETE(m_pNavGraph);
+	m_vObstacleIds.clear();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	if (sUseTiledNavMesh)
+	{
+		//The obstacles get the ids 0, 1, 2, ... in the order they are passed in
+		std::vector<Elite::Polygon> obstacles{};
+		for (const NavigationColliderElement* pNC : m_vNavigationColliders)
+		{
+			m_vObstacleIds.push_back((int)obstacles.size());
+			obstacles.push_back(pNC->GetNavigationShape());
+		}
+		m_pNavGraph = new Elite::NavGraph(Elite::Polygon(m_NavMeshContour), obstacles, m_AgentRadius, m_TileSize);
+	}
+	else
+	{
+		m_pNavGraph = new Elite::NavGraph(Elite::Polygon(m_NavMeshContour), m_AgentRadius);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	m_NrOfRebuiltTiles = m_pNavGraph->GetNrOfTiles();
+	m_RebuildTime = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void App_NavMeshGraph::ToggleColliderAtPosition(const Elite::Vector2& position)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	//1. Remove the collider under the mouse, or add a new one
+	auto it = std::find_if(m_vNavigationColliders.begin(), m_vNavigationColliders.end(),
+		[&position](const NavigationColliderElement* pNC) { return pNC->IsPointInside(position); });
+	if (it != m_vNavigationColliders.end())
+	{
+		const size_t idx = it - m_vNavigationColliders.begin();
+		if (sUseTiledNavMesh)
+		{
+			m_pNavGraph->RemoveObstacle(m_vObstacleIds[idx]);
+			m_vObstacleIds.erase(m_vObstacleIds.begin() + idx);
+		}
+		SAFE_DELETE(*it);
+		m_vNavigationColliders.erase(it);
+	}
+	else
+	{
+		NavigationColliderElement* pNC = new NavigationColliderElement(position, 4.0f, 4.0f);
+		if (sUseTiledNavMesh)
+		{
+			m_vObstacleIds.push_back(m_pNavGraph->AddObstacle(pNC->GetNavigationShape()));
+		}
+		m_vNavigationColliders.push_back(pNC);
+	}
+
+	//2. Without tiles the whole navigation mesh has to be rebuilt
+	if (sUseTiledNavMesh)
+	{
+		auto end = std::chrono::high_resolution_clock::now();
+		m_NrOfRebuiltTiles = m_pNavGraph->GetNrOfRebuiltTiles();
+		m_RebuildTime = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+	else
+	{
+		CreateNavGraph();
+	}
+
+	//3. The old path can run through the new collider
+	if (m_HasPathTarget)
+		m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), m_PathTarget, m_pNavGraph, m_DebugNodePositions, m_Portals);
+}
+
 void App_NavMeshGraph::UpdateImGui()
 {
 	//------- UI --------
@@ -180,6 +265,9 @@ void App_NavMeshGraph::UpdateImGui()
 		//Elements
 		ImGui::Text("CONTROLS");
 		ImGui::Indent();
+		ImGui::Text("MMB: target");
+		ImGui::Text("RMB: add/remove");
+		ImGui::Text("collider");
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -191,6 +279,8 @@ void App_NavMeshGraph::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("%d tiles rebuilt", m_NrOfRebuiltTiles);
+		ImGui::Text("%.3f ms rebuild", m_RebuildTime);
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -203,6 +293,11 @@ void App_NavMeshGraph::UpdateImGui()
 		ImGui::Checkbox("Show Portals", &sDrawPortals);
 		ImGui::Checkbox("Show Path Nodes", &sDrawNonOptimisedPath);
 		ImGui::Checkbox("Show Final Path", &sDrawFinalPath);
+		if (ImGui::Checkbox("Tiled NavMesh", &sUseTiledNavMesh))
+		{
+			CreateNavGraph();
+			m_vPath.clear();
+		}
 		ImGui::Spacing();
 		ImGui::Spacing();
 
@@ -210,6 +305,12 @@ void App_NavMeshGraph::UpdateImGui()
 		{
 			m_pAgent->SetMaxLinearSpeed(m_AgentSpeed);
 		}
+		ImGui::Spacing();
+
+		if (ImGui::Button("Benchmark"))
+		{
+			RunBenchmark();
+		}
 		
 		//End
 		ImGui::PopAllowKeyboardFocus();
@@ -217,4 +318,157 @@ void App_NavMeshGraph::UpdateImGui()
 	}
 #pragma endregion
 #endif
+}
+
+void App_NavMeshGraph::RunBenchmark() const
+{
+	//Field of small obstacles, passed in directly so the physics world is left alone
+	const float spacing = 10.f;
+	std::mt19937 rng{ 3 };
+	std::uniform_real_distribution<float> jitter{ -1.f, 1.f };
+	auto createObstacles = [&](int columns, int rows)
+	{
+		const float width = columns * spacing;
+		const float height = rows * spacing;
+		std::vector<Elite::Polygon> obstacles{};
+		for (int col = 0; col < columns; ++col)
+		{
+			for (int row = 0; row < rows; ++row)
+			{
+				Elite::Vector2 center{ col * spacing + spacing / 2.f - width / 2.f + jitter(rng), row * spacing + spacing / 2.f - height / 2.f + jitter(rng) };
+				std::vector<Elite::Vector2> points{ { center.x - 2.f, center.y - 2.f }, { center.x + 2.f, center.y - 2.f }, { center.x + 2.f, center.y + 2.f }, { center.x - 2.f, center.y + 2.f } };
+				obstacles.push_back(Elite::Polygon(points));
+			}
+		}
+		return obstacles;
+	};
+	auto createContour = [&](int columns, int rows)
+	{
+		const float width = columns * spacing;
+		const float height = rows * spacing;
+		return std::list<Elite::Vector2>{ { -width / 2.f, height / 2.f }, { -width / 2.f, -height / 2.f }, { width / 2.f, -height / 2.f }, { width / 2.f, height / 2.f } };
+	};
+
+	//Build times for growing fields: triangulation only, and the complete NavGraph (triangulation + nodes + connections)
+	std::cout << "--- NavMesh Benchmark ---" << std::endl;
+	const std::vector<std::pair<int, int>> fieldSizes{ { 10, 5 }, { 20, 10 }, { 40, 20 }, { 80, 40 }, { 160, 80 } };
+	for (const auto& fieldSize : fieldSizes)
+	{
+		const auto obstacles = createObstacles(fieldSize.first, fieldSize.second);
+		auto contour = createContour(fieldSize.first, fieldSize.second);
+
+		Elite::Polygon navMesh{ contour };
+		for (auto shape : obstacles)
+		{
+			shape.ExpandShape(m_AgentRadius);
+			navMesh.AddChild(shape);
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		navMesh.Triangulate();
+		auto middle = std::chrono::high_resolution_clock::now();
+		NavGraph navGraph{ Elite::Polygon(contour), obstacles, m_AgentRadius };
+		auto end = std::chrono::high_resolution_clock::now();
+
+		std::cout << obstacles.size() << " obstacles, " << navMesh.GetTriangles().size() << " triangles: triangulate "
+			<< std::chrono::duration<float, std::milli>(middle - start).count() << " ms, NavGraph "
+			<< std::chrono::duration<float, std::milli>(end - middle).count() << " ms" << std::endl;
+	}
+
+	//Navmesh with thousands of triangles for the queries
+	const int columns = 30;
+	const int rows = 15;
+	const float width = columns * spacing;
+	const float height = rows * spacing;
+	const auto obstacles = createObstacles(columns, rows);
+	auto contour = createContour(columns, rows);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	NavGraph navGraph{ Elite::Polygon(contour), obstacles, m_AgentRadius };
+	auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << obstacles.size() << " obstacles, " << navGraph.GetNavMeshPolygon()->GetTriangles().size() << " triangles, "
+		<< navGraph.GetNrOfNodes() << " nodes, build " << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+	//Adding one obstacle between the others: rebuild the whole navigation mesh vs only the tiles it overlaps
+	{
+		const std::vector<Elite::Vector2> newObstaclePoints{ { -0.5f, 4.5f }, { 0.5f, 4.5f }, { 0.5f, 5.5f }, { -0.5f, 5.5f } };
+		auto extendedObstacles = obstacles;
+		extendedObstacles.push_back(Elite::Polygon(newObstaclePoints));
+		NavGraph tiledNavGraph{ Elite::Polygon(contour), obstacles, m_AgentRadius, 2.f * spacing };
+
+		start = std::chrono::high_resolution_clock::now();
+		NavGraph rebuiltNavGraph{ Elite::Polygon(contour), extendedObstacles, m_AgentRadius };
+		auto middle = std::chrono::high_resolution_clock::now();
+		tiledNavGraph.AddObstacle(Elite::Polygon(newObstaclePoints));
+		end = std::chrono::high_resolution_clock::now();
+
+		std::cout << "Add obstacle: full rebuild " << std::chrono::duration<float, std::milli>(middle - start).count() << " ms, tiled "
+			<< std::chrono::duration<float, std::milli>(end - middle).count() << " ms (" << tiledNavGraph.GetNrOfRebuiltTiles() << " of "
+			<< tiledNavGraph.GetNrOfTiles() << " tiles)" << std::endl;
+	}
+
+	//Same queries on a copy of the graph and with virtual start/end nodes, the paths should be identical
+	const int nrOfQueries = 100;
+	std::uniform_real_distribution<float> randomX{ -width / 2.f, width / 2.f };
+	std::uniform_real_distribution<float> randomY{ -height / 2.f, height / 2.f };
+	std::vector<Elite::Vector2> debugNodePositions{};
+	std::vector<Elite::Portal> debugPortals{};
+	float cloneTime{}, overlayTime{};
+	int nrOfDifferentPaths{};
+	for (int q = 0; q < nrOfQueries; ++q)
+	{
+		const Elite::Vector2 startPos{ randomX(rng), randomY(rng) };
+		const Elite::Vector2 endPos{ randomX(rng), randomY(rng) };
+
+		start = std::chrono::high_resolution_clock::now();
+		auto clonePath = NavMeshPathfinding::FindPathOnClone(startPos, endPos, &navGraph, debugNodePositions, debugPortals);
+		auto middle = std::chrono::high_resolution_clock::now();
+		auto overlayPath = NavMeshPathfinding::FindPath(startPos, endPos, &navGraph, debugNodePositions, debugPortals);
+		end = std::chrono::high_resolution_clock::now();
+
+		cloneTime += std::chrono::duration<float, std::milli>(middle - start).count();
+		overlayTime += std::chrono::duration<float, std::milli>(end - middle).count();
+		if (clonePath != overlayPath)
+			++nrOfDifferentPaths;
+	}
+
+	std::cout << "Clone: " << cloneTime / nrOfQueries << " ms/query, virtual start/end: " << overlayTime / nrOfQueries << " ms/query, "
+		<< navGraph.GetNrOfNodes() << " nodes after the queries" << std::endl;
+	if (nrOfDifferentPaths > 0)
+		std::cout << "WARNING: " << nrOfDifferentPaths << " paths differ" << std::endl;
+
+	//Point location: spatial index of the polygon vs testing every triangle
+	const Elite::Polygon* pNavMesh = navGraph.GetNavMeshPolygon();
+	const auto& triangles = pNavMesh->GetTriangles();
+	const int nrOfLookups = 10000;
+	std::vector<Elite::Vector2> lookupPositions{};
+	for (int i = 0; i < nrOfLookups; ++i)
+		lookupPositions.push_back({ randomX(rng), randomY(rng) });
+
+	int nrOfDifferentTriangles{};
+	start = std::chrono::high_resolution_clock::now();
+	std::vector<const Elite::Triangle*> indexedTriangles{};
+	for (const auto& pos : lookupPositions)
+		indexedTriangles.push_back(pNavMesh->GetTriangleFromPosition(pos));
+	auto middle = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < nrOfLookups; ++i)
+	{
+		const Elite::Triangle* pFound = nullptr;
+		for (const auto pTriangle : triangles)
+		{
+			if (Elite::PointInTriangle(lookupPositions[i], pTriangle->p1, pTriangle->p2, pTriangle->p3))
+			{
+				pFound = pTriangle;
+				break;
+			}
+		}
+		if (pFound != indexedTriangles[i])
+			++nrOfDifferentTriangles;
+	}
+	end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "Triangle lookup: " << std::chrono::duration<float, std::micro>(middle - start).count() / nrOfLookups << " us indexed, "
+		<< std::chrono::duration<float, std::micro>(end - middle).count() / nrOfLookups << " us linear" << std::endl;
+	if (nrOfDifferentTriangles > 0)
+		std::cout << "WARNING: " << nrOfDifferentTriangles << " lookups differ" << std::endl;
 }
\ No newline at end of file
@@ -45,13 +45,20 @@ private:
 
 	// --Level--
 	std::vector<NavigationColliderElement*> m_vNavigationColliders = {};
+	std::vector<int> m_vObstacleIds = {}; //Obstacle id of every collider in the tiled navigation mesh
+	std::vector<Elite::Vector2> m_NavMeshContour = {};
 
 	// --Pathfinder--
 	std::vector<Elite::Vector2> m_vPath;
+	Elite::Vector2 m_PathTarget = {};
+	bool m_HasPathTarget = false;
 
 	// --Graph--
 	Elite::NavGraph* m_pNavGraph = nullptr;
 	Elite::GraphRenderer m_GraphRenderer{};
+	float m_TileSize = 10.f;
+	int m_NrOfRebuiltTiles = 0;
+	float m_RebuildTime = 0.f;
 
 	// --Debug drawing information--
 	std::vector<Elite::Portal> m_Portals;
@@ -61,8 +68,12 @@ private:
 	static bool sDrawPortals;
 	static bool sDrawFinalPath;
 	static bool sDrawNonOptimisedPath;
+	static bool sUseTiledNavMesh;
 
+	void CreateNavGraph();
+	void ToggleColliderAtPosition(const Elite::Vector2& position);
 	void UpdateImGui();
+	void RunBenchmark() const;
 private:
 	//C++ make the class non-copyable
 	App_NavMeshGraph(const App_NavMeshGraph&) = delete;
@@ -11,6 +11,10 @@ using namespace Elite;
 //Destructor
 App_PathfindingAStar::~App_PathfindingAStar()
 {
+	SAFE_DELETE(m_pPathRequestQueue);
+	SAFE_DELETE(m_pHPAStar);
+	SAFE_DELETE(m_pJPS);
+	SAFE_DELETE(m_pSearchContext);
 	SAFE_DELETE(m_pGridGraph);
 }
 
@@ -57,9 +61,13 @@ void App_PathfindingAStar::Update(float deltaTime)
 	//IMGUI
 	UpdateImGui();
 
+	//Deliver paths of async requests
+	m_pPathRequestQueue->Update();
+
 	//UPDATE/CHECK GRID HAS CHANGED
 	if (m_GraphEditor.UpdateGraph(m_pGridGraph))
 	{
+		m_pHPAStar->OnNodeChanged(m_GraphEditor.GetLastChangedNodeIdx());
 		CalculatePath();
 	}
 }
@@ -98,7 +106,11 @@ void App_PathfindingAStar::Render(float deltaTime) const
 
 void App_PathfindingAStar::MakeGridGraph()
 {
-	m_pGridGraph = new GridGraph<GridTerrainNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, false, 1.f, 1.5f);
+	m_pGridGraph = new GridGraph<GridTerrainNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, m_bConnectDiagonally, 1.f, 1.5f);
+	m_pSearchContext = new SearchContext<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	m_pJPS = new JPS<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+	m_pHPAStar = new HPAStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction, 5);
+	m_pPathRequestQueue = new PathRequestQueue<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
 
 	//Setup default terrain
 	m_pGridGraph->GetNode(86)->SetTerrainType(TerrainType::Water);
@@ -111,6 +123,41 @@ void App_PathfindingAStar::MakeGridGraph()
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(47);
 }
 
+void App_PathfindingAStar::SetConnectedDiagonally(bool isConnectedDiagonally)
+{
+	if (m_bConnectDiagonally == isConnectedDiagonally)
+		return;
+
+	//Keep the painted terrain, the grid and everything searching it get made again
+	std::vector<TerrainType> terrainTypes{};
+	terrainTypes.reserve(m_pGridGraph->GetNrOfNodes());
+	for (int idx = 0; idx < m_pGridGraph->GetNrOfNodes(); ++idx)
+		terrainTypes.push_back(m_pGridGraph->GetNode(idx)->GetTerrainType());
+
+	m_vPath.clear();
+	SAFE_DELETE(m_pPathRequestQueue);
+	SAFE_DELETE(m_pHPAStar);
+	SAFE_DELETE(m_pJPS);
+	SAFE_DELETE(m_pSearchContext);
+	SAFE_DELETE(m_pGridGraph);
+
+	m_bConnectDiagonally = isConnectedDiagonally;
+	MakeGridGraph();
+
+	//Same connection changes as the graph editor makes when painting a node
+	for (int idx = 0; idx < static_cast<int>(terrainTypes.size()); ++idx)
+	{
+		if (terrainTypes[idx] == m_pGridGraph->GetNode(idx)->GetTerrainType())
+			continue;
+
+		m_pGridGraph->GetNode(idx)->SetTerrainType(terrainTypes[idx]);
+		m_pGridGraph->RemoveConnectionsToAdjacentNodes(idx);
+		if (terrainTypes[idx] != TerrainType::Water)
+			m_pGridGraph->AddConnectionsToAdjacentCells(idx);
+		m_pHPAStar->OnNodeChanged(idx);
+	}
+}
+
 void App_PathfindingAStar::UpdateImGui()
 {
 #ifdef PLATFORM_WINDOWS
@@ -140,6 +187,17 @@ void App_PathfindingAStar::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("%u queries", m_pSearchContext->GetNrOfQueries());
+		ImGui::Text("%u allocs", m_pSearchContext->GetNrOfAllocations());
+		ImGui::Text("%u expanded", m_NrOfExpandedNodes);
+		if (m_bUseJPS && m_HasJPSUsedFallback)
+			ImGui::Text("JPS: A* fallback");
+		if (m_bUseHPAStar)
+		{
+			ImGui::Text("%d clusters", m_pHPAStar->GetNrOfClusters());
+			ImGui::Text("%d entrances", m_pHPAStar->GetNrOfAbstractNodes());
+			ImGui::Text("%u rebuilt", m_pHPAStar->GetNrOfRebuiltClusters());
+		}
 		ImGui::Unindent();
 
 		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
@@ -188,6 +246,43 @@ void App_PathfindingAStar::UpdateImGui()
 				break;
 			}
 		}
+		if (ImGui::Checkbox("Binary Heap", &m_bUseBinaryHeap))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("CSR", &m_bUseCSR))
+		{
+			CalculatePath();
+		}
+		bool isConnectedDiagonally = m_bConnectDiagonally;
+		if (ImGui::Checkbox("Diagonal", &isConnectedDiagonally))
+		{
+			//JPS only searches diagonally connected grids
+			SetConnectedDiagonally(isConnectedDiagonally);
+			if (!m_bConnectDiagonally)
+				m_bUseJPS = false;
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("JPS", &m_bUseJPS))
+		{
+			if (m_bUseJPS)
+				SetConnectedDiagonally(true);
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("HPA*", &m_bUseHPAStar))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Async", &m_bUseAsyncRequests))
+		{
+			CalculatePath();
+		}
+		ImGui::Spacing();
+
+		if (ImGui::Button("Benchmark"))
+		{
+			RunBenchmark();
+		}
 		ImGui::Spacing();
 
 		//End
@@ -205,12 +300,45 @@ void App_PathfindingAStar::CalculatePath()
 		&& endPathIdx != invalid_node_index
 		&& startPathIdx != endPathIdx)
 	{
-		//BFS Pathfinding
-		auto pathfinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+		//A* Pathfinding
+		auto pathfinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction,
+			m_bUseBinaryHeap ? AStarMode::BinaryHeap : AStarMode::OpenList);
+		pathfinder.SetUseCSR(m_bUseCSR);
 		auto startNode = m_pGridGraph->GetNode(startPathIdx);
 		auto endNode = m_pGridGraph->GetNode(endPathIdx);
 
-		m_vPath = pathfinder.FindPath(startNode, endNode);
+		if (m_bUseAsyncRequests)
+		{
+			//Solved on a worker thread, the path arrives in a later Update
+			m_pPathRequestQueue->SetHeuristicFunction(m_pHeuristicFunction);
+			m_pPathRequestQueue->Submit(startNode, endNode, [this](const std::vector<GridTerrainNode*>& path) { m_vPath = path; });
+			m_NrOfExpandedNodes = 0;
+		}
+		else if (m_bUseHPAStar)
+		{
+			//Hierarchical search over the clusters, only the clusters touched by grid edits get rebuilt
+			m_pHPAStar->SetHeuristicFunction(m_pHeuristicFunction);
+			m_vPath = m_pHPAStar->FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = 0;
+		}
+		else if (m_bUseJPS)
+		{
+			//Jump Point Search, falls back to A* when the grid does not have uniform costs
+			m_pJPS->SetHeuristicFunction(m_pHeuristicFunction);
+			m_vPath = m_pJPS->FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = m_pJPS->GetNrOfExpandedNodes();
+			m_HasJPSUsedFallback = m_pJPS->HasUsedFallback();
+		}
+		else if (m_bUseBinaryHeap)
+		{
+			m_vPath = pathfinder.FindPath(startNode, endNode, *m_pSearchContext);
+			m_NrOfExpandedNodes = m_pSearchContext->GetNrOfExpandedNodes();
+		}
+		else
+		{
+			m_vPath = pathfinder.FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = 0;
+		}
 
 
 		std::cout << "New Path Calculated" << std::endl;
@@ -221,3 +349,202 @@ void App_PathfindingAStar::CalculatePath()
 		m_vPath.clear();
 	}
 }
+
+void App_PathfindingAStar::RunBenchmark() const
+{
+	//Compares both A* modes on square grids of increasing size
+	//A wall in the middle column forces the search around it, so a good part of the grid gets expanded
+	const std::vector<int> gridSizes{ 32, 64, 128, 256 };
+	const std::vector<AStarMode> modes{ AStarMode::OpenList, AStarMode::BinaryHeap };
+	const std::vector<std::string> modeNames{ "OpenList", "BinaryHeap" };
+
+	std::cout << "--- A* Benchmark ---" << std::endl;
+	for (int size : gridSizes)
+	{
+		GridGraph<GridTerrainNode, GraphConnection> grid{ size, size, (int)m_SizeCell, false, true, 1.f, 1.5f };
+		const int wallCol = size / 2;
+		for (int row = 0; row < size - size / 4; ++row)
+		{
+			grid.GetNode(wallCol, row)->SetTerrainType(TerrainType::Water);
+			grid.RemoveConnectionsToAdjacentNodes(grid.GetIndex(wallCol, row));
+		}
+
+		auto pStartNode = grid.GetNode(0, 0);
+		auto pEndNode = grid.GetNode(size - 1, 0);
+
+		std::vector<float> pathCosts{};
+		for (size_t m = 0; m < modes.size(); ++m)
+		{
+			auto pathfinder = AStar<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction, modes[m]);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			auto path = pathfinder.FindPath(pStartNode, pEndNode);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			float pathCost{};
+			for (size_t i = 1; i < path.size(); ++i)
+				pathCost += grid.GetConnection(path[i - 1]->GetIndex(), path[i]->GetIndex())->GetCost();
+			pathCosts.push_back(pathCost);
+
+			std::cout << size << "x" << size << " " << modeNames[m] << ": "
+				<< std::chrono::duration<float, std::milli>(end - start).count() << " ms, "
+				<< path.size() << " nodes, cost " << pathCost << std::endl;
+		}
+
+		if (abs(pathCosts[0] - pathCosts[1]) > 0.001f)
+			std::cout << "WARNING: path costs differ between modes" << std::endl;
+
+		//Repeated queries on a reused search context should stop allocating after the first one
+		//Run them on the connection lists and on the CSR snapshot
+		const int nrOfQueries = 100;
+		for (bool useCSR : { false, true })
+		{
+			auto pathfinder = AStar<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction);
+			pathfinder.SetUseCSR(useCSR);
+			SearchContext<GridTerrainNode, GraphConnection> context{ &grid };
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int q = 0; q < nrOfQueries; ++q)
+				pathfinder.FindPath(pStartNode, pEndNode, context);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			std::cout << size << "x" << size << " SearchContext" << (useCSR ? " + CSR: " : ": ")
+				<< std::chrono::duration<float, std::milli>(end - start).count() / nrOfQueries << " ms/query, "
+				<< context.GetNrOfExpandedNodes() << " expanded, "
+				<< context.GetNrOfAllocations() << " allocations over " << context.GetNrOfQueries() << " queries" << std::endl;
+		}
+
+		//Jump Point Search on the same queries, the first query includes the eligibility check of the grid
+		{
+			auto pathfinder = JPS<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction);
+			pathfinder.FindPath(pStartNode, pEndNode);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			std::vector<GridTerrainNode*> path{};
+			for (int q = 0; q < nrOfQueries; ++q)
+				path = pathfinder.FindPath(pStartNode, pEndNode);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			float pathCost{};
+			for (size_t i = 1; i < path.size(); ++i)
+				pathCost += grid.GetConnection(path[i - 1]->GetIndex(), path[i]->GetIndex())->GetCost();
+
+			std::cout << size << "x" << size << " JPS" << (pathfinder.HasUsedFallback() ? " (A* fallback): " : ": ")
+				<< std::chrono::duration<float, std::milli>(end - start).count() / nrOfQueries << " ms/query, "
+				<< pathfinder.GetNrOfExpandedNodes() << " expanded, cost " << pathCost << std::endl;
+		}
+
+		//HPA*: building the hierarchy, queries and rebuilding after a single cell changed
+		{
+			const int clusterSize = 16;
+			auto pathfinder = HPAStar<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction, clusterSize);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			pathfinder.Build();
+			auto middle = std::chrono::high_resolution_clock::now();
+			std::vector<GridTerrainNode*> path{};
+			for (int q = 0; q < nrOfQueries; ++q)
+				path = pathfinder.FindPath(pStartNode, pEndNode);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			float pathCost{};
+			for (size_t i = 1; i < path.size(); ++i)
+				pathCost += grid.GetConnection(path[i - 1]->GetIndex(), path[i]->GetIndex())->GetCost();
+
+			std::cout << size << "x" << size << " HPA* (" << pathfinder.GetNrOfClusters() << " clusters, " << pathfinder.GetNrOfAbstractNodes() << " entrances): build "
+				<< std::chrono::duration<float, std::milli>(middle - start).count() << " ms, "
+				<< std::chrono::duration<float, std::milli>(end - middle).count() / nrOfQueries << " ms/query, cost " << pathCost << std::endl;
+
+			//Open up the wall at the row just below the first cluster row, as the grid editor would
+			const int changedIdx = grid.GetIndex(wallCol, clusterSize);
+			grid.GetNode(changedIdx)->SetTerrainType(TerrainType::Ground);
+			grid.AddConnectionsToAdjacentCells(changedIdx);
+
+			pathfinder.ResetCounters();
+			start = std::chrono::high_resolution_clock::now();
+			pathfinder.OnNodeChanged(changedIdx);
+			path = pathfinder.FindPath(pStartNode, pEndNode);
+			end = std::chrono::high_resolution_clock::now();
+
+			std::cout << size << "x" << size << " HPA* after edit: " << pathfinder.GetNrOfRebuiltClusters() << " clusters rebuilt, "
+				<< std::chrono::duration<float, std::milli>(end - start).count() << " ms incl. query" << std::endl;
+
+			//Restore the wall for the measurements below
+			grid.GetNode(changedIdx)->SetTerrainType(TerrainType::Water);
+			grid.RemoveConnectionsToAdjacentNodes(changedIdx);
+		}
+
+		//Burst of requests from many agents, as a quarter of them ask for the same path: solved synchronously vs through the request queue
+		//For the queue, the interesting number is the longest Update on the calling thread
+		{
+			const int nrOfRequests = 400;
+			std::vector<std::pair<GridTerrainNode*, GridTerrainNode*>> requests{};
+			for (int r = 0; r < nrOfRequests; ++r)
+			{
+				if (r % 4 == 3)
+					requests.push_back(requests[r - 1]);
+				else
+					requests.push_back({ grid.GetNode(r % size, (r * 7) % size), grid.GetNode(size - 1 - (r * 3) % size, (r * 5) % size) });
+			}
+
+			auto pathfinder = AStar<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction);
+			pathfinder.SetUseCSR(true);
+			SearchContext<GridTerrainNode, GraphConnection> context{ &grid };
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (const auto& request : requests)
+				pathfinder.FindPath(request.first, request.second, context);
+			auto end = std::chrono::high_resolution_clock::now();
+			const float syncTime = std::chrono::duration<float, std::milli>(end - start).count();
+
+			PathRequestQueue<GridTerrainNode, GraphConnection> queue{ &grid, m_pHeuristicFunction };
+			int nrOfDelivered{}, nrOfFrames{};
+			float longestUpdate{};
+			start = std::chrono::high_resolution_clock::now();
+			for (const auto& request : requests)
+				queue.Submit(request.first, request.second, [&nrOfDelivered](const std::vector<GridTerrainNode*>&) { ++nrOfDelivered; });
+			while (nrOfDelivered < nrOfRequests)
+			{
+				auto frameStart = std::chrono::high_resolution_clock::now();
+				queue.Update();
+				auto frameEnd = std::chrono::high_resolution_clock::now();
+				const float updateTime = std::chrono::duration<float, std::milli>(frameEnd - frameStart).count();
+				longestUpdate = (updateTime > longestUpdate) ? updateTime : longestUpdate;
+				++nrOfFrames;
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			end = std::chrono::high_resolution_clock::now();
+
+			std::cout << size << "x" << size << " " << nrOfRequests << " requests: sync " << syncTime << " ms, async ("
+				<< queue.GetNrOfWorkers() << " workers, " << queue.GetNrOfMergedRequests() << " merged) "
+				<< std::chrono::duration<float, std::milli>(end - start).count() << " ms over " << nrOfFrames << " frames, longest Update "
+				<< longestUpdate << " ms" << std::endl;
+		}
+
+		//Memory: every connection in the lists is a heap allocated connection + a list node (2 links + pointer)
+		const size_t listMemory = grid.GetNrOfNodes() * sizeof(std::list<GraphConnection*>)
+			+ grid.GetNrOfConnections() * (sizeof(GraphConnection) + sizeof(GraphConnection*) + 2 * sizeof(void*));
+		const GraphCSR& csr = grid.GetCSR();
+		std::cout << size << "x" << size << " Memory: lists " << listMemory / 1024 << " KB, CSR " << csr.GetMemoryUsage() / 1024 << " KB" << std::endl;
+
+		//Traversal: visit every connection of every node
+		float listSum{}, csrSum{};
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int idx = 0; idx < grid.GetNrOfNodes(); ++idx)
+		{
+			for (auto pConnection : grid.GetNodeConnections(idx))
+				listSum += grid.GetNode(pConnection->GetTo())->GetIndex() * pConnection->GetCost();
+		}
+		auto middle = std::chrono::high_resolution_clock::now();
+		for (int idx = 0; idx < csr.GetNrOfNodes(); ++idx)
+		{
+			for (int i = csr.GetBegin(idx); i < csr.GetEnd(idx); ++i)
+				csrSum += csr.GetNeighbor(i) * csr.GetCost(i);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		std::cout << size << "x" << size << " Traversal: lists "
+			<< std::chrono::duration<float, std::milli>(middle - start).count() << " ms, CSR "
+			<< std::chrono::duration<float, std::milli>(end - middle).count() << " ms"
+			<< (listSum == csrSum ? "" : " (WARNING: results differ)") << std::endl;
+	}
+}
@@ -9,6 +9,9 @@
 #include "framework/EliteAI\EliteGraphs/EliteGraphUtilities\EGraphRenderer.h"
 #include "framework/EliteAI/EliteNavigation/EHeuristicFunctions.h"
 #include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EJPS.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EHPAStar.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EPathRequestQueue.h"
 
 
 //-----------------------------------------------------------------
@@ -36,13 +39,19 @@ private:
 	static const int COLUMNS = 20;
 	static const int ROWS = 10;
 	unsigned int m_SizeCell = 15;
-	Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>* m_pGridGraph;
+	Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>* m_pGridGraph = nullptr;
 
 
 	//Pathfinding datamembers
 	int startPathIdx = invalid_node_index;
 	int endPathIdx = invalid_node_index;
 	std::vector<Elite::GridTerrainNode*> m_vPath;
+	Elite::SearchContext<Elite::GridTerrainNode, Elite::GraphConnection>* m_pSearchContext = nullptr;
+	Elite::JPS<Elite::GridTerrainNode, Elite::GraphConnection>* m_pJPS = nullptr;
+	Elite::HPAStar<Elite::GridTerrainNode, Elite::GraphConnection>* m_pHPAStar = nullptr;
+	Elite::PathRequestQueue<Elite::GridTerrainNode, Elite::GraphConnection>* m_pPathRequestQueue = nullptr;
+	unsigned int m_NrOfExpandedNodes = 0;
+	bool m_HasJPSUsedFallback = false;
 
 	//Editor and Visualisation
 	Elite::GraphEditor m_GraphEditor{};
@@ -56,11 +65,19 @@ private:
 	bool m_StartSelected = true;
 	int m_SelectedHeuristic = 4;
 	Elite::Heuristic m_pHeuristicFunction = Elite::HeuristicFunctions::Chebyshev;
+	bool m_bUseBinaryHeap = true;
+	bool m_bUseCSR = true;
+	bool m_bConnectDiagonally = false;
+	bool m_bUseJPS = false;
+	bool m_bUseHPAStar = false;
+	bool m_bUseAsyncRequests = false;
 
 	//Functions
 	void MakeGridGraph();
+	void SetConnectedDiagonally(bool isConnectedDiagonally);
 	void UpdateImGui();
 	void CalculatePath();
+	void RunBenchmark() const;
 
 	//C++ make the class non-copyable
 	App_PathfindingAStar(const App_PathfindingAStar&) = delete;
@@ -15,7 +15,7 @@ SteeringOutput BlendedSteering::CalculateSteering(float deltaT, SteeringAgent* p
 	SteeringOutput blendedSteering = {};
 	auto totalWeight = 0.f;
 
-	for (auto weightedBehavior : m_WeightedBehaviors)
+	for (const auto& weightedBehavior : m_WeightedBehaviors)
 	{
 		auto steering = weightedBehavior.pBehavior->CalculateSteering(deltaT, pAgent);
 		blendedSteering.LinearVelocity += weightedBehavior.weight * steering.LinearVelocity;
@@ -36,6 +36,34 @@ SteeringOutput BlendedSteering::CalculateSteering(float deltaT, SteeringAgent* p
 	return blendedSteering;
 }
 
+void BlendedSteering::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	//One behavior at a time over all agents, its weighted steering added to theirs
+	for (int i = 0; i < count; ++i)
+		pSteerings[i] = SteeringOutput{};
+
+	m_BatchSteerings.resize(count);
+	auto totalWeight = 0.f;
+	for (const auto& weightedBehavior : m_WeightedBehaviors)
+	{
+		weightedBehavior.pBehavior->CalculateSteeringBatch(deltaT, pAgents, m_BatchSteerings.data(), count);
+		for (int i = 0; i < count; ++i)
+		{
+			pSteerings[i].LinearVelocity += weightedBehavior.weight * m_BatchSteerings[i].LinearVelocity;
+			pSteerings[i].AngularVelocity += weightedBehavior.weight * m_BatchSteerings[i].AngularVelocity;
+		}
+
+		totalWeight += weightedBehavior.weight;
+	}
+
+	if (totalWeight > 0.f)
+	{
+		auto scale = 1.f / totalWeight;
+		for (int i = 0; i < count; ++i)
+			pSteerings[i] *= scale;
+	}
+}
+
 //*****************
 //PRIORITY STEERING
 SteeringOutput PrioritySteering::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -52,4 +80,48 @@ SteeringOutput PrioritySteering::CalculateSteering(float deltaT, SteeringAgent*
 
 	//If non of the behavior return a valid output, last behavior is returned
 	return steering;
+}
+
+void PrioritySteering::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	if (m_PriorityBehaviors.empty())
+	{
+		for (int i = 0; i < count; ++i)
+			pSteerings[i] = SteeringOutput{};
+		return;
+	}
+
+	//1. The first behavior for every agent
+	m_PriorityBehaviors[0]->CalculateSteeringBatch(deltaT, pAgents, pSteerings, count);
+
+	m_BatchIndices.clear();
+	for (int i = 0; i < count; ++i)
+	{
+		if (!pSteerings[i].IsValid)
+			m_BatchIndices.push_back(i);
+	}
+
+	//2. The next behaviors only for the agents left without a valid steering
+	for (size_t behaviorIdx = 1; behaviorIdx < m_PriorityBehaviors.size() && !m_BatchIndices.empty(); ++behaviorIdx)
+	{
+		const int nrOfAgents = (int)m_BatchIndices.size();
+		m_BatchAgents.resize(nrOfAgents);
+		m_BatchSteerings.resize(nrOfAgents);
+		for (int i = 0; i < nrOfAgents; ++i)
+			m_BatchAgents[i] = pAgents[m_BatchIndices[i]];
+
+		m_PriorityBehaviors[behaviorIdx]->CalculateSteeringBatch(deltaT, m_BatchAgents.data(), m_BatchSteerings.data(), nrOfAgents);
+
+		//Back in place, with the state a behavior may have changed
+		int nrOfInvalid = 0;
+		for (int i = 0; i < nrOfAgents; ++i)
+		{
+			const int agentIdx = m_BatchIndices[i];
+			pAgents[agentIdx] = m_BatchAgents[i];
+			pSteerings[agentIdx] = m_BatchSteerings[i];
+			if (!m_BatchSteerings[i].IsValid)
+				m_BatchIndices[nrOfInvalid++] = agentIdx;
+		}
+		m_BatchIndices.resize(nrOfInvalid);
+	}
 }
\ No newline at end of file
@@ -23,12 +23,14 @@ public:
 
 	void AddBehaviour(WeightedBehavior weightedBehavior) { m_WeightedBehaviors.push_back(weightedBehavior); }
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 	// returns a reference to the weighted behaviors, can be used to adjust weighting. Is not intended to alter the behaviors themselves.
 	vector<WeightedBehavior>& GetWeightedBehaviorsRef() { return m_WeightedBehaviors; }
 
 private:
 	vector<WeightedBehavior> m_WeightedBehaviors = {};
+	vector<SteeringOutput> m_BatchSteerings = {}; //Of one behavior, kept between batches
 };
 
 //*****************
@@ -42,7 +44,13 @@ public:
 
 	void AddBehaviour(ISteeringBehavior* pBehavior) { m_PriorityBehaviors.push_back(pBehavior); }
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 private:
 	vector<ISteeringBehavior*> m_PriorityBehaviors = {};
+
+	//The agents that still need a valid steering, packed for the next behavior
+	vector<int> m_BatchIndices = {};
+	vector<AgentState> m_BatchAgents = {};
+	vector<SteeringOutput> m_BatchSteerings = {};
 };
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "stdafx.h"
+#include "FlockSimulation.h"
+
+using namespace Elite;
+
+//Constructors
+FlockSimulation::FlockSimulation(float worldSize, unsigned int seed /*= 1*/)
+	: m_WorldSize{ worldSize }
+	, m_Seed{ seed == 0 ? 1 : seed }
+	, m_pWorkerPool{ new WorkerPool() }
+	, m_Grid{ worldSize, worldSize, m_NeighborhoodRadius, m_TrimWorld }
+{
+}
+
+FlockSimulation::FlockSimulation(int flockSize, float worldSize, unsigned int seed /*= 1*/)
+	: FlockSimulation(worldSize, seed)
+{
+	std::mt19937 rng{ m_Seed };
+	std::uniform_real_distribution<float> randomPosition{ 0.f, worldSize };
+	for (int i = 0; i < flockSize; ++i)
+	{
+		const float x = randomPosition(rng);
+		const float y = randomPosition(rng);
+		AddAgent({ x, y });
+	}
+}
+
+FlockSimulation::~FlockSimulation()
+{
+	SAFE_DELETE(m_pWorkerPool);
+}
+
+void FlockSimulation::SetNrOfThreads(int nrOfThreads)
+{
+	nrOfThreads = nrOfThreads < 1 ? 1 : nrOfThreads;
+	if (nrOfThreads == GetNrOfThreads())
+		return;
+
+	SAFE_DELETE(m_pWorkerPool);
+	m_pWorkerPool = new WorkerPool(nrOfThreads);
+}
+
+void FlockSimulation::AddAgent(const Elite::Vector2& position, const Elite::Vector2& linearVelocity)
+{
+	m_PositionsX.push_back(position.x);
+	m_PositionsY.push_back(position.y);
+	m_VelocitiesX.push_back(linearVelocity.x);
+	m_VelocitiesY.push_back(linearVelocity.y);
+	m_Orientations.push_back(GetOrientationFromVelocity(linearVelocity));
+	m_WanderAngles.push_back(0.f);
+	//xorshift state, never zero
+	m_RandomStates.push_back(m_Seed * 2654435761u + static_cast<unsigned int>(m_RandomStates.size()) * 40503u + 1u);
+	m_SteeringX.push_back(0.f);
+	m_SteeringY.push_back(0.f);
+}
+
+void FlockSimulation::Clear()
+{
+	m_PositionsX.clear();
+	m_PositionsY.clear();
+	m_VelocitiesX.clear();
+	m_VelocitiesY.clear();
+	m_Orientations.clear();
+	m_WanderAngles.clear();
+	m_RandomStates.clear();
+	m_SteeringX.clear();
+	m_SteeringY.clear();
+}
+
+void FlockSimulation::SetAgentToEvade(const Elite::Vector2& position, const Elite::Vector2& linearVelocity)
+{
+	m_HasAgentToEvade = true;
+	m_EvadePosition = position;
+	m_EvadeVelocity = linearVelocity;
+}
+
+//Update
+void FlockSimulation::Update(float deltaT)
+{
+	//1. Bucket the agents
+	RebuildGrid();
+
+	//2. Steering from the positions and velocities at the start of the frame, an agent only writes its own steering
+	const int flockSize = GetFlockSize();
+	m_pWorkerPool->ParallelFor(flockSize, [this, deltaT](int begin, int end)
+		{
+			std::vector<NearNeighbor> nearestNeighbors{};
+			for (int i = begin; i < end; ++i)
+				CalculateSteering(i, deltaT, nearestNeighbors);
+		});
+
+	//3. Move every agent, once all the steering is known
+	m_pWorkerPool->ParallelFor(flockSize, [this, deltaT](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				Integrate(i, deltaT);
+		});
+}
+
+void FlockSimulation::RebuildGrid()
+{
+	m_Grid.SetCellSize(m_NeighborhoodRadius);
+	m_Grid.SetWrapAround(m_TrimWorld);
+	m_Grid.Rebuild(m_PositionsX.data(), m_PositionsY.data(), GetFlockSize());
+}
+
+void FlockSimulation::FindNeighbors(int idx, std::vector<int>& neighbors) const
+{
+	if (m_MaxNeighbors == 0)
+	{
+		m_Grid.FindNeighbors(GetPosition(idx), m_NeighborhoodRadius, neighbors);
+		return;
+	}
+
+	std::vector<NearNeighbor> nearestNeighbors{};
+	m_Grid.FindNearestNeighbors(GetPosition(idx), m_NeighborhoodRadius, m_MaxNeighbors, nearestNeighbors);
+	neighbors.clear();
+	for (const NearNeighbor& neighbor : nearestNeighbors)
+		neighbors.push_back(neighbor.pointIdx);
+}
+
+float FlockSimulation::GetRandomFloat(int idx, float min, float max)
+{
+	unsigned int& state = m_RandomStates[idx];
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return min + (max - min) * (static_cast<float>(state >> 8) / 16777216.f);
+}
+
+Elite::Vector2 FlockSimulation::GetSeekVelocity(const Elite::Vector2& position, const Elite::Vector2& target) const
+{
+	return (target - position).GetNormalized() * m_MaxLinearSpeed;
+}
+
+void FlockSimulation::CalculateSteering(int idx, float deltaT, std::vector<NearNeighbor>& nearestNeighbors)
+{
+	const Vector2 position{ m_PositionsX[idx], m_PositionsY[idx] };
+	const Vector2 velocity{ m_VelocitiesX[idx], m_VelocitiesY[idx] };
+
+	//Evade has priority while the agent to evade is in range: flee from where it will be
+	if (m_HasAgentToEvade && Distance(m_EvadePosition, position) < m_EvadeRange)
+	{
+		const float predictionTime = Distance(m_EvadePosition, position) / m_MaxAngularSpeed;
+		const Vector2 predictedPosition = m_EvadePosition + m_EvadeVelocity.GetNormalized() * predictionTime;
+		const Vector2 evade = GetSeekVelocity(position, predictedPosition) * -1.f;
+		m_SteeringX[idx] = evade.x;
+		m_SteeringY[idx] = evade.y;
+		return;
+	}
+
+	//Neighborhood: one pass for the sums of cohesion, velocity match and separation
+	//Offsets instead of positions, so neighbors across the border of a wrapping world are averaged in the right place
+	int nrOfNeighbors = 0;
+	Vector2 offsetSum{}, velocitySum{}, separation{};
+	auto addNeighbor = [&](int other, float dx, float dy, float distanceSquared)
+	{
+		++nrOfNeighbors;
+		offsetSum += Vector2{ dx, dy };
+		velocitySum += Vector2{ m_VelocitiesX[other], m_VelocitiesY[other] };
+		if (distanceSquared > 1.f)
+			separation -= Vector2{ m_VelocitiesX[other], m_VelocitiesY[other] } / sqrtf(distanceSquared);
+	};
+
+	if (m_MaxNeighbors == 0)
+	{
+		m_Grid.ForEachNeighbor(position, m_NeighborhoodRadius, addNeighbor);
+	}
+	else
+	{
+		//Topological: a crowded agent still only looks at its nearest neighbors
+		m_Grid.FindNearestNeighbors(position, m_NeighborhoodRadius, m_MaxNeighbors, nearestNeighbors);
+		for (const NearNeighbor& neighbor : nearestNeighbors)
+			addNeighbor(neighbor.pointIdx, neighbor.dx, neighbor.dy, neighbor.distanceSquared);
+	}
+
+	//Behaviors, same as Cohesion, Separation, VelocityMatch, Seek and Wander
+	Vector2 cohesion{}, velocityMatch{};
+	if (nrOfNeighbors > 0)
+	{
+		cohesion = GetSeekVelocity(position, position + offsetSum / static_cast<float>(nrOfNeighbors));
+		velocityMatch = velocitySum / static_cast<float>(nrOfNeighbors);
+		separation = separation.GetNormalized() * m_MaxLinearSpeed * deltaT;
+	}
+	const Vector2 seek = GetSeekVelocity(position, m_SeekTarget);
+
+	m_WanderAngles[idx] += GetRandomFloat(idx, -m_MaxWanderAngleChange, m_MaxWanderAngleChange);
+	const Vector2 circleCenter = position + velocity.GetNormalized() * m_WanderOffset;
+	const Vector2 wanderTarget = circleCenter + Vector2{ cosf(m_WanderAngles[idx]), sinf(m_WanderAngles[idx]) } * m_WanderRadius;
+	const Vector2 wander = GetSeekVelocity(position, wanderTarget);
+
+	//Blend
+	const float totalWeight = m_Weights.separation + m_Weights.cohesion + m_Weights.velocityMatch + m_Weights.seek + m_Weights.wander;
+	Vector2 blended = separation * m_Weights.separation + cohesion * m_Weights.cohesion + velocityMatch * m_Weights.velocityMatch
+		+ seek * m_Weights.seek + wander * m_Weights.wander;
+	if (totalWeight > 0.f)
+		blended /= totalWeight;
+
+	m_SteeringX[idx] = blended.x;
+	m_SteeringY[idx] = blended.y;
+}
+
+void FlockSimulation::Integrate(int idx, float deltaT)
+{
+	//Same as SteeringAgent::Update, the rigidbody then moves the agent with the new velocity
+	const float accelerationX = (m_SteeringX[idx] - m_VelocitiesX[idx]) / m_Mass;
+	const float accelerationY = (m_SteeringY[idx] - m_VelocitiesY[idx]) / m_Mass;
+	m_VelocitiesX[idx] += accelerationX * deltaT;
+	m_VelocitiesY[idx] += accelerationY * deltaT;
+	m_PositionsX[idx] += m_VelocitiesX[idx] * deltaT;
+	m_PositionsY[idx] += m_VelocitiesY[idx] * deltaT;
+	m_Orientations[idx] = GetOrientationFromVelocity({ m_VelocitiesX[idx], m_VelocitiesY[idx] });
+
+	//Same as BaseAgent::TrimToWorld
+	if (m_TrimWorld)
+	{
+		float& x = m_PositionsX[idx];
+		float& y = m_PositionsY[idx];
+		if (x > m_WorldSize) x = 0.f;
+		else if (x < 0.f) x = m_WorldSize;
+		if (y > m_WorldSize) y = 0.f;
+		else if (y < 0.f) y = m_WorldSize;
+	}
+}
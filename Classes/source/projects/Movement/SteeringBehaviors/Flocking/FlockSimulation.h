@@ -0,0 +1,110 @@
+#pragma once
+//-----------------------------------------------------------------
+// FlockSimulation: data-oriented flock without rigidbodies.
+// Positions, velocities and orientations live in structure-of-arrays buffers and are integrated directly,
+// the steering is the same as the Flock of SteeringAgents: Evade first, else the blend of
+// Separation, Cohesion, VelocityMatch, Seek and Wander.
+// An update has two phases: every agent's steering is calculated from the state at the start of the frame,
+// then every agent is moved. Both phases are split over the worker threads, and since an agent only
+// writes its own entries the result does not depend on the number of threads.
+//-----------------------------------------------------------------
+#include <vector>
+#include "framework\EliteMath\EVector2.h"
+#include "framework\EliteHelpers\EWorkerPool.h"
+#include "projects\Movement\SteeringBehaviors\SpacePartitioning\SpacePartitioning.h"
+
+struct FlockWeights
+{
+	float separation = 0.5f;
+	float cohesion = 0.5f;
+	float velocityMatch = 0.5f;
+	float seek = 0.5f;
+	float wander = 0.5f;
+};
+
+class FlockSimulation final
+{
+public:
+	FlockSimulation(float worldSize, unsigned int seed = 1);
+	// Agents at random positions in the world, standing still
+	FlockSimulation(int flockSize, float worldSize, unsigned int seed = 1);
+	~FlockSimulation();
+
+	void Update(float deltaT);
+
+	void AddAgent(const Elite::Vector2& position, const Elite::Vector2& linearVelocity = Elite::ZeroVector2);
+	void Clear();
+
+	int GetFlockSize() const { return static_cast<int>(m_PositionsX.size()); }
+	Elite::Vector2 GetPosition(int idx) const { return { m_PositionsX[idx], m_PositionsY[idx] }; }
+	Elite::Vector2 GetLinearVelocity(int idx) const { return { m_VelocitiesX[idx], m_VelocitiesY[idx] }; }
+	float GetOrientation(int idx) const { return m_Orientations[idx]; }
+
+	// Agents within the neighborhood radius of the agent, the agent itself included
+	// With a maximum number of neighbors, the nearest ones from near to far
+	void FindNeighbors(int idx, std::vector<int>& neighbors) const;
+
+	FlockWeights& GetWeights() { return m_Weights; }
+	void SetSeekTarget(const Elite::Vector2& target) { m_SeekTarget = target; }
+	void SetAgentToEvade(const Elite::Vector2& position, const Elite::Vector2& linearVelocity);
+	void SetNeighborhoodRadius(float radius) { m_NeighborhoodRadius = radius; }
+	float GetNeighborhoodRadius() const { return m_NeighborhoodRadius; }
+	// Only the nearest neighbors steer an agent, 0 for all of them
+	void SetMaxNeighbors(int maxNeighbors) { m_MaxNeighbors = maxNeighbors > 0 ? maxNeighbors : 0; }
+	int GetMaxNeighbors() const { return m_MaxNeighbors; }
+	float GetEvadeRange() const { return m_EvadeRange; }
+	void SetMaxLinearSpeed(float maxLinSpeed) { m_MaxLinearSpeed = maxLinSpeed; }
+	void SetTrimWorld(bool trimWorld) { m_TrimWorld = trimWorld; }
+
+	// Threads the update is split over, the calling thread included
+	void SetNrOfThreads(int nrOfThreads);
+	int GetNrOfThreads() const { return m_pWorkerPool->GetNrOfThreads(); }
+
+private:
+	//--- Agents (structure of arrays) ---
+	std::vector<float> m_PositionsX;
+	std::vector<float> m_PositionsY;
+	std::vector<float> m_VelocitiesX;
+	std::vector<float> m_VelocitiesY;
+	std::vector<float> m_Orientations;
+	std::vector<float> m_WanderAngles;
+	std::vector<unsigned int> m_RandomStates; // every agent draws its own random numbers
+
+	// Desired velocity of every agent, written by the steering pass and read by the integration pass
+	std::vector<float> m_SteeringX;
+	std::vector<float> m_SteeringY;
+
+	//--- Settings, same defaults as the agents of the Flock ---
+	float m_WorldSize = 0.f;
+	bool m_TrimWorld = true;
+	float m_NeighborhoodRadius = 15.f;
+	int m_MaxNeighbors = 0;
+	float m_MaxLinearSpeed = 55.f;
+	float m_MaxAngularSpeed = 25.f * 16.f;
+	float m_Mass = 1.f;
+	float m_EvadeRange = 20.f;
+	float m_WanderOffset = 6.f;
+	float m_WanderRadius = 4.f;
+	float m_MaxWanderAngleChange = Elite::ToRadians(45.f);
+	unsigned int m_Seed = 1;
+
+	Elite::WorkerPool* m_pWorkerPool = nullptr;
+
+	//--- Neighbor grid, rebuilt every update with cells as large as the neighborhood, wraps around with the world ---
+	SpatialHashGrid m_Grid;
+
+	FlockWeights m_Weights{};
+	Elite::Vector2 m_SeekTarget{};
+	bool m_HasAgentToEvade = false;
+	Elite::Vector2 m_EvadePosition{};
+	Elite::Vector2 m_EvadeVelocity{};
+
+	void RebuildGrid();
+	void CalculateSteering(int idx, float deltaT, std::vector<NearNeighbor>& nearestNeighbors);
+	void Integrate(int idx, float deltaT);
+	float GetRandomFloat(int idx, float min, float max);
+	Elite::Vector2 GetSeekVelocity(const Elite::Vector2& position, const Elite::Vector2& target) const;
+
+	FlockSimulation(const FlockSimulation& other) = delete;
+	FlockSimulation& operator=(const FlockSimulation& other) = delete;
+};
@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include "FlockingKernels.h"
+
+#if defined(FLOCKING_KERNELS_AVX)
+	#include <immintrin.h>
+#elif defined(FLOCKING_KERNELS_SSE)
+	#include <emmintrin.h>
+#endif
+
+using namespace Elite;
+
+//Neighborhood
+void FlockNeighborhood::Clear()
+{
+	offsetsX.clear();
+	offsetsY.clear();
+	velocitiesX.clear();
+	velocitiesY.clear();
+}
+
+void FlockNeighborhood::Add(const Elite::Vector2& offset, const Elite::Vector2& velocity)
+{
+	offsetsX.push_back(offset.x);
+	offsetsY.push_back(offset.y);
+	velocitiesX.push_back(velocity.x);
+	velocitiesY.push_back(velocity.y);
+}
+
+//Kernels
+FlockNeighborSums FlockingKernels::SumNeighbors(const FlockNeighborhood& neighborhood)
+{
+	return SumNeighbors(neighborhood.offsetsX.data(), neighborhood.offsetsY.data(),
+		neighborhood.velocitiesX.data(), neighborhood.velocitiesY.data(), neighborhood.GetSize());
+}
+
+FlockNeighborSums FlockingKernels::SumNeighborsScalar(const float* pOffsetsX, const float* pOffsetsY, const float* pVelocitiesX, const float* pVelocitiesY, int count)
+{
+	FlockNeighborSums sums{};
+	sums.count = count;
+	for (int i = 0; i < count; ++i)
+	{
+		sums.offsetSum.x += pOffsetsX[i];
+		sums.offsetSum.y += pOffsetsY[i];
+		sums.velocitySum.x += pVelocitiesX[i];
+		sums.velocitySum.y += pVelocitiesY[i];
+
+		const float distanceSquared = pOffsetsX[i] * pOffsetsX[i] + pOffsetsY[i] * pOffsetsY[i];
+		if (distanceSquared > 1.f)
+		{
+			const float distance = sqrtf(distanceSquared);
+			sums.separation.x -= pVelocitiesX[i] / distance;
+			sums.separation.y -= pVelocitiesY[i] / distance;
+		}
+	}
+	return sums;
+}
+
+#if defined(FLOCKING_KERNELS_SSE)
+namespace
+{
+	float HorizontalSum(__m128 v)
+	{
+		__m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 sums = _mm_add_ps(v, shuffled);
+		shuffled = _mm_movehl_ps(shuffled, sums);
+		sums = _mm_add_ss(sums, shuffled);
+		return _mm_cvtss_f32(sums);
+	}
+}
+#endif
+
+FlockNeighborSums FlockingKernels::SumNeighbors(const float* pOffsetsX, const float* pOffsetsY, const float* pVelocitiesX, const float* pVelocitiesY, int count)
+{
+	int i = 0;
+	FlockNeighborSums sums{};
+
+#if defined(FLOCKING_KERNELS_AVX)
+	//8 neighbors at a time, the separation of a neighbor within distance 1 is masked out
+	__m256 offsetSumX = _mm256_setzero_ps(), offsetSumY = _mm256_setzero_ps();
+	__m256 velocitySumX = _mm256_setzero_ps(), velocitySumY = _mm256_setzero_ps();
+	__m256 separationX = _mm256_setzero_ps(), separationY = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.f);
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256 offsetX = _mm256_loadu_ps(pOffsetsX + i);
+		const __m256 offsetY = _mm256_loadu_ps(pOffsetsY + i);
+		const __m256 velocityX = _mm256_loadu_ps(pVelocitiesX + i);
+		const __m256 velocityY = _mm256_loadu_ps(pVelocitiesY + i);
+		offsetSumX = _mm256_add_ps(offsetSumX, offsetX);
+		offsetSumY = _mm256_add_ps(offsetSumY, offsetY);
+		velocitySumX = _mm256_add_ps(velocitySumX, velocityX);
+		velocitySumY = _mm256_add_ps(velocitySumY, velocityY);
+
+		const __m256 distanceSquared = _mm256_add_ps(_mm256_mul_ps(offsetX, offsetX), _mm256_mul_ps(offsetY, offsetY));
+		const __m256 isFarEnough = _mm256_cmp_ps(distanceSquared, one, _CMP_GT_OQ);
+		const __m256 distance = _mm256_sqrt_ps(distanceSquared);
+		separationX = _mm256_sub_ps(separationX, _mm256_and_ps(isFarEnough, _mm256_div_ps(velocityX, distance)));
+		separationY = _mm256_sub_ps(separationY, _mm256_and_ps(isFarEnough, _mm256_div_ps(velocityY, distance)));
+	}
+	auto sum8 = [](__m256 v) { return HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1))); };
+	sums.offsetSum = { sum8(offsetSumX), sum8(offsetSumY) };
+	sums.velocitySum = { sum8(velocitySumX), sum8(velocitySumY) };
+	sums.separation = { sum8(separationX), sum8(separationY) };
+#elif defined(FLOCKING_KERNELS_SSE)
+	//4 neighbors at a time, the separation of a neighbor within distance 1 is masked out
+	__m128 offsetSumX = _mm_setzero_ps(), offsetSumY = _mm_setzero_ps();
+	__m128 velocitySumX = _mm_setzero_ps(), velocitySumY = _mm_setzero_ps();
+	__m128 separationX = _mm_setzero_ps(), separationY = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 offsetX = _mm_loadu_ps(pOffsetsX + i);
+		const __m128 offsetY = _mm_loadu_ps(pOffsetsY + i);
+		const __m128 velocityX = _mm_loadu_ps(pVelocitiesX + i);
+		const __m128 velocityY = _mm_loadu_ps(pVelocitiesY + i);
+		offsetSumX = _mm_add_ps(offsetSumX, offsetX);
+		offsetSumY = _mm_add_ps(offsetSumY, offsetY);
+		velocitySumX = _mm_add_ps(velocitySumX, velocityX);
+		velocitySumY = _mm_add_ps(velocitySumY, velocityY);
+
+		const __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY));
+		const __m128 isFarEnough = _mm_cmpgt_ps(distanceSquared, one);
+		const __m128 distance = _mm_sqrt_ps(distanceSquared);
+		separationX = _mm_sub_ps(separationX, _mm_and_ps(isFarEnough, _mm_div_ps(velocityX, distance)));
+		separationY = _mm_sub_ps(separationY, _mm_and_ps(isFarEnough, _mm_div_ps(velocityY, distance)));
+	}
+	sums.offsetSum = { HorizontalSum(offsetSumX), HorizontalSum(offsetSumY) };
+	sums.velocitySum = { HorizontalSum(velocitySumX), HorizontalSum(velocitySumY) };
+	sums.separation = { HorizontalSum(separationX), HorizontalSum(separationY) };
+#endif
+
+	//The rest one by one
+	const FlockNeighborSums rest = SumNeighborsScalar(pOffsetsX + i, pOffsetsY + i, pVelocitiesX + i, pVelocitiesY + i, count - i);
+	sums.offsetSum += rest.offsetSum;
+	sums.velocitySum += rest.velocitySum;
+	sums.separation += rest.separation;
+	sums.count = count;
+	return sums;
+}
+
+const char* FlockingKernels::GetInstructionSet()
+{
+#if defined(FLOCKING_KERNELS_AVX)
+	return "AVX";
+#elif defined(FLOCKING_KERNELS_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
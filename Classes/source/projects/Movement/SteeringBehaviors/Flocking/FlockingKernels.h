@@ -0,0 +1,46 @@
+#pragma once
+//-----------------------------------------------------------------
+// FlockingKernels: the neighborhood sums of Cohesion, Separation and VelocityMatch over packed float arrays.
+// SSE is used when the compiler targets it (always on x64), AVX when built with /arch:AVX,
+// define FLOCKING_KERNELS_SCALAR to force the plain loop.
+//-----------------------------------------------------------------
+#include <vector>
+#include "framework\EliteMath\EVector2.h"
+
+#if !defined(FLOCKING_KERNELS_SCALAR) && defined(__AVX__)
+	#define FLOCKING_KERNELS_AVX
+#endif
+#if !defined(FLOCKING_KERNELS_SCALAR) && (defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+	#define FLOCKING_KERNELS_SSE
+#endif
+
+// Neighbors of one agent, relative to that agent
+struct FlockNeighborhood
+{
+	std::vector<float> offsetsX; // neighbor position - agent position
+	std::vector<float> offsetsY;
+	std::vector<float> velocitiesX;
+	std::vector<float> velocitiesY;
+
+	void Clear();
+	void Add(const Elite::Vector2& offset, const Elite::Vector2& velocity);
+	int GetSize() const { return static_cast<int>(offsetsX.size()); }
+};
+
+struct FlockNeighborSums
+{
+	Elite::Vector2 offsetSum{};		// Cohesion: the average position is the agent position + offsetSum / count
+	Elite::Vector2 velocitySum{};	// VelocityMatch: average velocity is velocitySum / count
+	Elite::Vector2 separation{};	// Separation: sum of -velocity / distance of the neighbors farther than 1
+	int count = 0;
+};
+
+namespace FlockingKernels
+{
+	FlockNeighborSums SumNeighbors(const FlockNeighborhood& neighborhood);
+	FlockNeighborSums SumNeighbors(const float* pOffsetsX, const float* pOffsetsY, const float* pVelocitiesX, const float* pVelocitiesY, int count);
+	// Same sums without SIMD, the reference for the vectorized version
+	FlockNeighborSums SumNeighborsScalar(const float* pOffsetsX, const float* pOffsetsY, const float* pVelocitiesX, const float* pVelocitiesY, int count);
+
+	const char* GetInstructionSet();
+}
@@ -13,15 +13,35 @@ SteeringOutput Cohesion::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Cohesion::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	//Seek the average position of the neighbors of every agent, the origin without neighbors like GetAverageNeighborPos
+	for (int i = 0; i < count; ++i)
+	{
+		const FlockNeighborSums& sums = m_pFlock->GetNeighborSums(pAgents[i].AgentIdx);
+		m_Target.Position = sums.count == 0 ? Elite::ZeroVector2 : pAgents[i].Position + sums.offsetSum / static_cast<float>(sums.count);
+		Seek::CalculateSteeringBatch(deltaT, pAgents + i, pSteerings + i, 1);
+	}
+}
+
 
 //*********************
 //SEPARATION (FLOCKING)
 SteeringOutput Separation::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 {
-	std::vector<SteeringAgent*> pNeighbors = m_pFlock->GetNeighbors();
-
 	SteeringOutput steering = SteeringOutput{};
 
+	if (m_pFlock->UsesSteeringKernels())
+	{
+		const FlockNeighborSums& sums = m_pFlock->GetNeighborSums();
+		if (sums.count == 0) return SteeringOutput(Elite::ZeroVector2, 0.f, false);
+
+		steering.LinearVelocity = sums.separation.GetNormalized() * pAgent->GetMaxLinearSpeed() * deltaT;
+		return steering;
+	}
+
+	const std::vector<SteeringAgent*>& pNeighbors = m_pFlock->GetNeighbors();
+
 	if (pNeighbors.size()) 
 	{
 		for (SteeringAgent* pNeighbor : pNeighbors)
@@ -38,6 +58,16 @@ SteeringOutput Separation::CalculateSteering(float deltaT, SteeringAgent* pAgent
 	return SteeringOutput(Elite::ZeroVector2, 0.f, false);
 }
 
+void Separation::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const FlockNeighborSums& sums = m_pFlock->GetNeighborSums(pAgents[i].AgentIdx);
+		if (sums.count == 0) pSteerings[i] = SteeringOutput(Elite::ZeroVector2, 0.f, false);
+		else pSteerings[i] = SteeringOutput(sums.separation.GetNormalized() * pAgents[i].MaxLinearSpeed * deltaT);
+	}
+}
+
 //*************************
 //VELOCITY MATCH (FLOCKING)
 SteeringOutput VelocityMatch::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -45,4 +75,13 @@ SteeringOutput VelocityMatch::CalculateSteering(float deltaT, SteeringAgent* pAg
 	SteeringOutput steering{};
 	steering.LinearVelocity = m_pFlock->GetAverageNeighborVelocity();
 	return steering;
+}
+
+void VelocityMatch::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const FlockNeighborSums& sums = m_pFlock->GetNeighborSums(pAgents[i].AgentIdx);
+		pSteerings[i] = SteeringOutput(sums.count == 0 ? Elite::ZeroVector2 : sums.velocitySum / static_cast<float>(sums.count));
+	}
 }
\ No newline at end of file
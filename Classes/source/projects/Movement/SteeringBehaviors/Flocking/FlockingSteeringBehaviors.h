@@ -11,6 +11,8 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Only with the steering kernels, the flock keeps the neighbor sums of every agent then
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -26,6 +28,7 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -40,6 +43,7 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -4,6 +4,7 @@
 #include "../SteeringAgent.h"
 #include "../Steering/SteeringBehaviors.h"
 #include "../CombinedSteering/CombinedSteeringBehaviors.h"
+#include "FlockSimulation.h"
 
 //Constructor & Destructor
 Flock::Flock(
@@ -21,7 +22,8 @@ Flock::Flock(
 {
 
 	// Partitioning
-	m_pCellSpace = new CellSpace{ m_WorldSize, m_WorldSize, 25, 25, m_FlockSize };
+	CreatePartitioning();
+	m_pSpatialHash = new SpatialHashGrid{ m_WorldSize, m_WorldSize, m_NeighborhoodRadius };
 
 	// All Agents
 	m_pSeparationBehavior = new Separation{this};
@@ -49,30 +51,70 @@ Flock::Flock(
 
 	for (int i = 0; i < m_FlockSize; i++)
 	{
-		SteeringAgent* pAgent = new SteeringAgent();
-		
-		pAgent->SetSteeringBehavior(m_pPrioritySteering);
-		pAgent->SetMass(1.0f);
-		pAgent->SetMaxAngularSpeed(25.0f * 16.f);
-		pAgent->SetMaxLinearSpeed(55.f);
-		pAgent->SetAutoOrient(true);
 		Elite::Vector2 agentPos{ Elite::randomFloat(m_WorldSize), Elite::randomFloat(m_WorldSize) };
-		pAgent->SetPosition(agentPos);
+		CreateAgent(agentPos);
+	}
 
-		m_Agents.push_back(pAgent);
-		m_OldAgentPos.push_back(agentPos);
-		m_pCellSpace->AddAgent(pAgent);
+	
+}
 
-		if (i == 0) m_pCellSpace->SetAgentToDebug(pAgent);
+void Flock::CreatePartitioning()
+{
+	// The cell space and quadtree follow the agents from their creation on, the spatial hash is rebuilt every frame
+	SAFE_DELETE(m_pPartitioning);
+	switch (m_PartitioningType)
+	{
+	case PartitioningType::CellSpace:
+		m_pPartitioning = new CellSpace{ m_WorldSize, m_WorldSize, 25, 25, m_FlockSize };
+		break;
+	case PartitioningType::QuadTree:
+		m_pPartitioning = new QuadTreeSpace{ m_WorldSize, m_WorldSize };
+		break;
+	default:
+		return;
 	}
 
-	
+	for (SteeringAgent* pAgent : m_Agents)
+		m_pPartitioning->AddAgent(pAgent);
+	if (!m_Agents.empty()) m_pPartitioning->SetAgentToDebug(m_Agents[0]);
+}
+
+void Flock::SetPartitioningType(PartitioningType type)
+{
+	if (type == m_PartitioningType)
+		return;
+
+	m_PartitioningType = type;
+	CreatePartitioning();
+}
+
+SteeringAgent* Flock::CreateAgent(const Elite::Vector2& position)
+{
+	SteeringAgent* pAgent = new SteeringAgent();
+
+	pAgent->SetSteeringBehavior(m_pPrioritySteering);
+	pAgent->SetMass(1.0f);
+	pAgent->SetMaxAngularSpeed(25.0f * 16.f);
+	pAgent->SetMaxLinearSpeed(55.f);
+	pAgent->SetAutoOrient(true);
+	pAgent->SetPosition(position);
+
+	m_Agents.push_back(pAgent);
+	m_OldAgentPos.push_back(position);
+	if (m_pPartitioning)
+	{
+		m_pPartitioning->AddAgent(pAgent);
+		if (m_Agents.size() == 1) m_pPartitioning->SetAgentToDebug(pAgent);
+	}
+	return pAgent;
 }
 
 Flock::~Flock()
 {
 
-	SAFE_DELETE(m_pCellSpace);
+	SAFE_DELETE(m_pPartitioning);
+	SAFE_DELETE(m_pSpatialHash);
+	SAFE_DELETE(m_pSimulation);
 
 	SAFE_DELETE(m_pSeparationBehavior);
 	SAFE_DELETE(m_pCohesionBehavior);
@@ -84,15 +126,24 @@ Flock::~Flock()
 	SAFE_DELETE(m_pBlendedSteering);
 	SAFE_DELETE(m_pPrioritySteering);
 
-	for (int i = 0; i < m_FlockSize; i++)
+	for (SteeringAgent* pAgent : m_Agents)
 	{
-		SAFE_DELETE(m_Agents[i]);
+		SAFE_DELETE(pAgent);
 	}
 	m_Agents.clear();
 }
 
 void Flock::Update(float deltaT)
 {
+	ELITE_PROFILE_SCOPE("Flock::Update");
+	auto start = std::chrono::high_resolution_clock::now();
+	if (m_pPartitioning) m_pPartitioning->ResetStats();
+	m_SpatialHashStats = PartitioningStats{};
+
+	if (m_pSimulation)
+		UpdateSimulation(deltaT);
+
+	// The agents only move when the physics world steps, so every agent sees the others where they were at the start
 	for (size_t i = 0; i < m_Agents.size(); i++)
 	{
 		if (m_TrimWorld)
@@ -100,14 +151,30 @@ void Flock::Update(float deltaT)
 			m_Agents[i]->TrimToWorld(Elite::Vector2(0, 0), Elite::Vector2(m_WorldSize, m_WorldSize));
 		}
 
-		m_pCellSpace->UpdateAgentCell(m_Agents[i], m_OldAgentPos[i]);
-
-		RegisterNeighbors(m_Agents[i]);
-		m_Agents[i]->Update(deltaT);
+		if (m_pPartitioning) m_pPartitioning->UpdateAgentCell(m_Agents[i], m_OldAgentPos[i]);
 		m_OldAgentPos[i] = m_Agents[i]->GetPosition();
-		
 	}
 
+	if (m_UsePartitioning && m_PartitioningType == PartitioningType::SpatialHash)
+	{
+		m_pSpatialHash->SetCellSize(m_NeighborhoodRadius);
+		m_pSpatialHash->Rebuild(m_OldAgentPos);
+	}
+
+	if (m_UseSteeringKernels)
+	{
+		UpdateAgentsBatched(deltaT);
+	}
+	else
+	{
+		for (size_t i = 0; i < m_Agents.size(); i++)
+		{
+			RegisterNeighbors(m_Agents[i]);
+			m_Agents[i]->Update(deltaT);
+		}
+	}
+	m_PartitioningStats = m_pPartitioning ? m_pPartitioning->GetStats() : m_SpatialHashStats;
+
 	// Evade Behaviour
 	TargetData data = TargetData{};
 	data.AngularVelocity = m_pAgentToEvade->GetAngularVelocity();
@@ -119,7 +186,82 @@ void Flock::Update(float deltaT)
 	m_pAgentToEvade->Update(deltaT);
 	if (m_TrimWorld) m_pAgentToEvade->TrimToWorld(Elite::Vector2(0, 0), Elite::Vector2(m_WorldSize, m_WorldSize));
 
-	
+	auto end = std::chrono::high_resolution_clock::now();
+	m_UpdateTime = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void Flock::UpdateAgentsBatched(float deltaT)
+{
+	//1. The neighbor sums and the state of every agent, before any agent gets a new velocity
+	const int nrOfAgents = static_cast<int>(m_Agents.size());
+	m_AgentNeighborSums.resize(nrOfAgents);
+	m_AgentStates.resize(nrOfAgents);
+	m_AgentSteerings.resize(nrOfAgents);
+	for (int i = 0; i < nrOfAgents; ++i)
+	{
+		RegisterNeighbors(m_Agents[i]);
+		m_AgentNeighborSums[i] = m_NeighborSums;
+		m_AgentStates[i] = m_Agents[i]->GetState();
+		m_AgentStates[i].AgentIdx = i;
+	}
+
+	//2. Evade, else the blend, one behavior at a time over all agents
+	m_pPrioritySteering->CalculateSteeringBatch(deltaT, m_AgentStates.data(), m_AgentSteerings.data(), nrOfAgents);
+
+	//3. Every agent moves, and keeps its wander angle for the next frame
+	for (int i = 0; i < nrOfAgents; ++i)
+	{
+		m_Agents[i]->ApplySteering(m_AgentSteerings[i], deltaT);
+		m_Agents[i]->SetWanderAngle(m_AgentStates[i].WanderAngle);
+	}
+}
+
+void Flock::UpdateSimulation(float deltaT)
+{
+	//Same weights, targets and agent to evade as the steering behaviors of the agents
+	FlockWeights& weights = m_pSimulation->GetWeights();
+	weights.separation = *GetWeight(m_pSeparationBehavior);
+	weights.cohesion = *GetWeight(m_pCohesionBehavior);
+	weights.velocityMatch = *GetWeight(m_pVelMatchBehavior);
+	weights.seek = *GetWeight(m_pSeekBehavior);
+	weights.wander = *GetWeight(m_pWanderBehavior);
+
+	m_pSimulation->SetNeighborhoodRadius(m_NeighborhoodRadius);
+	m_pSimulation->SetMaxNeighbors(m_MaxNeighbors);
+	m_pSimulation->SetNrOfThreads(m_NrOfThreads);
+	m_pSimulation->SetTrimWorld(m_TrimWorld);
+	m_pSimulation->SetAgentToEvade(m_pAgentToEvade->GetPosition(), m_pAgentToEvade->GetLinearVelocity());
+	m_pSimulation->Update(deltaT);
+}
+
+void Flock::SetDataOriented(bool isDataOriented)
+{
+	if (isDataOriented == IsDataOriented())
+		return;
+
+	//The agents keep their position and velocity, only the way they are stored changes
+	if (isDataOriented)
+	{
+		m_pSimulation = new FlockSimulation(m_WorldSize);
+		for (SteeringAgent* pAgent : m_Agents)
+		{
+			m_pSimulation->AddAgent(pAgent->GetPosition(), pAgent->GetLinearVelocity());
+			SAFE_DELETE(pAgent);
+		}
+		m_Agents.clear();
+		m_OldAgentPos.clear();
+		CreatePartitioning();
+	}
+	else
+	{
+		CreatePartitioning();
+		for (int i = 0; i < m_pSimulation->GetFlockSize(); ++i)
+		{
+			SteeringAgent* pAgent = CreateAgent(m_pSimulation->GetPosition(i));
+			pAgent->SetLinearVelocity(m_pSimulation->GetLinearVelocity(i));
+		}
+		SAFE_DELETE(m_pSimulation);
+	}
 }
 
 void Flock::Render(float deltaT)
@@ -130,6 +272,11 @@ void Flock::Render(float deltaT)
 		pAgent->Render(deltaT);
 	}
 	*/
+	if (m_pSimulation)
+	{
+		for (int i = 0; i < m_pSimulation->GetFlockSize(); ++i)
+			DEBUGRENDERER2D->DrawPoint(m_pSimulation->GetPosition(i), 3.f, Elite::Color{ 1,1,0 }, 0.5f);
+	}
 	m_pAgentToEvade->Render(deltaT);
 	
 	DebugRender();
@@ -165,6 +312,7 @@ void Flock::UpdateAndRenderUI()
 	ImGui::Indent();
 	ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 	ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+	ImGui::Text("%.3f ms flock update", m_UpdateTime);
 	ImGui::Unindent();
 
 	ImGui::Spacing();
@@ -182,6 +330,40 @@ void Flock::UpdateAndRenderUI()
 	ImGui::Text("Partitioning");
 	ImGui::Spacing();
 	ImGui::Checkbox("Enable Partitioning", &m_UsePartitioning);
+	int partitioningType = static_cast<int>(m_PartitioningType);
+	if (ImGui::Combo("Type", &partitioningType, "Cell space\0Spatial hash\0Quadtree\0", 3))
+		SetPartitioningType(static_cast<PartitioningType>(partitioningType));
+	if (m_pPartitioning) ImGui::Text("%d cells", m_pPartitioning->GetNrOfCells());
+	if (m_UsePartitioning && m_PartitioningStats.nrOfQueries > 0)
+	{
+		ImGui::Text("%d cells visited", m_PartitioningStats.nrOfCellsVisited);
+		ImGui::Text("%d distance tests", m_PartitioningStats.nrOfDistanceTests);
+		ImGui::Text("%.1f tests/query", m_PartitioningStats.nrOfDistanceTests / static_cast<float>(m_PartitioningStats.nrOfQueries));
+	}
+	ImGui::SliderInt("Max neighbors", &m_MaxNeighbors, 0, 32, m_MaxNeighbors == 0 ? "all" : "%.0f");
+
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+
+	ImGui::Text("Simulation");
+	ImGui::Spacing();
+	m_UseDataOrientedFlock = IsDataOriented();
+	if (ImGui::Checkbox("Data-oriented (no physics)", &m_UseDataOrientedFlock))
+		SetDataOriented(m_UseDataOrientedFlock);
+	ImGui::SliderInt("Threads", &m_NrOfThreads, 1, Elite::WorkerPool::GetDefaultNrOfThreads());
+	ImGui::Checkbox("Steering kernels", &m_UseSteeringKernels);
+	ImGui::SameLine();
+	ImGui::Text("(%s)", FlockingKernels::GetInstructionSet());
+	if (ImGui::Button("Benchmark"))
+	{
+		m_BenchmarkReport.clear();
+		if (!m_Agents.empty()) VerifySteeringKernels();
+		RunNeighborQueryBenchmark();
+		RunSteeringBatchBenchmark();
+	}
+	for (const string& line : m_BenchmarkReport)
+		ImGui::TextWrapped("%s", line.c_str());
 
 	ImGui::Spacing();
 	ImGui::Separator();
@@ -205,11 +387,37 @@ void Flock::UpdateAndRenderUI()
 void Flock::RegisterNeighbors(SteeringAgent* pAgent)
 {
 	
-	if (m_UsePartitioning) 
+	if (m_UsePartitioning && m_PartitioningType == PartitioningType::SpatialHash)
+	{
+		int nrOfCells, nrOfPoints;
+		m_pSpatialHash->GetQueryCost(pAgent->GetPosition(), m_NeighborhoodRadius, nrOfCells, nrOfPoints);
+		++m_SpatialHashStats.nrOfQueries;
+		m_SpatialHashStats.nrOfCellsVisited += nrOfCells;
+		m_SpatialHashStats.nrOfDistanceTests += nrOfPoints;
+
+		// Straight into the neighbors of the flock, no copy
+		m_Neighbors.clear();
+		if (m_MaxNeighbors > 0)
+		{
+			m_pSpatialHash->FindNearestNeighbors(pAgent->GetPosition(), m_NeighborhoodRadius, m_MaxNeighbors, m_NearestNeighbors);
+			for (const NearNeighbor& neighbor : m_NearestNeighbors)
+				m_Neighbors.push_back(m_Agents[neighbor.pointIdx]);
+		}
+		else
+		{
+			m_pSpatialHash->ForEachNeighbor(pAgent->GetPosition(), m_NeighborhoodRadius, [this](int agentIdx, float, float, float)
+				{
+					m_Neighbors.push_back(m_Agents[agentIdx]);
+				});
+		}
+		m_NrOfNeighbors = (int)m_Neighbors.size();
+	}
+	else if (m_UsePartitioning) 
 	{
-		m_pCellSpace->RegisterNeighbors(pAgent, m_NeighborhoodRadius);
-		m_Neighbors = m_pCellSpace->GetNeighbors();
-		m_NrOfNeighbors = m_pCellSpace->GetNrOfNeighbors();
+		if (m_MaxNeighbors > 0) m_pPartitioning->RegisterNearestNeighbors(pAgent, m_NeighborhoodRadius, m_MaxNeighbors);
+		else m_pPartitioning->RegisterNeighbors(pAgent, m_NeighborhoodRadius);
+		m_Neighbors = m_pPartitioning->GetNeighbors();
+		m_NrOfNeighbors = m_pPartitioning->GetNrOfNeighbors();
 	}
 	else 
 	{
@@ -225,13 +433,43 @@ void Flock::RegisterNeighbors(SteeringAgent* pAgent)
 				m_NrOfNeighbors++;
 			}
 		}
+
+		// Nearest ones first, drop the rest
+		if (m_MaxNeighbors > 0 && m_NrOfNeighbors > m_MaxNeighbors)
+		{
+			const Elite::Vector2 position{ pAgent->GetPosition() };
+			std::partial_sort(m_Neighbors.begin(), m_Neighbors.begin() + m_MaxNeighbors, m_Neighbors.end(),
+				[&position](SteeringAgent* pA, SteeringAgent* pB)
+				{
+					return Elite::DistanceSquared(position, pA->GetPosition()) < Elite::DistanceSquared(position, pB->GetPosition());
+				});
+			m_Neighbors.resize(m_MaxNeighbors);
+			m_NrOfNeighbors = m_MaxNeighbors;
+		}
 	}
 
-	
+	if (m_UseSteeringKernels)
+		SumNeighbors(pAgent);
+}
+
+void Flock::SumNeighbors(SteeringAgent* pAgent)
+{
+	// Every neighbor's rigidbody is read once, the behaviors only read the sums
+	m_NeighborhoodCenter = pAgent->GetPosition();
+	m_Neighborhood.Clear();
+	for (SteeringAgent* pNeighbor : m_Neighbors)
+		m_Neighborhood.Add(pNeighbor->GetPosition() - m_NeighborhoodCenter, pNeighbor->GetLinearVelocity());
+	m_NeighborSums = FlockingKernels::SumNeighbors(m_Neighborhood);
 }
 
 Elite::Vector2 Flock::GetAverageNeighborPos() const
 {
+	if (m_UseSteeringKernels)
+	{
+		if (m_NeighborSums.count == 0) return Elite::ZeroVector2;
+		return m_NeighborhoodCenter + m_NeighborSums.offsetSum / static_cast<float>(m_NeighborSums.count);
+	}
+
 	float xSum{};
 	float ySum{};
 
@@ -259,6 +497,12 @@ Elite::Vector2 Flock::GetAverageNeighborPos() const
 
 Elite::Vector2 Flock::GetAverageNeighborVelocity() const
 {
+	if (m_UseSteeringKernels)
+	{
+		if (m_NeighborSums.count == 0) return Elite::ZeroVector2;
+		return m_NeighborSums.velocitySum / static_cast<float>(m_NeighborSums.count);
+	}
+
 	float xSum{};
 	float ySum{};
 
@@ -286,6 +530,7 @@ Elite::Vector2 Flock::GetAverageNeighborVelocity() const
 void Flock::SetSeekTarget(TargetData target)
 {
 	m_pSeekBehavior->SetTarget(target);
+	if (m_pSimulation) m_pSimulation->SetSeekTarget(target.Position);
 }
 
 float* Flock::GetWeight(ISteeringBehavior* pBehavior) 
@@ -311,7 +556,20 @@ float* Flock::GetWeight(ISteeringBehavior* pBehavior)
 void Flock::DebugRender()
 {
 
-	if (m_DebugRendering) 
+	if (m_DebugRendering && m_pSimulation)
+	{
+		// Neighborhood of the first agent
+		if (m_pSimulation->GetFlockSize() > 0)
+		{
+			DEBUGRENDERER2D->DrawCircle(m_pSimulation->GetPosition(0), m_NeighborhoodRadius, Elite::Color{ 0,1,0 }, 0);
+			m_pSimulation->FindNeighbors(0, m_SimulationNeighbors);
+			for (int neighborIdx : m_SimulationNeighbors)
+				DEBUGRENDERER2D->DrawPoint(m_pSimulation->GetPosition(neighborIdx), 5.f, Elite::Color{ 0,1,0 }, 0.4f);
+		}
+
+		DEBUGRENDERER2D->DrawCircle(m_pAgentToEvade->GetPosition(), m_pSimulation->GetEvadeRange(), Elite::Color{ 0,0,1 }, 0);
+	}
+	else if (m_DebugRendering) 
 	{
 		// Change color of first Agent
 		m_Agents[0]->SetBodyColor(Elite::Color{ 0,0,1 });
@@ -320,9 +578,7 @@ void Flock::DebugRender()
 		DEBUGRENDERER2D->DrawCircle(m_Agents[0]->GetPosition(), m_NeighborhoodRadius, Elite::Color{ 0,1,0 }, 0);
 
 		// Draw Neighbors
-		if (m_UsePartitioning) m_pCellSpace->RegisterNeighbors(m_Agents[0], m_NeighborhoodRadius);
-		else RegisterNeighbors(m_Agents[0]);
-		if (m_UsePartitioning) m_Neighbors = m_pCellSpace->GetNeighbors();
+		RegisterNeighbors(m_Agents[0]);
 
 		for (SteeringAgent* pAgent : m_Neighbors)
 		{
@@ -335,7 +591,8 @@ void Flock::DebugRender()
 		if (m_UsePartitioning) 
 		{
 			// Draw Cells
-			if (m_UsePartitioning) m_pCellSpace->DebugRender(m_NeighborhoodRadius);
+			if (m_pPartitioning) m_pPartitioning->DebugRender(m_NeighborhoodRadius);
+			else m_pSpatialHash->DebugRender(m_Agents[0]->GetPosition(), m_NeighborhoodRadius);
 		}
 	}
 	else 
@@ -351,3 +608,221 @@ void Flock::DebugRender()
 	
 
 }
+
+void Flock::RunNeighborQueryBenchmark()
+{
+	//Neighbor queries of every agent of a flock at the density of this flock: the cell space as the Flock uses it, the quadtree and the spatial hash
+	//The agents jitter a bit every frame so all of them have to follow, clumped flocks have a few dense clusters
+	//The agents need rigidbodies, so this is not in GPP_Benchmarks like the data-oriented flock
+	const float density = m_FlockSize / (m_WorldSize * m_WorldSize);
+	const float cellSize = m_WorldSize / 25.f;
+	const int nrOfQueryFrames = 10;
+	m_BenchmarkReport.push_back("Neighbor queries:");
+	for (bool isClumped : { false, true })
+	{
+		for (int flockSize : { 1000, 10000 })
+		{
+			const float worldSize = sqrtf(flockSize / density);
+			const int nrOfCells = static_cast<int>(worldSize / cellSize);
+			CellSpace cellSpace{ worldSize, worldSize, nrOfCells, nrOfCells, flockSize };
+			QuadTreeSpace quadTree{ worldSize, worldSize };
+			SpatialHashGrid spatialHash{ worldSize, worldSize, m_NeighborhoodRadius };
+
+			std::mt19937 rng{ static_cast<unsigned int>(flockSize) };
+			std::uniform_real_distribution<float> randomPosition{ 0.f, worldSize - 1.f };
+			std::normal_distribution<float> randomOffset{ 0.f, worldSize / 40.f };
+			vector<Elite::Vector2> clusterCenters{};
+			for (int i = 0; i < 8; ++i)
+				clusterCenters.push_back({ randomPosition(rng), randomPosition(rng) });
+
+			vector<SteeringAgent*> agents{};
+			vector<Elite::Vector2> positions{};
+			for (int i = 0; i < flockSize; ++i)
+			{
+				Elite::Vector2 position{ randomPosition(rng), randomPosition(rng) };
+				if (isClumped)
+				{
+					position = clusterCenters[i % clusterCenters.size()] + Elite::Vector2{ randomOffset(rng), randomOffset(rng) };
+					position.x = Elite::Clamp(position.x, 0.f, worldSize - 1.f);
+					position.y = Elite::Clamp(position.y, 0.f, worldSize - 1.f);
+				}
+				agents.push_back(new SteeringAgent());
+				positions.push_back(position);
+				agents.back()->SetPosition(position);
+				cellSpace.AddAgent(agents.back());
+				quadTree.AddAgent(agents.back());
+			}
+
+			float times[3]{};
+			long long nrOfNeighbors[3]{};
+			long long nrOfDistanceTests = 0;
+			vector<int> neighborIdxs{};
+			for (int frame = 0; frame < nrOfQueryFrames; ++frame)
+			{
+				vector<Elite::Vector2> oldPositions = positions;
+				for (int i = 0; i < flockSize; ++i)
+				{
+					positions[i].x = Elite::Clamp(positions[i].x + Elite::randomFloat(-1.f, 1.f), 0.f, worldSize - 1.f);
+					positions[i].y = Elite::Clamp(positions[i].y + Elite::randomFloat(-1.f, 1.f), 0.f, worldSize - 1.f);
+					agents[i]->SetPosition(positions[i]);
+				}
+
+				ISpacePartitioning* pPartitionings[2]{ &cellSpace, &quadTree };
+				for (int p = 0; p < 2; ++p)
+				{
+					auto start = std::chrono::high_resolution_clock::now();
+					for (int i = 0; i < flockSize; ++i)
+					{
+						pPartitionings[p]->UpdateAgentCell(agents[i], oldPositions[i]);
+						pPartitionings[p]->RegisterNeighbors(agents[i], m_NeighborhoodRadius);
+						nrOfNeighbors[p] += pPartitionings[p]->GetNrOfNeighbors();
+					}
+					auto end = std::chrono::high_resolution_clock::now();
+					times[p] += std::chrono::duration<float, std::milli>(end - start).count();
+				}
+
+				auto start = std::chrono::high_resolution_clock::now();
+				spatialHash.Rebuild(positions);
+				for (int i = 0; i < flockSize; ++i)
+				{
+					spatialHash.FindNeighbors(positions[i], m_NeighborhoodRadius, neighborIdxs);
+					nrOfNeighbors[2] += neighborIdxs.size();
+				}
+				auto end = std::chrono::high_resolution_clock::now();
+				times[2] += std::chrono::duration<float, std::milli>(end - start).count();
+
+				for (int i = 0; i < flockSize; ++i)
+				{
+					int nrOfQueryCells, nrOfQueryPoints;
+					spatialHash.GetQueryCost(positions[i], m_NeighborhoodRadius, nrOfQueryCells, nrOfQueryPoints);
+					nrOfDistanceTests += nrOfQueryPoints;
+				}
+			}
+
+			//Distance tests per query, what the partitioning could not rule out
+			const float nrOfQueries = static_cast<float>(nrOfQueryFrames * flockSize);
+			const char* names[3]{ "cell space", "quadtree", "spatial hash" };
+			const float distanceTests[3]{ cellSpace.GetStats().nrOfDistanceTests / nrOfQueries,
+				quadTree.GetStats().nrOfDistanceTests / nrOfQueries, nrOfDistanceTests / nrOfQueries };
+			std::ostringstream report{};
+			report.precision(3);
+			report << flockSize << (isClumped ? " clumped" : " spread") << " agents:";
+			for (int p = 0; p < 3; ++p)
+			{
+				report << " " << names[p] << " " << times[p] / nrOfQueryFrames << " ms/frame ("
+					<< nrOfNeighbors[p] / nrOfQueries << " neighbors, " << distanceTests[p] << " tests/query)" << (p < 2 ? "," : "");
+			}
+			report << ", quadtree " << quadTree.GetNrOfCells() << " leaves, depth " << quadTree.GetDepth();
+			m_BenchmarkReport.push_back(report.str());
+
+			for (SteeringAgent* pAgent : agents)
+				SAFE_DELETE(pAgent);
+		}
+	}
+}
+
+void Flock::RunSteeringBatchBenchmark()
+{
+	//Priority and blended steering like the flock has, without the flocking behaviors, one agent at a time against batched
+	//Both have to give the same steering, Wander is left out as it is random
+	const int nrOfAgents = 10000;
+	const int nrOfFrames = 20;
+	const float deltaT = 1.f / 60.f;
+
+	Seek seek{};
+	Arrive arrive{};
+	Pursuit pursuit{};
+	Evade evade{};
+	BlendedSteering blendedSteering({ { &seek, 0.5f }, { &arrive, 0.5f }, { &pursuit, 0.5f } });
+	PrioritySteering prioritySteering({ &evade, &blendedSteering });
+
+	const TargetData target{ { m_WorldSize / 2.f, m_WorldSize / 2.f }, 0.f, { 10.f, 5.f } };
+	seek.SetTarget(target);
+	arrive.SetTarget(target);
+	pursuit.SetTarget(target);
+	evade.SetTarget(target);
+
+	vector<SteeringAgent*> agents{};
+	vector<AgentState> states{};
+	for (int i = 0; i < nrOfAgents; ++i)
+	{
+		SteeringAgent* pAgent = new SteeringAgent();
+		pAgent->SetPosition({ Elite::randomFloat(m_WorldSize), Elite::randomFloat(m_WorldSize) });
+		pAgent->SetLinearVelocity({ Elite::randomFloat(-10.f, 10.f), Elite::randomFloat(-10.f, 10.f) });
+		agents.push_back(pAgent);
+		states.push_back(pAgent->GetState());
+	}
+
+	vector<SteeringOutput> steerings(nrOfAgents);
+	vector<SteeringOutput> batchSteerings(nrOfAgents);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < nrOfFrames; ++frame)
+	{
+		for (int i = 0; i < nrOfAgents; ++i)
+			steerings[i] = prioritySteering.CalculateSteering(deltaT, agents[i]);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	const float agentTime = std::chrono::duration<float, std::milli>(end - start).count() / nrOfFrames;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < nrOfFrames; ++frame)
+		prioritySteering.CalculateSteeringBatch(deltaT, states.data(), batchSteerings.data(), nrOfAgents);
+	end = std::chrono::high_resolution_clock::now();
+	const float batchTime = std::chrono::duration<float, std::milli>(end - start).count() / nrOfFrames;
+
+	float maxError = 0.f;
+	bool isSameValidity = true;
+	for (int i = 0; i < nrOfAgents; ++i)
+	{
+		const float error = Elite::Distance(steerings[i].LinearVelocity, batchSteerings[i].LinearVelocity);
+		maxError = error > maxError ? error : maxError;
+		isSameValidity = isSameValidity && steerings[i].IsValid == batchSteerings[i].IsValid;
+	}
+
+	std::ostringstream report{};
+	report.precision(3);
+	report << "Batched steering: " << nrOfAgents << " agents one at a time " << agentTime << " ms/frame, batched " << batchTime << " ms/frame, x"
+		<< agentTime / batchTime << ", max difference " << maxError << (isSameValidity ? "" : ", DIFFERENT VALIDITY");
+	m_BenchmarkReport.push_back(report.str());
+
+	for (SteeringAgent* pAgent : agents)
+		SAFE_DELETE(pAgent);
+}
+
+void Flock::VerifySteeringKernels()
+{
+	//The kernels against Cohesion, Separation and VelocityMatch reading the neighbors one by one, on every agent of the flock
+	const bool useSteeringKernels = m_UseSteeringKernels;
+	const float deltaT = 1.f / 60.f;
+	float maxError = 0.f;
+	float originalTime = 0.f;
+	float kernelTime = 0.f;
+	for (SteeringAgent* pAgent : m_Agents)
+	{
+		SteeringOutput outputs[2][3]{};
+		for (int k = 0; k < 2; ++k)
+		{
+			m_UseSteeringKernels = k == 1;
+			auto start = std::chrono::high_resolution_clock::now();
+			RegisterNeighbors(pAgent);
+			outputs[k][0] = m_pCohesionBehavior->CalculateSteering(deltaT, pAgent);
+			outputs[k][1] = m_pSeparationBehavior->CalculateSteering(deltaT, pAgent);
+			outputs[k][2] = m_pVelMatchBehavior->CalculateSteering(deltaT, pAgent);
+			auto end = std::chrono::high_resolution_clock::now();
+			(k == 0 ? originalTime : kernelTime) += std::chrono::duration<float, std::milli>(end - start).count();
+		}
+
+		for (int b = 0; b < 3; ++b)
+		{
+			const float error = Elite::Distance(outputs[0][b].LinearVelocity, outputs[1][b].LinearVelocity);
+			maxError = error > maxError ? error : maxError;
+		}
+	}
+	m_UseSteeringKernels = useSteeringKernels;
+
+	std::ostringstream report{};
+	report.precision(3);
+	report << "Steering kernels (" << FlockingKernels::GetInstructionSet() << "): " << m_Agents.size() << " agents, largest difference with the behaviors "
+		<< maxError << ", behaviors " << originalTime << " ms, kernels " << kernelTime << " ms (neighbor search included)";
+	m_BenchmarkReport.push_back(report.str());
+}
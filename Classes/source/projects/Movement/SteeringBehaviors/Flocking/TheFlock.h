@@ -1,16 +1,26 @@
 #pragma once
 #include "../SteeringHelpers.h"
 #include "FlockingSteeringBehaviors.h"
+#include "FlockingKernels.h"
 #include "projects/Movement/SteeringBehaviors/SpacePartitioning/SpacePartitioning.h"
+#include "framework/EliteHelpers/EWorkerPool.h"
 
 class ISteeringBehavior;
 class SteeringAgent;
 class BlendedSteering;
 class PrioritySteering;
+class FlockSimulation;
 
 
 //#define USE_SPACE_PARTITIONING
 
+enum class PartitioningType
+{
+	CellSpace,
+	SpatialHash,
+	QuadTree
+};
+
 class Flock
 {
 public:
@@ -33,16 +43,32 @@ public:
 
 	Elite::Vector2 GetAverageNeighborPos() const;
 	Elite::Vector2 GetAverageNeighborVelocity() const;
+	// Sums of the registered neighbors, only up to date when the steering kernels are used
+	bool UsesSteeringKernels() const { return m_UseSteeringKernels; }
+	const FlockNeighborSums& GetNeighborSums() const { return m_NeighborSums; }
+	// Sums of every agent by index, for the batched flocking behaviors during the update with the steering kernels
+	const FlockNeighborSums& GetNeighborSums(int agentIdx) const { return m_AgentNeighborSums[agentIdx]; }
 
 	void SetSeekTarget(TargetData target);
 	void SetWorldTrimSize(float size) { m_WorldSize = size; }
 
+	// Data-oriented mode: the agents move without rigidbodies, see FlockSimulation
+	void SetDataOriented(bool isDataOriented);
+	bool IsDataOriented() const { return m_pSimulation != nullptr; }
+
+	void SetPartitioningType(PartitioningType type);
+	PartitioningType GetPartitioningType() const { return m_PartitioningType; }
+
 private:
 	//Datamembers
 
 	//Partitioning
 	bool m_UsePartitioning = true;
-	CellSpace* m_pCellSpace = nullptr;
+	PartitioningType m_PartitioningType = PartitioningType::CellSpace; // the spatial hash and the quadtree are picked in the UI
+	ISpacePartitioning* m_pPartitioning = nullptr; // cell space or quadtree, nullptr for the spatial hash
+	SpatialHashGrid* m_pSpatialHash = nullptr; // rebuilt every frame
+	PartitioningStats m_PartitioningStats{}; // of the last update
+	PartitioningStats m_SpatialHashStats{};
 
 	int m_FlockSize = 0;
 	vector<SteeringAgent*> m_Agents;
@@ -56,8 +82,29 @@ private:
 
 	float m_NeighborhoodRadius = 5.f;
 	int m_NrOfNeighbors = 0;
+	int m_MaxNeighbors = 0; // only the nearest neighbors steer an agent, 0 for all of them
+	vector<NearNeighbor> m_NearestNeighbors;
+
+	//Neighbors packed into arrays once per agent, summed with FlockingKernels for Cohesion, Separation and VelocityMatch
+	bool m_UseSteeringKernels = true;
+	FlockNeighborhood m_Neighborhood;
+	FlockNeighborSums m_NeighborSums;
+	Elite::Vector2 m_NeighborhoodCenter;
+
+	//With the steering kernels all agents are steered in one batch, see UpdateAgentsBatched
+	vector<FlockNeighborSums> m_AgentNeighborSums;
+	vector<AgentState> m_AgentStates;
+	vector<SteeringOutput> m_AgentSteerings;
 
 	SteeringAgent* m_pAgentToEvade = nullptr;
+
+	//Data-oriented mode
+	FlockSimulation* m_pSimulation = nullptr;
+	bool m_UseDataOrientedFlock = false;
+	vector<int> m_SimulationNeighbors;
+	int m_NrOfThreads = Elite::WorkerPool::GetDefaultNrOfThreads();
+	float m_UpdateTime = 0.f;
+	vector<string> m_BenchmarkReport; // lines shown under the benchmark button
 	
 	//Steering Behaviors
 	Separation* m_pSeparationBehavior = nullptr;
@@ -71,6 +118,14 @@ private:
 	PrioritySteering* m_pPrioritySteering = nullptr;
 
 	float* GetWeight(ISteeringBehavior* pBehaviour);
+	SteeringAgent* CreateAgent(const Elite::Vector2& position);
+	void CreatePartitioning();
+	void UpdateSimulation(float deltaT);
+	void UpdateAgentsBatched(float deltaT);
+	void RunNeighborQueryBenchmark();
+	void RunSteeringBatchBenchmark();
+	void SumNeighbors(SteeringAgent* pAgent);
+	void VerifySteeringKernels();
 
 private:
 	Flock(const Flock& other);
@@ -108,9 +108,12 @@ void CellSpace::RegisterNeighbors(SteeringAgent* agent, float queryRadius)
 	{
 		m_Neighbors.clear();
 		m_NrOfNeighbors = 0;
+		++m_Stats.nrOfQueries;
+		m_Stats.nrOfCellsVisited += m_NrOfCellsToCheck;
 
 		for (int i = 0; i < m_NrOfCellsToCheck; i++)
 		{
+			m_Stats.nrOfDistanceTests += (int)m_CellsToCheck[i]->agents.size();
 			for (SteeringAgent* pOtherAgent : m_CellsToCheck[i]->agents)
 			{
 				float distance{ Elite::Distance(agent->GetPosition(), pOtherAgent->GetPosition()) };
@@ -125,6 +128,46 @@ void CellSpace::RegisterNeighbors(SteeringAgent* agent, float queryRadius)
 	}
 }
 
+void CellSpace::RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors)
+{
+	GetNeighborCells(agent, queryRadius);
+
+	// Max heap on distance: once it is full, a nearer agent replaces the farthest one
+	auto isNearer = [](const std::pair<float, SteeringAgent*>& a, const std::pair<float, SteeringAgent*>& b) { return a.first < b.first; };
+	m_NearestNeighbors.clear();
+	++m_Stats.nrOfQueries;
+	m_Stats.nrOfCellsVisited += m_NrOfCellsToCheck;
+	const float radiusSquared{ queryRadius * queryRadius };
+	for (int i = 0; i < m_NrOfCellsToCheck; i++)
+	{
+		m_Stats.nrOfDistanceTests += (int)m_CellsToCheck[i]->agents.size();
+		for (SteeringAgent* pOtherAgent : m_CellsToCheck[i]->agents)
+		{
+			const float distanceSquared{ Elite::DistanceSquared(agent->GetPosition(), pOtherAgent->GetPosition()) };
+			if (distanceSquared >= radiusSquared)
+				continue;
+
+			if ((int)m_NearestNeighbors.size() < maxNeighbors)
+			{
+				m_NearestNeighbors.push_back({ distanceSquared, pOtherAgent });
+				std::push_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+			}
+			else if (maxNeighbors > 0 && distanceSquared < m_NearestNeighbors.front().first)
+			{
+				std::pop_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+				m_NearestNeighbors.back() = { distanceSquared, pOtherAgent };
+				std::push_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+			}
+		}
+	}
+	std::sort_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+
+	m_Neighbors.clear();
+	for (const auto& neighbor : m_NearestNeighbors)
+		m_Neighbors.push_back(neighbor.second);
+	m_NrOfNeighbors = (int)m_Neighbors.size();
+}
+
 void CellSpace::GetNeighborCells(SteeringAgent* agent, float queryRadius)
 {
 	m_NrOfCellsToCheck = 0;
@@ -230,3 +273,353 @@ int CellSpace::PositionToIndex(const Elite::Vector2 pos) const
 	return index;
 }
 
+
+// --- Loose Quadtree ---
+// ----------------------
+QuadTreeSpace::QuadTreeSpace(float width, float height, int maxAgentsPerNode, int maxDepth, float looseness)
+	: m_MaxAgentsPerNode(maxAgentsPerNode > 1 ? maxAgentsPerNode : 2)
+	, m_MaxDepth(maxDepth)
+	, m_Looseness(looseness < 1.f ? 1.f : looseness)
+{
+	// Square root around the space, so every node is square
+	const float halfSize = (width > height ? width : height) * 0.5f;
+	m_Nodes.push_back(Node{ Vector2{ width * 0.5f, height * 0.5f }, halfSize, 0, -1, -1, 0, {} });
+}
+
+void QuadTreeSpace::AddAgent(SteeringAgent* agent)
+{
+	Insert(agent, agent->GetPosition());
+}
+
+void QuadTreeSpace::UpdateAgentCell(SteeringAgent* agent, Elite::Vector2 /*oldPos*/)
+{
+	// The leaf is looked up, an agent can be outside the tight box of its leaf
+	auto foundIt = m_AgentLeaves.find(agent);
+	if (foundIt == m_AgentLeaves.end())
+		return;
+
+	// An agent outside of the space stays in the root until it comes back in
+	const Vector2 position = agent->GetPosition();
+	const int leafIdx = foundIt->second;
+	const bool isOutsideSpace = !IsInsideRoot(position);
+	if (leafIdx == 0 && m_Nodes[0].firstChild != -1 ? isOutsideSpace : IsInsideLoose(m_Nodes[leafIdx], position))
+		return;
+
+	Remove(agent, leafIdx);
+	Insert(agent, position);
+}
+
+void QuadTreeSpace::Insert(SteeringAgent* agent, const Elite::Vector2& position)
+{
+	// Down to the leaf whose tight box holds the position, positions outside the root stay in the root:
+	// no loose box of a leaf would hold them
+	const bool isInsideRoot = IsInsideRoot(position);
+	int nodeIdx = 0;
+	++m_Nodes[nodeIdx].nrOfAgents;
+	while (m_Nodes[nodeIdx].firstChild != -1 && isInsideRoot)
+	{
+		const Node& node = m_Nodes[nodeIdx];
+		const int quadrant = (position.x >= node.center.x ? 1 : 0) + (position.y >= node.center.y ? 2 : 0);
+		nodeIdx = node.firstChild + quadrant;
+		++m_Nodes[nodeIdx].nrOfAgents;
+	}
+
+	m_Nodes[nodeIdx].agents.push_back(agent);
+	m_AgentLeaves[agent] = nodeIdx;
+
+	if (m_Nodes[nodeIdx].firstChild == -1 && (int)m_Nodes[nodeIdx].agents.size() > m_MaxAgentsPerNode && m_Nodes[nodeIdx].depth < m_MaxDepth)
+		Split(nodeIdx);
+}
+
+void QuadTreeSpace::Remove(SteeringAgent* agent, int leafIdx)
+{
+	std::vector<SteeringAgent*>& agents = m_Nodes[leafIdx].agents;
+	auto foundIt = std::find(agents.begin(), agents.end(), agent);
+	*foundIt = agents.back();
+	agents.pop_back();
+	m_AgentLeaves.erase(agent);
+
+	// Fewer agents up to the root, the highest node that became sparse enough takes the agents of its subtree back
+	int mergeIdx = -1;
+	for (int nodeIdx = leafIdx; nodeIdx != -1; nodeIdx = m_Nodes[nodeIdx].parent)
+	{
+		--m_Nodes[nodeIdx].nrOfAgents;
+		if (m_Nodes[nodeIdx].firstChild != -1 && m_Nodes[nodeIdx].nrOfAgents <= m_MaxAgentsPerNode / 2)
+			mergeIdx = nodeIdx;
+	}
+	if (mergeIdx != -1)
+		Merge(mergeIdx);
+}
+
+void QuadTreeSpace::Split(int nodeIdx)
+{
+	// Reuse a freed group of four children if there is one, m_Nodes can grow so no references across this
+	int firstChild;
+	if (!m_FreeChildren.empty())
+	{
+		firstChild = m_FreeChildren.back();
+		m_FreeChildren.pop_back();
+	}
+	else
+	{
+		firstChild = (int)m_Nodes.size();
+		m_Nodes.resize(m_Nodes.size() + 4);
+	}
+
+	const Vector2 center = m_Nodes[nodeIdx].center;
+	const float childHalfSize = m_Nodes[nodeIdx].halfSize * 0.5f;
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		Node& child = m_Nodes[firstChild + quadrant];
+		child.center = center + Vector2{ (quadrant & 1) ? childHalfSize : -childHalfSize, (quadrant & 2) ? childHalfSize : -childHalfSize };
+		child.halfSize = childHalfSize;
+		child.depth = m_Nodes[nodeIdx].depth + 1;
+		child.parent = nodeIdx;
+		child.firstChild = -1;
+		child.nrOfAgents = 0;
+		child.agents.clear();
+	}
+	m_Nodes[nodeIdx].firstChild = firstChild;
+
+	// Hand the agents down, a child that gets too many splits again
+	// An agent in the loose border of the node would not be inside the loose box of any child, it is inserted again,
+	// into the root when it is outside of the space
+	std::vector<SteeringAgent*> agents{};
+	std::vector<SteeringAgent*> agentsOutside{};
+	agents.swap(m_Nodes[nodeIdx].agents);
+	for (SteeringAgent* pAgent : agents)
+	{
+		const Vector2 position = pAgent->GetPosition();
+		const bool isInsideNode = fabsf(position.x - center.x) <= 2.f * childHalfSize && fabsf(position.y - center.y) <= 2.f * childHalfSize;
+		if (!isInsideNode)
+		{
+			agentsOutside.push_back(pAgent);
+			m_AgentLeaves.erase(pAgent);
+			for (int idx = nodeIdx; idx != -1; idx = m_Nodes[idx].parent)
+				--m_Nodes[idx].nrOfAgents;
+			continue;
+		}
+
+		const int quadrant = (position.x >= center.x ? 1 : 0) + (position.y >= center.y ? 2 : 0);
+		m_Nodes[firstChild + quadrant].agents.push_back(pAgent);
+		++m_Nodes[firstChild + quadrant].nrOfAgents;
+		m_AgentLeaves[pAgent] = firstChild + quadrant;
+	}
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		const int childIdx = firstChild + quadrant;
+		if ((int)m_Nodes[childIdx].agents.size() > m_MaxAgentsPerNode && m_Nodes[childIdx].depth < m_MaxDepth)
+			Split(childIdx);
+	}
+	for (SteeringAgent* pAgent : agentsOutside)
+		Insert(pAgent, pAgent->GetPosition());
+}
+
+void QuadTreeSpace::Merge(int nodeIdx)
+{
+	// Collect the agents of the whole subtree into the node, free every group of children below it
+	m_NodesToVisit.clear();
+	m_NodesToVisit.push_back(m_Nodes[nodeIdx].firstChild);
+	m_Nodes[nodeIdx].firstChild = -1;
+	while (!m_NodesToVisit.empty())
+	{
+		const int firstChild = m_NodesToVisit.back();
+		m_NodesToVisit.pop_back();
+		m_FreeChildren.push_back(firstChild);
+
+		for (int childIdx = firstChild; childIdx < firstChild + 4; ++childIdx)
+		{
+			Node& child = m_Nodes[childIdx];
+			if (child.firstChild != -1)
+				m_NodesToVisit.push_back(child.firstChild);
+			for (SteeringAgent* pAgent : child.agents)
+			{
+				m_Nodes[nodeIdx].agents.push_back(pAgent);
+				m_AgentLeaves[pAgent] = nodeIdx;
+			}
+			child.agents.clear();
+		}
+	}
+}
+
+bool QuadTreeSpace::IsInsideRoot(const Elite::Vector2& position) const
+{
+	const Node& root = m_Nodes[0];
+	return fabsf(position.x - root.center.x) <= root.halfSize && fabsf(position.y - root.center.y) <= root.halfSize;
+}
+
+bool QuadTreeSpace::IsInsideLoose(const Node& node, const Elite::Vector2& position) const
+{
+	// The root holds everything, also agents that left the space
+	if (node.parent == -1)
+		return true;
+
+	const float looseHalfSize = node.halfSize * m_Looseness;
+	return fabsf(position.x - node.center.x) <= looseHalfSize && fabsf(position.y - node.center.y) <= looseHalfSize;
+}
+
+bool QuadTreeSpace::IsOverlappingLoose(const Node& node, const Elite::Vector2& position, float radius) const
+{
+	if (node.parent == -1)
+		return true;
+
+	// Distance from the position to the loose box
+	const float looseHalfSize = node.halfSize * m_Looseness;
+	const float distanceX = fabsf(position.x - node.center.x) - looseHalfSize;
+	const float distanceY = fabsf(position.y - node.center.y) - looseHalfSize;
+	const float outsideX = distanceX > 0.f ? distanceX : 0.f;
+	const float outsideY = distanceY > 0.f ? distanceY : 0.f;
+	return outsideX * outsideX + outsideY * outsideY < radius * radius;
+}
+
+template<typename Visitor>
+void QuadTreeSpace::ForEachAgentInRadius(const Elite::Vector2& position, float radius, Visitor visitor)
+{
+	++m_Stats.nrOfQueries;
+	const float radiusSquared = radius * radius;
+
+	m_NodesToVisit.clear();
+	m_NodesToVisit.push_back(0);
+	while (!m_NodesToVisit.empty())
+	{
+		const Node& node = m_Nodes[m_NodesToVisit.back()];
+		m_NodesToVisit.pop_back();
+		++m_Stats.nrOfCellsVisited;
+		if (!IsOverlappingLoose(node, position, radius))
+			continue;
+
+		// Besides the leaves only the root has agents of its own, the ones outside of the space
+		if (node.firstChild != -1)
+		{
+			for (int childIdx = node.firstChild; childIdx < node.firstChild + 4; ++childIdx)
+			{
+				if (m_Nodes[childIdx].nrOfAgents > 0)
+					m_NodesToVisit.push_back(childIdx);
+			}
+			if (node.agents.empty())
+				continue;
+		}
+
+		m_Stats.nrOfDistanceTests += (int)node.agents.size();
+		for (SteeringAgent* pOtherAgent : node.agents)
+		{
+			const float distanceSquared = Elite::DistanceSquared(position, pOtherAgent->GetPosition());
+			if (distanceSquared < radiusSquared)
+				visitor(pOtherAgent, distanceSquared);
+		}
+	}
+}
+
+void QuadTreeSpace::RegisterNeighbors(SteeringAgent* agent, float queryRadius)
+{
+	m_Neighbors.clear();
+	ForEachAgentInRadius(agent->GetPosition(), queryRadius, [this](SteeringAgent* pOtherAgent, float)
+		{
+			m_Neighbors.push_back(pOtherAgent);
+		});
+}
+
+void QuadTreeSpace::RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors)
+{
+	// Same bounded heap as the cell space
+	auto isNearer = [](const std::pair<float, SteeringAgent*>& a, const std::pair<float, SteeringAgent*>& b) { return a.first < b.first; };
+	m_NearestNeighbors.clear();
+	ForEachAgentInRadius(agent->GetPosition(), queryRadius, [&](SteeringAgent* pOtherAgent, float distanceSquared)
+		{
+			if ((int)m_NearestNeighbors.size() < maxNeighbors)
+			{
+				m_NearestNeighbors.push_back({ distanceSquared, pOtherAgent });
+				std::push_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+			}
+			else if (maxNeighbors > 0 && distanceSquared < m_NearestNeighbors.front().first)
+			{
+				std::pop_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+				m_NearestNeighbors.back() = { distanceSquared, pOtherAgent };
+				std::push_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+			}
+		});
+	std::sort_heap(m_NearestNeighbors.begin(), m_NearestNeighbors.end(), isNearer);
+
+	m_Neighbors.clear();
+	for (const auto& neighbor : m_NearestNeighbors)
+		m_Neighbors.push_back(neighbor.second);
+}
+
+int QuadTreeSpace::GetNrOfCells() const
+{
+	// Every split turns a leaf into four
+	const int nrOfGroups = ((int)m_Nodes.size() - 1) / 4 - (int)m_FreeChildren.size();
+	return 1 + 3 * nrOfGroups;
+}
+
+int QuadTreeSpace::GetDepth() const
+{
+	int depth = 0;
+	for (const auto& agentLeaf : m_AgentLeaves)
+		depth = m_Nodes[agentLeaf.second].depth > depth ? m_Nodes[agentLeaf.second].depth : depth;
+	return depth;
+}
+
+void QuadTreeSpace::DebugRender(float queryRadius)
+{
+	// Tight box and number of agents of every leaf in use
+	m_NodesToVisit.clear();
+	m_NodesToVisit.push_back(0);
+	while (!m_NodesToVisit.empty())
+	{
+		const Node& node = m_Nodes[m_NodesToVisit.back()];
+		m_NodesToVisit.pop_back();
+		if (node.firstChild != -1)
+		{
+			for (int childIdx = node.firstChild; childIdx < node.firstChild + 4; ++childIdx)
+				m_NodesToVisit.push_back(childIdx);
+			continue;
+		}
+
+		const Vector2 halfExtent{ node.halfSize, node.halfSize };
+		Elite::Polygon polygon{ std::vector<Vector2>{ node.center - halfExtent, node.center + Vector2{ -node.halfSize, node.halfSize },
+			node.center + halfExtent, node.center + Vector2{ node.halfSize, -node.halfSize } } };
+		DEBUGRENDERER2D->DrawPolygon(&polygon, Color{ 1,0,0 });
+		if (!node.agents.empty())
+			DEBUGRENDERER2D->DrawString(node.center + Vector2{ -node.halfSize, node.halfSize } * 0.9f, std::to_string(node.agents.size()).c_str());
+	}
+
+	// Loose box of the leaf of the debug agent
+	if (m_pAgentToDebug && m_AgentLeaves.find(m_pAgentToDebug) != m_AgentLeaves.end())
+	{
+		const Node& leaf = m_Nodes[m_AgentLeaves[m_pAgentToDebug]];
+		const float looseHalfSize = leaf.halfSize * m_Looseness;
+		Elite::Polygon polygon{ std::vector<Vector2>{ leaf.center + Vector2{ -looseHalfSize, -looseHalfSize }, leaf.center + Vector2{ -looseHalfSize, looseHalfSize },
+			leaf.center + Vector2{ looseHalfSize, looseHalfSize }, leaf.center + Vector2{ looseHalfSize, -looseHalfSize } } };
+		DEBUGRENDERER2D->DrawPolygon(&polygon, Color{ 1,1,0 });
+	}
+}
+
+// --- Spatial Hash Grid ---
+// -------------------------
+// Only the debug drawing, the grid itself is in SpatialHashGrid.cpp so it builds without the agents
+void SpatialHashGrid::DebugRender(const Elite::Vector2& position, float radius) const
+{
+	if (m_CellStarts.empty())
+		return;
+
+	// Grid
+	for (int c = 0; c <= m_NrOfCols; ++c)
+		DEBUGRENDERER2D->DrawSegment({ c * m_CellWidth, 0.f }, { c * m_CellWidth, m_SpaceHeight }, Color{ 1,0,0 });
+	for (int r = 0; r <= m_NrOfRows; ++r)
+		DEBUGRENDERER2D->DrawSegment({ 0.f, r * m_CellHeight }, { m_SpaceWidth, r * m_CellHeight }, Color{ 1,0,0 });
+
+	// Number of points in the cells around the position
+	const int col = ToColumn(position.x);
+	const int row = ToRow(position.y);
+	const int range = static_cast<int>(ceilf(radius / (m_CellWidth < m_CellHeight ? m_CellWidth : m_CellHeight)));
+	for (int r = row - range; r <= row + range; ++r)
+	{
+		for (int c = col - range; c <= col + range; ++c)
+		{
+			const Vector2 cellCenter{ (c + 0.5f) * m_CellWidth, (r + 0.5f) * m_CellHeight };
+			const int cellIdx = GetCellIndex(cellCenter.x, cellCenter.y);
+			DEBUGRENDERER2D->DrawString(cellCenter, std::to_string(GetNrOfPointsInCell(cellIdx)).c_str());
+		}
+	}
+}
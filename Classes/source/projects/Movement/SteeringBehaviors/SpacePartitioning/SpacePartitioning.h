@@ -5,6 +5,7 @@
 // SpacePartitioning.h: Contains Cell and Cellspace which are used to partition a space in segments.
 // Cells contain pointers to all the agents within.
 // These are used to avoid unnecessary distance comparisons to agents that are far away.
+// SpatialHashGrid: grid over plain positions that is rebuilt every frame instead of updated per agent.
 
 // Heavily based on chapter 3 of "Programming Game AI by Example" - Mat Buckland
 /*=============================================================================*/
@@ -13,11 +14,21 @@
 #include <list>
 #include <vector>
 #include <iterator>
+#include <unordered_map>
 #include "framework\EliteMath\EVector2.h"
 #include "framework\EliteGeometry\EGeometry2DTypes.h"
 
 class SteeringAgent;
 
+// Point found by a nearest neighbor query, (dx, dy) is the offset from the query position
+struct NearNeighbor
+{
+	int pointIdx;
+	float dx;
+	float dy;
+	float distanceSquared;
+};
+
 // --- Cell ---
 // ------------
 struct Cell
@@ -31,23 +42,61 @@ struct Cell
 	Elite::Rect boundingBox;
 };
 
+// --- Partitioning Interface ---
+// ------------------------------
+// Work done by the neighbor queries since the last ResetStats
+struct PartitioningStats
+{
+	int nrOfQueries = 0;
+	int nrOfCellsVisited = 0;
+	int nrOfDistanceTests = 0;
+};
+
+class ISpacePartitioning
+{
+public:
+	virtual ~ISpacePartitioning() = default;
+
+	virtual void AddAgent(SteeringAgent* agent) = 0;
+	virtual void UpdateAgentCell(SteeringAgent* agent, Elite::Vector2 oldPos) = 0;
+
+	virtual void SetAgentToDebug(SteeringAgent* agent) = 0;
+
+	virtual void RegisterNeighbors(SteeringAgent* agent, float queryRadius) = 0;
+	// At most maxNeighbors of the agents within the radius, the nearest ones, sorted from near to far
+	virtual void RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors) = 0;
+	virtual const std::vector<SteeringAgent*>& GetNeighbors() const = 0;
+	virtual int GetNrOfNeighbors() const = 0;
+
+	virtual void DebugRender(float queryRadius) = 0;
+	virtual int GetNrOfCells() const = 0;
+
+	const PartitioningStats& GetStats() const { return m_Stats; }
+	void ResetStats() { m_Stats = PartitioningStats{}; }
+
+protected:
+	PartitioningStats m_Stats{};
+};
+
 // --- Partitioned Space ---
 // -------------------------
-class CellSpace
+class CellSpace final : public ISpacePartitioning
 {
 public:
 	CellSpace(float width, float height, int rows, int cols, int maxEntities);
 
-	void AddAgent(SteeringAgent* agent);
-	void UpdateAgentCell(SteeringAgent* agent, Elite::Vector2 oldPos);
+	void AddAgent(SteeringAgent* agent) override;
+	void UpdateAgentCell(SteeringAgent* agent, Elite::Vector2 oldPos) override;
 
-	void SetAgentToDebug(SteeringAgent* agent);
+	void SetAgentToDebug(SteeringAgent* agent) override;
 
-	void RegisterNeighbors(SteeringAgent* agent, float queryRadius);
-	const std::vector<SteeringAgent*>& GetNeighbors() const;
-	int GetNrOfNeighbors() const;
+	void RegisterNeighbors(SteeringAgent* agent, float queryRadius) override;
+	void RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors) override;
+	const std::vector<SteeringAgent*>& GetNeighbors() const override;
+	int GetNrOfNeighbors() const override;
 
-	void DebugRender(float);
+	void DebugRender(float) override;
+	int GetNrOfCells() const override { return m_NrOfRows * m_NrOfCols; }
 
 private:
 	// Cells and properties
@@ -69,8 +118,174 @@ private:
 	int m_NrOfCellsToCheck;
 	vector<SteeringAgent*> m_Neighbors;
 	int m_NrOfNeighbors;
+	vector<std::pair<float, SteeringAgent*>> m_NearestNeighbors; // heap on distance, farthest on top
 
 	// Helper functions
 	int PositionToIndex(const Elite::Vector2 pos) const;
 	void GetNeighborCells(SteeringAgent* agent, float queryRadius);
 };
+
+// --- Loose Quadtree ---
+// ----------------------
+// Adapts to the density of the agents: a node splits in four when it holds too many agents and the children merge
+// back when they hold few. Only leaves hold agents. A node is loose, an agent stays in its leaf while it is inside
+// the leaf grown by the looseness, so agents moving around a border do not hop between leaves every frame.
+class QuadTreeSpace final : public ISpacePartitioning
+{
+public:
+	QuadTreeSpace(float width, float height, int maxAgentsPerNode = 16, int maxDepth = 8, float looseness = 1.25f);
+
+	void AddAgent(SteeringAgent* agent) override;
+	void UpdateAgentCell(SteeringAgent* agent, Elite::Vector2 oldPos) override;
+
+	void SetAgentToDebug(SteeringAgent* agent) override { m_pAgentToDebug = agent; }
+
+	void RegisterNeighbors(SteeringAgent* agent, float queryRadius) override;
+	void RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors) override;
+	const std::vector<SteeringAgent*>& GetNeighbors() const override { return m_Neighbors; }
+	int GetNrOfNeighbors() const override { return static_cast<int>(m_Neighbors.size()); }
+
+	void DebugRender(float queryRadius) override;
+	int GetNrOfCells() const override; // leaves
+
+	int GetDepth() const;
+
+private:
+	struct Node
+	{
+		Elite::Vector2 center;
+		float halfSize; // of the tight box, the loose box is looseness times larger
+		int depth;
+		int parent;
+		int firstChild; // the four children are consecutive, -1 for a leaf
+		int nrOfAgents; // in the whole subtree
+		std::vector<SteeringAgent*> agents; // leaves, and the root for the agents outside of the space
+	};
+
+	std::vector<Node> m_Nodes; // root first
+	std::vector<int> m_FreeChildren; // first child of unused groups of four
+	std::unordered_map<SteeringAgent*, int> m_AgentLeaves;
+
+	int m_MaxAgentsPerNode;
+	int m_MaxDepth;
+	float m_Looseness;
+
+	SteeringAgent* m_pAgentToDebug = nullptr;
+	std::vector<SteeringAgent*> m_Neighbors;
+	std::vector<std::pair<float, SteeringAgent*>> m_NearestNeighbors; // heap on distance, farthest on top
+	std::vector<int> m_NodesToVisit;
+
+	void Insert(SteeringAgent* agent, const Elite::Vector2& position);
+	void Remove(SteeringAgent* agent, int leafIdx);
+	void Split(int nodeIdx);
+	void Merge(int nodeIdx);
+	bool IsInsideRoot(const Elite::Vector2& position) const;
+	bool IsInsideLoose(const Node& node, const Elite::Vector2& position) const;
+	bool IsOverlappingLoose(const Node& node, const Elite::Vector2& position, float radius) const;
+	template<typename Visitor>
+	void ForEachAgentInRadius(const Elite::Vector2& position, float radius, Visitor visitor);
+};
+
+// --- Spatial Hash Grid ---
+// -------------------------
+// Rebuilt from scratch every frame: the points are counting-sorted by cell into one array, so the points of a cell
+// are contiguous and a query walks a few ranges of that array. Points are referred to by their index in Rebuild.
+// With wrap-around the space is a torus, queries near a border also find the points on the other side.
+class SpatialHashGrid
+{
+public:
+	// The cells are at least cellSize wide and high, they are stretched to fit the space exactly
+	SpatialHashGrid(float width, float height, float cellSize, bool wrapAround = false);
+
+	void Rebuild(const std::vector<Elite::Vector2>& positions);
+	void Rebuild(const float* pPositionsX, const float* pPositionsY, int nrOfPoints);
+
+	// visitor(int pointIdx, float dx, float dy, float distanceSquared) for every point closer than the radius,
+	// (dx, dy) is the offset from the position to the nearest copy of the point
+	template<typename Visitor>
+	void ForEachNeighbor(const Elite::Vector2& position, float radius, Visitor visitor) const;
+	void FindNeighbors(const Elite::Vector2& position, float radius, std::vector<int>& neighbors) const;
+	// Cells a query visits and points it tests, without running it
+	void GetQueryCost(const Elite::Vector2& position, float radius, int& nrOfCells, int& nrOfPoints) const;
+	// At most maxNeighbors of the points within the radius, the nearest ones, sorted from near to far
+	// Kept in a bounded heap, so a crowded neighborhood costs distance tests but no more than maxNeighbors of storage
+	void FindNearestNeighbors(const Elite::Vector2& position, float radius, int maxNeighbors, std::vector<NearNeighbor>& neighbors) const;
+
+	// Both take effect at the next Rebuild
+	void SetCellSize(float cellSize);
+	void SetWrapAround(bool wrapAround) { m_WrapAround = wrapAround; }
+
+	bool IsWrapAround() const { return m_WrapAround; }
+	int GetNrOfCells() const { return m_NrOfCols * m_NrOfRows; }
+	int GetNrOfPointsInCell(int cellIdx) const { return m_CellStarts[cellIdx + 1] - m_CellStarts[cellIdx]; }
+	int GetCellIndex(float x, float y) const;
+
+	void DebugRender(const Elite::Vector2& position, float radius) const;
+
+private:
+	float m_SpaceWidth;
+	float m_SpaceHeight;
+	bool m_WrapAround;
+
+	int m_NrOfCols = 1;
+	int m_NrOfRows = 1;
+	float m_CellWidth;
+	float m_CellHeight;
+
+	// The points of cell c are at [m_CellStarts[c], m_CellStarts[c + 1]) of the sorted arrays
+	std::vector<int> m_CellStarts;
+	std::vector<int> m_CellOffsets;
+	std::vector<int> m_PointCells;
+	std::vector<int> m_SortedIndices;
+	std::vector<float> m_SortedX;
+	std::vector<float> m_SortedY;
+
+	void SortPoints(); // counting sort of the points on m_PointCells
+	// Cells overlapping the square around the position, outside the grid when it wraps around
+	void GetCellRange(const Elite::Vector2& position, float radius, int& colMin, int& colMax, int& rowMin, int& rowMax) const;
+	int ToCellIndex(int col, int row) const;
+	float GetDistanceToCell(float coordinate, float cellCenter, float cellSize, float spaceSize) const;
+	template<typename Visitor>
+	void VisitCell(int cellIdx, const Elite::Vector2& position, float radiusSquared, Visitor& visitor) const;
+	int ToColumn(float x) const;
+	int ToRow(float y) const;
+};
+
+template<typename Visitor>
+void SpatialHashGrid::ForEachNeighbor(const Elite::Vector2& position, float radius, Visitor visitor) const
+{
+	if (m_CellStarts.empty())
+		return;
+
+	int colMin, colMax, rowMin, rowMax;
+	GetCellRange(position, radius, colMin, colMax, rowMin, rowMax);
+	for (int r = rowMin; r <= rowMax; ++r)
+	{
+		for (int c = colMin; c <= colMax; ++c)
+			VisitCell(ToCellIndex(c, r), position, radius * radius, visitor);
+	}
+}
+
+template<typename Visitor>
+void SpatialHashGrid::VisitCell(int cellIdx, const Elite::Vector2& position, float radiusSquared, Visitor& visitor) const
+{
+	const float halfWidth = m_SpaceWidth * 0.5f;
+	const float halfHeight = m_SpaceHeight * 0.5f;
+	const int end = m_CellStarts[cellIdx + 1];
+	for (int i = m_CellStarts[cellIdx]; i < end; ++i)
+	{
+		float dx = m_SortedX[i] - position.x;
+		float dy = m_SortedY[i] - position.y;
+		if (m_WrapAround)
+		{
+			if (dx > halfWidth) dx -= m_SpaceWidth;
+			else if (dx < -halfWidth) dx += m_SpaceWidth;
+			if (dy > halfHeight) dy -= m_SpaceHeight;
+			else if (dy < -halfHeight) dy += m_SpaceHeight;
+		}
+
+		const float distanceSquared = dx * dx + dy * dy;
+		if (distanceSquared < radiusSquared)
+			visitor(m_SortedIndices[i], dx, dy, distanceSquared);
+	}
+}
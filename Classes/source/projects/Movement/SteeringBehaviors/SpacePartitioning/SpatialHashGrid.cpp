@@ -0,0 +1,232 @@
+#include "stdafx.h"
+#include "SpacePartitioning.h"
+
+using namespace Elite;
+
+// --- Spatial Hash Grid ---
+// -------------------------
+SpatialHashGrid::SpatialHashGrid(float width, float height, float cellSize, bool wrapAround)
+	: m_SpaceWidth(width)
+	, m_SpaceHeight(height)
+	, m_WrapAround(wrapAround)
+	, m_CellWidth(width)
+	, m_CellHeight(height)
+{
+	SetCellSize(cellSize);
+}
+
+void SpatialHashGrid::SetCellSize(float cellSize)
+{
+	// Whole number of cells, otherwise the last column and row would be narrower than the cell size
+	const int nrOfCols = cellSize > 0.f ? static_cast<int>(m_SpaceWidth / cellSize) : 1;
+	const int nrOfRows = cellSize > 0.f ? static_cast<int>(m_SpaceHeight / cellSize) : 1;
+	m_NrOfCols = nrOfCols > 0 ? nrOfCols : 1;
+	m_NrOfRows = nrOfRows > 0 ? nrOfRows : 1;
+	m_CellWidth = m_SpaceWidth / m_NrOfCols;
+	m_CellHeight = m_SpaceHeight / m_NrOfRows;
+	m_CellStarts.clear();
+}
+
+void SpatialHashGrid::Rebuild(const std::vector<Elite::Vector2>& positions)
+{
+	const int nrOfPoints = static_cast<int>(positions.size());
+	m_PointCells.resize(nrOfPoints);
+	for (int i = 0; i < nrOfPoints; ++i)
+		m_PointCells[i] = GetCellIndex(positions[i].x, positions[i].y);
+	SortPoints();
+
+	for (int i = 0; i < nrOfPoints; ++i)
+	{
+		m_SortedX[i] = positions[m_SortedIndices[i]].x;
+		m_SortedY[i] = positions[m_SortedIndices[i]].y;
+	}
+}
+
+void SpatialHashGrid::Rebuild(const float* pPositionsX, const float* pPositionsY, int nrOfPoints)
+{
+	m_PointCells.resize(nrOfPoints);
+	for (int i = 0; i < nrOfPoints; ++i)
+		m_PointCells[i] = GetCellIndex(pPositionsX[i], pPositionsY[i]);
+	SortPoints();
+
+	for (int i = 0; i < nrOfPoints; ++i)
+	{
+		m_SortedX[i] = pPositionsX[m_SortedIndices[i]];
+		m_SortedY[i] = pPositionsY[m_SortedIndices[i]];
+	}
+}
+
+void SpatialHashGrid::SortPoints()
+{
+	const int nrOfPoints = static_cast<int>(m_PointCells.size());
+	const int nrOfCells = GetNrOfCells();
+
+	//1. Count the points per cell
+	m_CellStarts.assign(nrOfCells + 1, 0);
+	for (int cellIdx : m_PointCells)
+		++m_CellStarts[cellIdx + 1];
+
+	//2. Prefix sum: where every cell starts
+	for (int c = 0; c < nrOfCells; ++c)
+		m_CellStarts[c + 1] += m_CellStarts[c];
+
+	//3. Scatter the indices, in order of index within a cell
+	m_CellOffsets.assign(m_CellStarts.begin(), m_CellStarts.end() - 1);
+	m_SortedIndices.resize(nrOfPoints);
+	for (int i = 0; i < nrOfPoints; ++i)
+		m_SortedIndices[m_CellOffsets[m_PointCells[i]]++] = i;
+
+	m_SortedX.resize(nrOfPoints);
+	m_SortedY.resize(nrOfPoints);
+}
+
+void SpatialHashGrid::GetQueryCost(const Elite::Vector2& position, float radius, int& nrOfCells, int& nrOfPoints) const
+{
+	nrOfCells = 0;
+	nrOfPoints = 0;
+	if (m_CellStarts.empty())
+		return;
+
+	int colMin, colMax, rowMin, rowMax;
+	GetCellRange(position, radius, colMin, colMax, rowMin, rowMax);
+	for (int r = rowMin; r <= rowMax; ++r)
+	{
+		for (int c = colMin; c <= colMax; ++c)
+		{
+			++nrOfCells;
+			nrOfPoints += GetNrOfPointsInCell(ToCellIndex(c, r));
+		}
+	}
+}
+
+void SpatialHashGrid::FindNeighbors(const Elite::Vector2& position, float radius, std::vector<int>& neighbors) const
+{
+	neighbors.clear();
+	ForEachNeighbor(position, radius, [&neighbors](int pointIdx, float, float, float)
+		{
+			neighbors.push_back(pointIdx);
+		});
+}
+
+void SpatialHashGrid::FindNearestNeighbors(const Elite::Vector2& position, float radius, int maxNeighbors, std::vector<NearNeighbor>& neighbors) const
+{
+	neighbors.clear();
+	if (m_CellStarts.empty() || maxNeighbors <= 0)
+		return;
+
+	// Max heap on distance, the index breaks ties so the result does not depend on the order of the cells
+	auto isNearer = [](const NearNeighbor& a, const NearNeighbor& b)
+	{
+		return a.distanceSquared < b.distanceSquared || (a.distanceSquared == b.distanceSquared && a.pointIdx < b.pointIdx);
+	};
+	auto addNeighbor = [&](int pointIdx, float dx, float dy, float distanceSquared)
+	{
+		const NearNeighbor neighbor{ pointIdx, dx, dy, distanceSquared };
+		if ((int)neighbors.size() < maxNeighbors)
+		{
+			neighbors.push_back(neighbor);
+			std::push_heap(neighbors.begin(), neighbors.end(), isNearer);
+		}
+		else if (isNearer(neighbor, neighbors.front()))
+		{
+			std::pop_heap(neighbors.begin(), neighbors.end(), isNearer);
+			neighbors.back() = neighbor;
+			std::push_heap(neighbors.begin(), neighbors.end(), isNearer);
+		}
+	};
+
+	// The cell of the position first, it usually fills the heap with near points
+	const float radiusSquared = radius * radius;
+	const int col = static_cast<int>(floorf(position.x / m_CellWidth));
+	const int row = static_cast<int>(floorf(position.y / m_CellHeight));
+	const int cellIdx = GetCellIndex(position.x, position.y);
+	VisitCell(cellIdx, position, radiusSquared, addNeighbor);
+
+	// Then the other cells, skipping those that are farther away than the farthest neighbor so far
+	int colMin, colMax, rowMin, rowMax;
+	GetCellRange(position, radius, colMin, colMax, rowMin, rowMax);
+	for (int r = rowMin; r <= rowMax; ++r)
+	{
+		const float distanceY = GetDistanceToCell(position.y, (r + 0.5f) * m_CellHeight, m_CellHeight, m_SpaceHeight);
+		for (int c = colMin; c <= colMax; ++c)
+		{
+			if (c == col && r == row)
+				continue;
+
+			const float distanceX = GetDistanceToCell(position.x, (c + 0.5f) * m_CellWidth, m_CellWidth, m_SpaceWidth);
+			const float cellDistanceSquared = distanceX * distanceX + distanceY * distanceY;
+			if (cellDistanceSquared >= radiusSquared || ((int)neighbors.size() == maxNeighbors && cellDistanceSquared > neighbors.front().distanceSquared))
+				continue;
+
+			const int otherCellIdx = ToCellIndex(c, r);
+			if (otherCellIdx != cellIdx)
+				VisitCell(otherCellIdx, position, radiusSquared, addNeighbor);
+		}
+	}
+	std::sort_heap(neighbors.begin(), neighbors.end(), isNearer);
+}
+
+void SpatialHashGrid::GetCellRange(const Elite::Vector2& position, float radius, int& colMin, int& colMax, int& rowMin, int& rowMax) const
+{
+	colMin = static_cast<int>(floorf((position.x - radius) / m_CellWidth));
+	colMax = static_cast<int>(floorf((position.x + radius) / m_CellWidth));
+	rowMin = static_cast<int>(floorf((position.y - radius) / m_CellHeight));
+	rowMax = static_cast<int>(floorf((position.y + radius) / m_CellHeight));
+	if (m_WrapAround)
+	{
+		// A range over the whole grid would visit cells twice
+		if (colMax - colMin >= m_NrOfCols) { colMin = 0; colMax = m_NrOfCols - 1; }
+		if (rowMax - rowMin >= m_NrOfRows) { rowMin = 0; rowMax = m_NrOfRows - 1; }
+	}
+	else
+	{
+		colMin = colMin < 0 ? 0 : colMin;
+		rowMin = rowMin < 0 ? 0 : rowMin;
+		colMax = colMax >= m_NrOfCols ? m_NrOfCols - 1 : colMax;
+		rowMax = rowMax >= m_NrOfRows ? m_NrOfRows - 1 : rowMax;
+	}
+}
+
+float SpatialHashGrid::GetDistanceToCell(float coordinate, float cellCenter, float cellSize, float spaceSize) const
+{
+	// Along one axis, to the nearest copy of the cell when the grid wraps around
+	float offset = cellCenter - coordinate;
+	if (m_WrapAround)
+	{
+		if (offset > spaceSize * 0.5f) offset -= spaceSize;
+		else if (offset < -spaceSize * 0.5f) offset += spaceSize;
+	}
+	const float distance = fabsf(offset) - cellSize * 0.5f;
+	return distance > 0.f ? distance : 0.f;
+}
+
+int SpatialHashGrid::ToCellIndex(int col, int row) const
+{
+	if (m_WrapAround)
+	{
+		col = ((col % m_NrOfCols) + m_NrOfCols) % m_NrOfCols;
+		row = ((row % m_NrOfRows) + m_NrOfRows) % m_NrOfRows;
+	}
+	return row * m_NrOfCols + col;
+}
+
+int SpatialHashGrid::ToColumn(float x) const
+{
+	const int col = static_cast<int>(floorf(x / m_CellWidth));
+	if (m_WrapAround)
+		return ((col % m_NrOfCols) + m_NrOfCols) % m_NrOfCols;
+	return col < 0 ? 0 : col >= m_NrOfCols ? m_NrOfCols - 1 : col;
+}
+
+int SpatialHashGrid::ToRow(float y) const
+{
+	const int row = static_cast<int>(floorf(y / m_CellHeight));
+	if (m_WrapAround)
+		return ((row % m_NrOfRows) + m_NrOfRows) % m_NrOfRows;
+	return row < 0 ? 0 : row >= m_NrOfRows ? m_NrOfRows - 1 : row;
+}
+
+int SpatialHashGrid::GetCellIndex(float x, float y) const
+{
+	return ToRow(y) * m_NrOfCols + ToColumn(x);
+}
@@ -9,6 +9,35 @@
 
 using namespace Elite;
 
+namespace
+{
+	//Same as Seek::CalculateSteering, from the state of an agent
+	SteeringOutput SeekState(const AgentState& agent, const Vector2& target)
+	{
+		const Vector2 linearVelocity = (target - agent.Position).GetNormalized() * agent.MaxLinearSpeed;
+		if (linearVelocity.Magnitude() < 0.001f) return SteeringOutput(ZeroVector2, 0.f, false);
+		return SteeringOutput(linearVelocity);
+	}
+
+	//Same as Pursuit::CalculateSteering, targetDirection is the normalized velocity of the target
+	SteeringOutput PursueState(const AgentState& agent, const Vector2& targetPosition, const Vector2& targetDirection)
+	{
+		const float predictionTime = Distance(targetPosition, agent.Position) / agent.MaxAngularSpeed;
+		return SeekState(agent, targetPosition + targetDirection * predictionTime);
+	}
+}
+
+//BASE
+//****
+void ISteeringBehavior::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (pAgents[i].pAgent) pSteerings[i] = CalculateSteering(deltaT, pAgents[i].pAgent);
+		else pSteerings[i] = SteeringOutput(ZeroVector2, 0.f, false);
+	}
+}
+
 //SEEK
 //****
 SteeringOutput Seek::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -33,6 +62,12 @@ SteeringOutput Seek::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Seek::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	for (int i = 0; i < count; ++i)
+		pSteerings[i] = SeekState(pAgents[i], m_Target.Position);
+}
+
 //FLEE
 //****
 SteeringOutput Flee::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -55,6 +90,16 @@ SteeringOutput Flee::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Flee::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		pSteerings[i] = SeekState(pAgents[i], m_Target.Position);
+		pSteerings[i].LinearVelocity *= -1.f;
+		pSteerings[i].IsValid = true;
+	}
+}
+
 //ARRIVE
 //****
 SteeringOutput Arrive::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -83,6 +128,24 @@ SteeringOutput Arrive::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Arrive::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	const float arrivalRadius{ 1.f };
+	const float slowRadius{ 3.f };
+
+	for (int i = 0; i < count; ++i)
+	{
+		Vector2 linearVelocity = m_Target.Position - pAgents[i].Position;
+		const float distance = linearVelocity.Normalize();
+
+		if (distance < arrivalRadius) linearVelocity = ZeroVector2;
+		else if (distance < slowRadius) linearVelocity *= pAgents[i].MaxLinearSpeed * distance / (slowRadius - arrivalRadius);
+		else linearVelocity *= pAgents[i].MaxLinearSpeed;
+
+		pSteerings[i] = SteeringOutput(linearVelocity);
+	}
+}
+
 //FACE
 //****
 SteeringOutput Face::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -159,6 +222,20 @@ SteeringOutput Wander::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Wander::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	//Every agent wanders around its own angle, the target of the behavior stays as it is
+	for (int i = 0; i < count; ++i)
+	{
+		AgentState& agent = pAgents[i];
+		const Vector2 circleCenter{ agent.Position + agent.LinearVelocity.GetNormalized() * m_WanderOffset };
+		agent.WanderAngle += randomFloat(-m_MaxAngleChange, m_MaxAngleChange);
+
+		const Vector2 target = circleCenter + Vector2{ cos(agent.WanderAngle) * m_Radius, sin(agent.WanderAngle) * m_Radius };
+		pSteerings[i] = SeekState(agent, target);
+	}
+}
+
 
 //EVADE
 //****
@@ -180,6 +257,25 @@ SteeringOutput Evade::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	
 }
 
+void Evade::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	const Vector2 targetDirection = m_Target.LinearVelocity.GetNormalized();
+	const float evadeRangeSquared = m_EvadeRange * m_EvadeRange;
+	for (int i = 0; i < count; ++i)
+	{
+		if (DistanceSquared(m_Target.Position, pAgents[i].Position) < evadeRangeSquared)
+		{
+			pSteerings[i] = PursueState(pAgents[i], m_Target.Position, targetDirection);
+			pSteerings[i].LinearVelocity *= -1.f;
+			pSteerings[i].IsValid = true;
+		}
+		else
+		{
+			pSteerings[i] = SteeringOutput(ZeroVector2, 0.f, false);
+		}
+	}
+}
+
 float Evade::GetEvadeRange() const
 {
 	return m_EvadeRange;
@@ -192,6 +288,8 @@ SteeringOutput Pursuit::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	Elite::Vector2 distance = m_Target.Position - pAgent->GetPosition();
 	float normalizeMultiplier = distance.Normalize() / pAgent->GetMaxAngularSpeed();
 
+	//Seek the predicted position, the target itself stays put for the next agent
+	const TargetData target = m_Target;
 	m_Target.Position = m_Target.Position + m_Target.LinearVelocity.GetNormalized() * normalizeMultiplier;
 
 	auto steering = Seek::CalculateSteering(deltaT, pAgent);
@@ -201,6 +299,14 @@ SteeringOutput Pursuit::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 		DEBUGRENDERER2D->DrawCircle(m_Target.Position, 0.5f, { 1,1,1,1 }, 0.f);
 	}
 
+	m_Target = target;
 	return steering;
 }
 
+void Pursuit::CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count)
+{
+	const Vector2 targetDirection = m_Target.LinearVelocity.GetNormalized();
+	for (int i = 0; i < count; ++i)
+		pSteerings[i] = PursueState(pAgents[i], m_Target.Position, targetDirection);
+}
+
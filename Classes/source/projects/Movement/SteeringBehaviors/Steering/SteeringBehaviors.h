@@ -24,6 +24,9 @@ public:
 	virtual ~ISteeringBehavior() = default;
 
 	virtual SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) = 0;
+	//Steering of count agents in one loop, pSteerings[i] is the steering of pAgents[i]
+	//The batched versions only read the states and draw no debug info, the others go through CalculateSteering one agent at a time
+	virtual void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count);
 
 	//Seek Functions
 	void SetTarget(const TargetData& target) { m_Target = target; }
@@ -48,6 +51,7 @@ public:
 
 	//Seek Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 };
 
 /////////////////////////
@@ -61,6 +65,7 @@ public:
 
 	//Seek Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 protected:
 	float m_FleeRadius = 10.f;
@@ -77,6 +82,7 @@ public:
 
 	//Seek Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 };
 
 /////////////////////////
@@ -107,6 +113,7 @@ public:
 
 	//Seek Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 protected:
 	float m_WanderOffset = 6.f;
@@ -127,6 +134,7 @@ public:
 
 	//Seek Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 protected:
 };
@@ -142,6 +150,7 @@ public:
 
 	//Seek Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, AgentState* pAgents, SteeringOutput* pSteerings, int count) override;
 
 	float GetEvadeRange() const;
 private: 
@@ -5,36 +5,49 @@
 void SteeringAgent::Update(float dt)
 {
 	if(m_pSteeringBehavior)
-	{
-		auto output = m_pSteeringBehavior->CalculateSteering(dt, this);
+		ApplySteering(m_pSteeringBehavior->CalculateSteering(dt, this), dt);
+}
 
-		//Linear Movement
-		//***************
-		auto linVel = GetLinearVelocity();
-		auto steeringForce = output.LinearVelocity - linVel;
-		auto acceleration = steeringForce / GetMass();		
+void SteeringAgent::ApplySteering(SteeringOutput output, float dt)
+{
+	//Linear Movement
+	//***************
+	auto linVel = GetLinearVelocity();
+	auto steeringForce = output.LinearVelocity - linVel;
+	auto acceleration = steeringForce / GetMass();		
 
-		if(m_RenderBehavior)
-		{
-			//DEBUGRENDERER2D->DrawDirection(GetPosition(), acceleration, acceleration.Magnitude(), { 0, 1, 1 ,0.5f }, 0.40f);
-			//DEBUGRENDERER2D->DrawDirection(GetPosition(), linVel, linVel.Magnitude(), { 1, 0, 1 ,0.5f }, 0.40f);
-		}
-		SetLinearVelocity(linVel + (acceleration*dt));
+	if(m_RenderBehavior)
+	{
+		//DEBUGRENDERER2D->DrawDirection(GetPosition(), acceleration, acceleration.Magnitude(), { 0, 1, 1 ,0.5f }, 0.40f);
+		//DEBUGRENDERER2D->DrawDirection(GetPosition(), linVel, linVel.Magnitude(), { 1, 0, 1 ,0.5f }, 0.40f);
+	}
+	SetLinearVelocity(linVel + (acceleration*dt));
 
-		//Angular Movement
-		//****************
-		if(m_AutoOrient)
-		{
-			auto desiredOrientation = Elite::GetOrientationFromVelocity(GetLinearVelocity());
-			SetRotation(desiredOrientation);
-		}
-		else
-		{
-			if (output.AngularVelocity > m_MaxAngularSpeed)
-				output.AngularVelocity = m_MaxAngularSpeed;
-			SetAngularVelocity(output.AngularVelocity);
-		}
+	//Angular Movement
+	//****************
+	if(m_AutoOrient)
+	{
+		auto desiredOrientation = Elite::GetOrientationFromVelocity(GetLinearVelocity());
+		SetRotation(desiredOrientation);
 	}
+	else
+	{
+		if (output.AngularVelocity > m_MaxAngularSpeed)
+			output.AngularVelocity = m_MaxAngularSpeed;
+		SetAngularVelocity(output.AngularVelocity);
+	}
+}
+
+AgentState SteeringAgent::GetState()
+{
+	AgentState state{};
+	state.Position = GetPosition();
+	state.LinearVelocity = GetLinearVelocity();
+	state.MaxLinearSpeed = m_MaxLinearSpeed;
+	state.MaxAngularSpeed = m_MaxAngularSpeed;
+	state.WanderAngle = m_WanderAngle;
+	state.pAgent = this;
+	return state;
 }
 
 void SteeringAgent::Render(float dt)
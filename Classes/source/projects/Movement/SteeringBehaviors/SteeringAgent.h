@@ -26,6 +26,14 @@ public:
 	void Update(float dt) override;
 	void Render(float dt) override;
 
+	//Moves the agent with a steering, Update does this with the steering of its behavior
+	void ApplySteering(SteeringOutput output, float dt);
+	//Input of the batched steering behaviors, the wander angle they change goes back with SetWanderAngle
+	AgentState GetState();
+
+	float GetWanderAngle() const { return m_WanderAngle; }
+	void SetWanderAngle(float wanderAngle) { m_WanderAngle = wanderAngle; }
+
 	float GetMaxLinearSpeed() const { return m_MaxLinearSpeed; }
 	void SetMaxLinearSpeed(float maxLinSpeed) { m_MaxLinearSpeed = maxLinSpeed; }
 
@@ -53,5 +61,6 @@ protected:
 	float m_MaxAngularSpeed = 10.f;
 	bool m_AutoOrient = false;
 	bool m_RenderBehavior = false;
+	float m_WanderAngle = 0.f;
 };
 #endif
\ No newline at end of file
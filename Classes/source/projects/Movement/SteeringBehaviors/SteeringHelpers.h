@@ -129,6 +129,19 @@ struct SteeringOutput
 	}
 };
 
+//AgentState: what the batched steering behaviors read of an agent
+class SteeringAgent;
+struct AgentState
+{
+	Elite::Vector2 Position = { 0.f,0.f };
+	Elite::Vector2 LinearVelocity = { 0.f,0.f };
+	float MaxLinearSpeed = 0.f;
+	float MaxAngularSpeed = 0.f;
+	float WanderAngle = 0.f; //Per agent, agents sharing a Wander do not share its angle
+	int AgentIdx = -1; //In the flock of the agent, where the flocking behaviors find its neighbors
+	SteeringAgent* pAgent = nullptr; //For the behaviors without a batched version
+};
+
 //=== TEMPORARILY ADDED HERE - IS PART OF COMBINED STEERING! ===
 struct Goal
 {
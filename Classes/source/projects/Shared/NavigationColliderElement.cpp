@@ -27,4 +27,24 @@ NavigationColliderElement::~NavigationColliderElement()
 void NavigationColliderElement::RenderElement()
 {
 	//Do Nothing
+}
+
+Elite::Polygon NavigationColliderElement::GetNavigationShape() const
+{
+	//Same vertex order as the box shape of the rigidbody
+	const float halfWidth = m_Width / 2.0f;
+	const float halfHeight = m_Height / 2.0f;
+	const std::vector<Elite::Vector2> points
+	{
+		{ m_Position.x - halfWidth, m_Position.y - halfHeight },
+		{ m_Position.x + halfWidth, m_Position.y - halfHeight },
+		{ m_Position.x + halfWidth, m_Position.y + halfHeight },
+		{ m_Position.x - halfWidth, m_Position.y + halfHeight }
+	};
+	return Elite::Polygon(points);
+}
+
+bool NavigationColliderElement::IsPointInside(const Elite::Vector2& point) const
+{
+	return abs(point.x - m_Position.x) <= m_Width / 2.0f && abs(point.y - m_Position.y) <= m_Height / 2.0f;
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ public:
 
 	//--- Functions ---
 	void RenderElement();
+	Elite::Polygon GetNavigationShape() const; //Same shape as the static physics shape of the collider
+	bool IsPointInside(const Elite::Vector2& point) const;
 
 private:
 	//--- Datamembers ---
@@ -167,6 +167,7 @@ extern bool gRequestShutdown;
 ===========================================================================*/
 #pragma region FrameworkIncludes
 #include "framework/EliteHelpers/ESingleton.h"
+#include "framework/EliteHelpers/EProfiler.h"
 #include "framework/EliteMath/EMath.h"
 #include "framework/ElitePhysics/EPhysics.h"
 #include "framework/EliteInput/EInputCodes.h"
@@ -186,6 +187,7 @@ extern bool gRequestShutdown;
 #define TIMER Elite::ETimer<PLATFORM_ID>::GetInstance()
 #define DEBUGRENDERER2D EliteDebugRenderer2D::GetInstance()
 #define PHYSICSWORLD PhysicsWorld::GetInstance()
+#define PROFILER Elite::EProfiler::GetInstance()
 
 /* --- PLATFORM SPECIFIC INCLUDES --- */
 #pragma region PlatformIncludes